@@ -0,0 +1,351 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210BulkCodec.h"
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VN210_BULK_X86 1
+#include <immintrin.h>
+#else
+#define VN210_BULK_X86 0
+#endif
+
+/**
+ * Scalar scan: eight bytes at a time, using the usual "has zero byte" test on
+ * the word XORed with each special character.
+ */
+static size_t scanScalar(const uint8_t * p, size_t length) {
+	const uint64_t ones = 0x0101010101010101ULL;
+	const uint64_t highs = 0x8080808080808080ULL;
+	size_t i = 0;
+
+	for (; i + 8 <= length; i += 8) {
+		uint64_t word;
+		memcpy(&word, p + i, 8);
+
+		uint64_t s = word ^ (ones * API_STX);
+		uint64_t c = word ^ (ones * API_CHX);
+
+		if (((s - ones) & ~s & highs) | ((c - ones) & ~c & highs)) break;		//special char somewhere in this word
+	}
+
+	for (; i < length; i++) {
+		if (p[i] == API_STX || p[i] == API_CHX) return i;
+	}
+
+	return length;
+}
+
+#if VN210_BULK_X86
+/**
+ * SSE2 scan, 16 bytes per compare.
+ */
+__attribute__ ((target("sse2")))
+static size_t scanSSE2(const uint8_t * p, size_t length) {
+	const __m128i stx = _mm_set1_epi8((char) API_STX);
+	const __m128i chx = _mm_set1_epi8((char) API_CHX);
+	size_t i = 0;
+
+	for (; i + 16 <= length; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *) (p + i));
+		int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, stx), _mm_cmpeq_epi8(v, chx)));
+
+		if (mask) return i + __builtin_ctz(mask);
+	}
+
+	return i + scanScalar(p + i, length - i);
+}
+
+/**
+ * AVX2 scan, 32 bytes per compare.
+ */
+__attribute__ ((target("avx2")))
+static size_t scanAVX2(const uint8_t * p, size_t length) {
+	const __m256i stx = _mm256_set1_epi8((char) API_STX);
+	const __m256i chx = _mm256_set1_epi8((char) API_CHX);
+	size_t i = 0;
+
+	for (; i + 32 <= length; i += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i *) (p + i));
+		uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, stx), _mm256_cmpeq_epi8(v, chx)));
+
+		if (mask) return i + __builtin_ctz(mask);
+	}
+
+	//clear the upper register halves before running SSE code, or every SSE instruction pays a state transition penalty
+	_mm256_zeroupper();
+	return i + scanSSE2(p + i, length - i);
+}
+#endif
+
+typedef size_t (*ScanFunction)(const uint8_t *, size_t);
+
+static ScanFunction scanFunction = NULL;							//!< Scan implementation in use
+static VN210BulkCodec::SimdLevel scanLevel = VN210BulkCodec::SIMD_SCALAR;	//!< Level of scanFunction
+
+/**
+ * Selects the best scan the CPU supports, if none has been chosen yet.
+ */
+static void selectScan(void) {
+	if (scanFunction != NULL) return;
+
+	if (!VN210BulkCodec::setSimdLevel(VN210BulkCodec::SIMD_AVX2) && !VN210BulkCodec::setSimdLevel(VN210BulkCodec::SIMD_SSE2)) {
+		VN210BulkCodec::setSimdLevel(VN210BulkCodec::SIMD_SCALAR);
+	}
+}
+
+static uint16_t crcTable[256];										//!< CRC-CCITT (XMODEM) table, built on first use
+static bool crcTableBuilt = false;
+
+/**
+ * Class constructor.  Frames with a size byte over 'maxDataSize' are abandoned,
+ * as the transport does when they would not fit its receive buffer.
+ */
+VN210BulkCodec::VN210BulkCodec(uint8_t maxDataSize) {
+	this->maxDataSize = maxDataSize;
+	this->framingErrors = 0;
+	this->streamOffset = 0;
+	this->reset();
+
+	selectScan();
+}
+
+/**
+ * Discards any partial frame.
+ */
+void VN210BulkCodec::reset(void) {
+	this->state = DECODE_HUNT;
+	this->escapePending = false;
+	this->remaining = 0;
+	this->frameLength = 0;
+	this->frameStart = 0;
+}
+
+/**
+ * Abandons the current frame after a framing error.  Between frames there is
+ * nothing to abandon, so only the escape is cleared.
+ */
+void VN210BulkCodec::resynchronise(void) {
+	this->escapePending = false;
+	if (this->state == DECODE_HUNT) return;
+
+	this->state = DECODE_HUNT;
+	this->frameLength = 0;
+	this->framingErrors++;
+}
+
+/**
+ * Checks the CRC of the assembled frame and appends it to the output.
+ */
+void VN210BulkCodec::complete(std::vector<uint8_t> & out, std::vector<VN210BulkFrame> & frames) {
+	VN210BulkFrame f;
+
+	f.streamOffset = this->frameStart;
+	f.offset = out.size();
+	f.length = this->frameLength;
+	f.crcValid = crc(this->frame + 1, this->frameLength - 1 - VN210_CRC_SIZE)
+			== (((uint16_t) this->frame[this->frameLength - 2] << 8) | this->frame[this->frameLength - 1]);
+
+	out.insert(out.end(), this->frame, this->frame + this->frameLength);
+	frames.push_back(f);
+
+	this->state = DECODE_HUNT;
+	this->frameLength = 0;
+}
+
+/**
+ * Decodes a block of the escaped stream.
+ *
+ * While hunting for a start character, or part-way through the data and CRC
+ * bytes, the block is scanned for the next STX or CHX and everything before it
+ * is skipped or copied in one go.  Special characters and the four header bytes
+ * after the STX are handled one at a time, exactly as receiveByte() does.
+ */
+size_t VN210BulkCodec::decode(const uint8_t * in, size_t length, std::vector<uint8_t> & out, std::vector<VN210BulkFrame> & frames) {
+	size_t before = frames.size();
+	size_t i = 0;
+
+	while (i < length) {
+		if (!this->escapePending) {
+			if (this->state == DECODE_BODY) {
+				size_t run = this->remaining < length - i ? this->remaining : length - i;
+				size_t clean = scanFunction(in + i, run);
+
+				if (clean > 0) {
+					memcpy(this->frame + this->frameLength, in + i, clean);
+					this->frameLength += clean;
+					this->remaining -= clean;
+					i += clean;
+
+					if (this->remaining == 0) this->complete(out, frames);
+					continue;
+				}
+			} else if (this->state == DECODE_HUNT) {
+				i += scanFunction(in + i, length - i);
+				if (i == length) break;
+			}
+		}
+
+		//slow path - one byte
+		uint8_t b = in[i++];
+
+		if (b == API_STX) {
+			this->state = DECODE_HEADER;
+			this->escapePending = false;
+			this->frame[0] = API_STX;
+			this->frameLength = 1;
+			this->frameStart = this->streamOffset + i - 1;
+			continue;
+		}
+
+		if (b == API_CHX) {
+			if (this->escapePending) {				//two escapes in a row is never valid
+				this->resynchronise();
+			} else {
+				this->escapePending = true;
+			}
+			continue;
+		}
+
+		if (this->escapePending) {
+			this->escapePending = false;
+
+			if (b == 0x0E) {
+				b = API_STX;
+			} else if (b == 0x0D) {
+				b = API_CHX;
+			} else {
+				this->resynchronise();
+				continue;
+			}
+		}
+
+		if (this->state == DECODE_HUNT) continue;
+
+		this->frame[this->frameLength++] = b;
+
+		if (this->state == DECODE_HEADER) {
+			if (this->frameLength == VN210_DATASIZE_FRAME_FIELD_INDEX + 1) {		//just received the size byte
+				if (b > this->maxDataSize) {
+					this->resynchronise();
+				} else {
+					this->state = DECODE_BODY;
+					this->remaining = b + VN210_CRC_SIZE;
+				}
+			}
+		} else if (--this->remaining == 0) {
+			this->complete(out, frames);
+		}
+	}
+
+	this->streamOffset += length;
+	return frames.size() - before;
+}
+
+/**
+ * Escapes frame bytes as addToTxBuffer() does: STX and CHX become CHX followed by
+ * their ones-complement.  The leading STX of a frame must not be passed in.
+ */
+size_t VN210BulkCodec::escape(const uint8_t * in, size_t length, uint8_t * out) {
+	selectScan();
+
+	uint8_t * start = out;
+	size_t i = 0;
+
+	while (i < length) {
+		size_t clean = scanFunction(in + i, length - i);
+
+		memcpy(out, in + i, clean);
+		out += clean;
+		i += clean;
+
+		if (i < length) {
+			*out++ = API_CHX;
+			*out++ = in[i] == API_STX ? 0x0E : 0x0D;
+			i++;
+		}
+	}
+
+	return out - start;
+}
+
+/**
+ * Returns the index of the first STX or CHX.
+ */
+size_t VN210BulkCodec::scan(const uint8_t * p, size_t length) {
+	selectScan();
+
+	return scanFunction(p, length);
+}
+
+/**
+ * Returns the scan implementation in use.
+ */
+VN210BulkCodec::SimdLevel VN210BulkCodec::simdLevel(void) {
+	selectScan();
+
+	return scanLevel;
+}
+
+/**
+ * Selects a scan implementation, for instance to benchmark them against each other.
+ */
+bool VN210BulkCodec::setSimdLevel(SimdLevel level) {
+	switch (level) {
+		case SIMD_SCALAR:
+			scanFunction = scanScalar;
+			break;
+#if VN210_BULK_X86
+		case SIMD_SSE2:
+			if (!__builtin_cpu_supports("sse2")) return false;
+			scanFunction = scanSSE2;
+			break;
+		case SIMD_AVX2:
+			if (!__builtin_cpu_supports("avx2")) return false;
+			scanFunction = scanAVX2;
+			break;
+#endif
+		default:
+			return false;
+	}
+
+	scanLevel = level;
+	return true;
+}
+
+/**
+ * Table-driven CRC-CCITT (XMODEM), giving the same result as calling
+ * _crc_xmodem_update() for each byte.
+ */
+uint16_t VN210BulkCodec::crc(const uint8_t * p, size_t length, uint16_t crc) {
+	if (!crcTableBuilt) {
+		for (int i = 0; i < 256; i++) crcTable[i] = _crc_xmodem_update(0, i);
+		crcTableBuilt = true;
+	}
+
+	for (size_t i = 0; i < length; i++) {
+		crc = (crc << 8) ^ crcTable[(crc >> 8) ^ p[i]];
+	}
+
+	return crc;
+}
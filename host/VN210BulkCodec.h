@@ -0,0 +1,114 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210RxTx.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#ifndef VN210BulkCodec_H_
+#define VN210BulkCodec_H_
+
+/**
+ * Location of one decoded frame.
+ */
+typedef struct {
+	size_t streamOffset;											//!< Offset of the frame's STX in the escaped input, counted from the first byte passed to decode()
+	size_t offset;													//!< Offset of the unescaped frame in the output buffer
+	uint16_t length;												//!< Unescaped frame length, STX to CRC inclusive
+	bool crcValid;													//!< True if the frame CRC matched
+} VN210BulkFrame;
+
+/**
+ * Bulk escape / unescape of VN210 API byte streams, for gateways and replay tools
+ * that handle captured traffic in large blocks rather than a byte at a time.
+ *
+ * The input is scanned for STX and CHX with SSE2 or AVX2 where the CPU supports
+ * them, or a word-at-a-time scalar loop otherwise.  Runs of ordinary bytes are
+ * copied with memcpy and only escape pairs and start characters go through the
+ * slow path.
+ *
+ * Decoding follows the same rules as VN210RxTx::receiveByte(): every STX starts a
+ * new frame, CHX 0x0E and CHX 0x0D are STX and CHX, any other escape sequence or a
+ * size byte over the limit abandons the frame and counts a framing error.  The
+ * frames produced are exactly those the transport would pass to parseMessage()
+ * if each were parsed as soon as it arrived.  Escaping matches
+ * VN210RxTx::addToTxBuffer().
+ *
+ * Decoder state is kept between calls, so a stream can be passed in blocks of
+ * any size.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+class VN210BulkCodec {
+public:
+	/**
+	 * Scan implementations.
+	 */
+	enum SimdLevel {
+		SIMD_SCALAR,												//!< Portable word-at-a-time scan
+		SIMD_SSE2,													//!< 16 bytes per compare
+		SIMD_AVX2													//!< 32 bytes per compare
+	};
+
+	VN210BulkCodec(uint8_t maxDataSize = VN210_BUFFER_SIZE - VN210_FRAME_SIZE_MINUS_DATA);
+
+	//decodes a block of the stream, appending complete frames to 'out' and their locations to 'frames'. returns the number of frames added.
+	size_t decode(const uint8_t * in, size_t length, std::vector<uint8_t> & out, std::vector<VN210BulkFrame> & frames);
+
+	void reset(void);												//discards any partial frame and starts hunting for a start character
+
+	uint32_t framingErrors;											//!< Frames abandoned because of a bad size byte or escape sequence
+
+	//escapes 'length' frame bytes (everything after the STX) into 'out', which must hold 2 * length bytes. returns the escaped length.
+	static size_t escape(const uint8_t * in, size_t length, uint8_t * out);
+
+	//returns the index of the first STX or CHX in 'p', or 'length' if there is none
+	static size_t scan(const uint8_t * p, size_t length);
+
+	static SimdLevel simdLevel(void);								//returns the scan implementation in use
+	static bool setSimdLevel(SimdLevel level);						//selects a scan implementation. returns false if the CPU doesn't support it.
+
+	static uint16_t crc(const uint8_t * p, size_t length, uint16_t crc = VN210_CRC_INITIAL_VALUE);	//table-driven CRC, identical to _crc_xmodem_update()
+private:
+	enum DecodeState {
+		DECODE_HUNT,												//!< Waiting for a start character
+		DECODE_HEADER,												//!< Receiving the header, type, ID and size bytes
+		DECODE_BODY													//!< Receiving the data and CRC bytes
+	};
+
+	uint8_t maxDataSize;											//!< Largest size byte accepted
+	uint8_t state;													//!< Decoder state.  One of DecodeState.
+	bool escapePending;												//!< Last byte was a CHX
+	uint16_t remaining;												//!< Body bytes still to come
+	uint16_t frameLength;											//!< Bytes in 'frame'
+	size_t frameStart;												//!< Stream offset of the current frame's STX
+	size_t streamOffset;											//!< Stream offset of the next byte passed to decode()
+	uint8_t frame[VN210_FRAME_SIZE_MINUS_DATA + 255];				//!< Frame being assembled
+
+	void resynchronise(void);										//abandons the current frame
+	void complete(std::vector<uint8_t> & out, std::vector<VN210BulkFrame> & frames);	//hands on a complete frame
+};
+
+#endif /* VN210BulkCodec_H_ */
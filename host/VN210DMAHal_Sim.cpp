@@ -0,0 +1,125 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210DMAHal_Sim.h"
+
+/**
+ * Class constructor.  The SPI slave starts stopped, with no transport attached.
+ */
+VN210DMAHal_Sim::VN210DMAHal_Sim() {
+	this->transport = NULL;
+	this->rxRing = NULL;
+	this->txRing = NULL;
+	this->length = 0;
+	this->position = 0;
+	this->eventCountdown = -1;
+	this->eventLatency = 0;
+	this->dmaEvents = 0;
+	this->wakeupCount = 0;
+	this->resetCount = 0;
+	this->elapsedMs = 0;
+
+	for (int i = 0; i <= PIN_BOOT; i++) this->pins[i] = false;
+}
+
+/**
+ * Sets the transport whose rxtx() is called on each DMA event.
+ */
+void VN210DMAHal_Sim::attach(VN210RxTx * transport) {
+	this->transport = transport;
+}
+
+/**
+ * Clocks 'length' bytes from 'mosi' into the receive ring, and the same number
+ * out of the transmit ring into 'miso', unless it is NULL.  Crossing the middle
+ * or end of the rings raises a DMA event.  Does nothing to the rings if SPI
+ * hasn't been started.
+ */
+void VN210DMAHal_Sim::exchange(const uint8_t * mosi, uint8_t * miso, size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		uint8_t b = 0x00;
+
+		if (this->length > 0) {
+			b = this->txRing[this->position];
+			this->rxRing[this->position] = mosi[i];
+
+			if (++this->position == this->length) this->position = 0;
+
+			//half-transfer or transfer-complete. a second event before the first is handled merges with it.
+			if ((this->position == 0 || this->position == this->length / 2) && this->eventCountdown < 0) {
+				this->dmaEvents++;
+				this->eventCountdown = this->eventLatency;
+			}
+		}
+
+		if (miso != NULL) miso[i] = b;
+
+		if (this->eventCountdown == 0) {
+			this->eventCountdown = -1;
+			if (this->transport != NULL) this->transport->rxtx();
+		} else if (this->eventCountdown > 0) {
+			this->eventCountdown--;
+		}
+	}
+}
+
+/**
+ * Raises the NSS rising-edge event, which decodes the last bytes of an exchange.
+ */
+void VN210DMAHal_Sim::endTransfer(void) {
+	if (this->transport != NULL && this->length > 0) this->transport->rxtx();
+}
+
+/**
+ * Starts the simulated SPI slave over the given rings.
+ */
+void VN210DMAHal_Sim::startSPISlave(volatile uint8_t * rxRing, volatile uint8_t * txRing, uint16_t length) {
+	this->rxRing = rxRing;
+	this->txRing = txRing;
+	this->length = length;
+	this->position = 0;
+	this->eventCountdown = -1;
+}
+
+/**
+ * Returns the index of the next byte the simulated DMA will write.
+ */
+uint16_t VN210DMAHal_Sim::rxPosition(void) {
+	return this->position;
+}
+
+/**
+ * Records the level of a control line, counting WKU and RESET pulses.
+ */
+void VN210DMAHal_Sim::writePin(Pin pin, bool level) {
+	if (pin == PIN_WAKEUP && level && !this->pins[pin]) this->wakeupCount++;
+	if (pin == PIN_RESET && !level && this->pins[pin]) this->resetCount++;
+
+	this->pins[pin] = level;
+}
+
+/**
+ * Adds to the simulated clock.
+ */
+void VN210DMAHal_Sim::delayMs(uint16_t ms) {
+	this->elapsedMs += ms;
+}
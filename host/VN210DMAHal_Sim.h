@@ -0,0 +1,73 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "VN210DMAHal.h"
+#include "VN210RxTx.h"
+#include <stddef.h>
+
+#ifndef VN210DMAHal_Sim_H_
+#define VN210DMAHal_Sim_H_
+
+/**
+ * Simulated DMA HAL, for running VN210RxTx_DMA on a PC.
+ *
+ * The caller plays the part of the SPI master.  exchange() clocks bytes through
+ * the DMA rings exactly as the SPI peripheral would, and runs the transport's
+ * rxtx() on every half-transfer and transfer-complete event.  endTransfer()
+ * raises the chip select (NSS) event at the end of an exchange.
+ *
+ * Setting eventLatency delays each DMA event by that many bytes, to model
+ * interrupt latency.  Pin writes are recorded and delays only add to a
+ * simulated clock.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+class VN210DMAHal_Sim : public VN210DMAHal {
+public:
+	VN210DMAHal_Sim();
+
+	void attach(VN210RxTx * transport);								//sets the transport whose rxtx() handles DMA events
+	void exchange(const uint8_t * mosi, uint8_t * miso, size_t length);	//clocks a block of bytes each way. miso may be NULL.
+	void endTransfer(void);											//raises the NSS event, as at the end of an exchange
+
+	void startSPISlave(volatile uint8_t * rxRing, volatile uint8_t * txRing, uint16_t length);
+	uint16_t rxPosition(void);
+	void writePin(Pin pin, bool level);
+	void delayMs(uint16_t ms);
+
+	uint16_t eventLatency;											//!< Bytes clocked between a DMA event and its rxtx() call
+	uint32_t dmaEvents;												//!< Number of half-transfer and transfer-complete events raised
+	uint32_t wakeupCount;											//!< Number of WKU pulses
+	uint32_t resetCount;											//!< Number of RESET pulses
+	uint32_t elapsedMs;												//!< Total of all delays
+	bool pins[PIN_BOOT + 1];										//!< Current level of each control line
+private:
+	VN210RxTx * transport;											//!< Transport handling the events, or NULL
+	volatile uint8_t * rxRing;										//!< Receive ring, written by the simulated DMA
+	volatile uint8_t * txRing;										//!< Transmit ring, read by the simulated DMA
+	uint16_t length;												//!< Length of each ring.  Zero until started.
+	uint16_t position;												//!< Index of the next byte in both rings
+	int32_t eventCountdown;											//!< Bytes until the pending DMA event is handled, or -1 if none
+};
+
+#endif /* VN210DMAHal_Sim_H_ */
@@ -0,0 +1,80 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210FrameBuilder.h"
+#include "VN210RxTx.h"
+
+/**
+ * Appends one byte of a frame body, escaping STX and CHX as described in 3.1.3.2.
+ */
+static void appendEscaped(std::vector<uint8_t> & out, uint8_t b) {
+	if (b == API_STX) {
+		out.push_back(API_CHX);
+		out.push_back(0x0E);
+	} else if (b == API_CHX) {
+		out.push_back(API_CHX);
+		out.push_back(0x0D);
+	} else {
+		out.push_back(b);
+	}
+}
+
+/**
+ * Appends a complete frame: STX, header, type, ID, size, data and CRC (MSB first),
+ * with every byte after the STX escaped.
+ */
+size_t VN210FrameBuilder::append(std::vector<uint8_t> & out, uint8_t header, uint8_t type, uint8_t id, const uint8_t * data, uint8_t dataSize) {
+	size_t start = out.size();
+	uint16_t crc = VN210_CRC_INITIAL_VALUE;
+	uint8_t fields[4] = { header, type, id, dataSize };
+
+	out.push_back(API_STX);
+
+	for (int i = 0; i < 4; i++) {
+		crc = _crc_xmodem_update(crc, fields[i]);
+		appendEscaped(out, fields[i]);
+	}
+
+	for (int i = 0; i < dataSize; i++) {
+		crc = _crc_xmodem_update(crc, data[i]);
+		appendEscaped(out, data[i]);
+	}
+
+	appendEscaped(out, crc >> 8);
+	appendEscaped(out, crc & 0xFF);
+
+	return out.size() - start;
+}
+
+/**
+ * Appends an API_POLLING request.
+ */
+size_t VN210FrameBuilder::appendPoll(std::vector<uint8_t> & out, uint8_t id) {
+	return append(out, 0x48, 0x09, id, NULL, 0);
+}
+
+/**
+ * Appends a run of STX characters.
+ */
+void VN210FrameBuilder::appendStxFlood(std::vector<uint8_t> & out, size_t count) {
+	out.insert(out.end(), count, API_STX);
+}
@@ -0,0 +1,49 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#ifndef VN210FrameBuilder_H_
+#define VN210FrameBuilder_H_
+
+/**
+ * Builds escaped, CRC'd VN210 API frames on the host, as the radio would send
+ * them.  Used by the host benchmarks and simulators to drive the transport.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+class VN210FrameBuilder {
+public:
+	//appends a complete frame to 'out', returning the number of bytes appended
+	static size_t append(std::vector<uint8_t> & out, uint8_t header, uint8_t type, uint8_t id, const uint8_t * data, uint8_t dataSize);
+
+	//appends a polling message (API command 9) to 'out'
+	static size_t appendPoll(std::vector<uint8_t> & out, uint8_t id);
+
+	//appends 'count' STX characters, as sent by the radio while it waits for a message
+	static void appendStxFlood(std::vector<uint8_t> & out, size_t count);
+};
+
+#endif /* VN210FrameBuilder_H_ */
@@ -0,0 +1,317 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210Pipeline.h"
+#include "VN210SimpleAPI.h"
+#include <string.h>
+#include <chrono>
+
+/**
+ * Class constructor.  Sets up 'links' links, each with its own decoder, and the
+ * queues for 'workers' workers and 'sinks' sinks.  No threads run until start().
+ */
+VN210Pipeline::VN210Pipeline(uint32_t links, uint16_t workers, uint16_t sinks) : running(false), busy(0) {
+	this->linkCount = links;
+	this->workerCount = workers > 0 ? workers : 1;
+	this->sinkCount = sinks > 0 ? sinks : 1;
+
+	this->links = new Link[this->linkCount];
+	this->workers = new Worker[this->workerCount];
+	this->sinks = new VN210BoundedQueue<VN210PipelineRecord>[this->sinkCount];
+
+	for (uint32_t i = 0; i < this->linkCount; i++) {
+		Link & link = this->links[i];
+
+		link.chunks.init(VN210_PIPELINE_LINK_CHUNKS);
+		link.scheduled.store(false, std::memory_order_relaxed);
+		link.hasNewMessage = false;
+		link.frames = 0;
+
+		link.decoder.registerNewMessageFlag(&link.hasNewMessage);
+		link.decoder.rxFrame = &link.frame;
+		link.decoder.begin();
+	}
+
+	//a link is on at most one ready queue, so each has room for all of them, plus a cell for each worker part way through a pop
+	size_t readyCapacity = 1;
+	while (readyCapacity < (size_t) this->linkCount + this->workerCount) readyCapacity <<= 1;
+
+	for (uint16_t w = 0; w < this->workerCount; w++) {
+		Worker & worker = this->workers[w];
+
+		worker.ready.init(readyCapacity);
+		worker.bytes = 0;
+		worker.frames = 0;
+		worker.crcErrors = 0;
+		worker.records = 0;
+		worker.steals = 0;
+	}
+
+	for (uint16_t s = 0; s < this->sinkCount; s++) this->sinks[s].init(VN210_PIPELINE_SINK_RECORDS);
+}
+
+/**
+ * Class destructor.  Stops the workers if they are running.
+ */
+VN210Pipeline::~VN210Pipeline() {
+	this->stop();
+
+	delete [] this->sinks;
+	delete [] this->workers;
+	delete [] this->links;
+}
+
+/**
+ * Starts the worker threads.  Does nothing if they are already running.
+ */
+void VN210Pipeline::start(void) {
+	if (this->running.exchange(true)) return;
+
+	for (uint16_t w = 0; w < this->workerCount; w++) {
+		this->workers[w].thread = std::thread(&VN210Pipeline::run, this, w);
+	}
+}
+
+/**
+ * Stops the worker threads, once each has finished the link it is decoding.
+ * Bytes still queued stay queued and are decoded if start() is called again.
+ * Workers waiting for room in a full sink drop the record they were holding.
+ */
+void VN210Pipeline::stop(void) {
+	if (!this->running.exchange(false)) return;
+
+	for (uint16_t w = 0; w < this->workerCount; w++) this->workers[w].thread.join();
+}
+
+/**
+ * Queues bytes received on a link for decoding, in chunks of up to
+ * VN210_PIPELINE_CHUNK_SIZE bytes, and makes the link ready for a worker.
+ * Returns the number of bytes queued, which is less than 'length' if the link's
+ * queue filled up.  Only call for a given link from one thread at a time.
+ */
+size_t VN210Pipeline::ingest(uint32_t link, const uint8_t * bytes, size_t length) {
+	if (link >= this->linkCount) return 0;
+
+	Link & l = this->links[link];
+	Chunk chunk;
+	size_t queued = 0;
+
+	while (queued < length) {
+		chunk.length = length - queued < VN210_PIPELINE_CHUNK_SIZE ? length - queued : VN210_PIPELINE_CHUNK_SIZE;
+		memcpy(chunk.bytes, bytes + queued, chunk.length);
+
+		if (!l.chunks.push(chunk)) break;
+		queued += chunk.length;
+	}
+
+	if (queued > 0) this->schedule(link % this->workerCount, link);
+
+	return queued;
+}
+
+/**
+ * Takes the next record for sink 'sink'.  Returns false if there is none waiting.
+ * Only call for a given sink from one thread at a time, or records from a link
+ * may be handled out of order.
+ */
+bool VN210Pipeline::pop(uint16_t sink, VN210PipelineRecord & record) {
+	return sink < this->sinkCount && this->sinks[sink].pop(record);
+}
+
+/**
+ * Returns true if every byte ingested so far has been decoded.  Records may
+ * still be waiting in the sinks.
+ */
+bool VN210Pipeline::isIdle(void) const {
+	return this->busy.load(std::memory_order_acquire) == 0;
+}
+
+/**
+ * Returns totals over all workers and links.  The counters are only exact while
+ * the workers are stopped.
+ */
+VN210PipelineStats VN210Pipeline::getStats(void) const {
+	VN210PipelineStats stats = { 0, 0, 0, 0, 0, 0 };
+
+	for (uint16_t w = 0; w < this->workerCount; w++) {
+		const Worker & worker = this->workers[w];
+
+		stats.bytes += worker.bytes;
+		stats.frames += worker.frames;
+		stats.crcErrors += worker.crcErrors;
+		stats.records += worker.records;
+		stats.steals += worker.steals;
+	}
+
+	for (uint32_t i = 0; i < this->linkCount; i++) stats.framingErrors += this->links[i].decoder.framingErrors;
+
+	return stats;
+}
+
+uint32_t VN210Pipeline::getLinkCount(void) const {
+	return this->linkCount;
+}
+
+uint16_t VN210Pipeline::getWorkerCount(void) const {
+	return this->workerCount;
+}
+
+uint16_t VN210Pipeline::getSinkCount(void) const {
+	return this->sinkCount;
+}
+
+/**
+ * Worker thread.  Decodes ready links until stop() is called.  A link is put
+ * back on this worker's ready queue if bytes arrived while it was being decoded,
+ * or it had more than one batch waiting, behind any links already there.
+ */
+void VN210Pipeline::run(uint16_t w) {
+	Worker & worker = this->workers[w];
+	uint32_t idle = 0;
+	uint32_t link;
+
+	while (this->running.load(std::memory_order_relaxed)) {
+		if (!this->next(w, link)) {
+			//give the CPU to the I/O threads, and sleep if nothing turns up for a while
+			if (++idle < VN210_PIPELINE_IDLE_YIELDS) std::this_thread::yield();
+			else std::this_thread::sleep_for(std::chrono::microseconds(VN210_PIPELINE_IDLE_SLEEP_US));
+			continue;
+		}
+
+		idle = 0;
+		this->decode(worker, link);
+
+		Link & l = this->links[link];
+
+		//an exchange rather than a store: ingest() either sees the link unscheduled, or its chunk is seen here
+		l.scheduled.exchange(false, std::memory_order_acq_rel);
+		if (!l.chunks.isEmpty()) this->schedule(w, link);
+
+		this->busy.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+/**
+ * Takes a link from worker w's ready queue or, if it is empty, from the next
+ * worker along with one waiting.  Returns false if no link is ready anywhere.
+ */
+bool VN210Pipeline::next(uint16_t w, uint32_t & link) {
+	if (this->workers[w].ready.pop(link)) return true;
+
+	for (uint16_t i = 1; i < this->workerCount; i++) {
+		if (this->workers[(w + i) % this->workerCount].ready.pop(link)) {
+			this->workers[w].steals++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Puts a link on worker w's ready queue, unless it is already on one or being
+ * decoded.  The queue has room for every link, so the push only has to wait if
+ * another thread is part way through popping the cell it needs.
+ */
+void VN210Pipeline::schedule(uint16_t w, uint32_t link) {
+	if (this->links[link].scheduled.exchange(true, std::memory_order_acq_rel)) return;
+
+	this->busy.fetch_add(1, std::memory_order_relaxed);
+	while (!this->workers[w].ready.push(link)) std::this_thread::yield();
+}
+
+/**
+ * Runs up to VN210_PIPELINE_BATCH_CHUNKS of the link's chunks through its
+ * decoder, emitting records for each valid frame as it completes.
+ */
+void VN210Pipeline::decode(Worker & worker, uint32_t link) {
+	Link & l = this->links[link];
+	Chunk chunk;
+
+	for (int n = 0; n < VN210_PIPELINE_BATCH_CHUNKS && l.chunks.pop(chunk); n++) {
+		for (uint16_t i = 0; i < chunk.length; i++) {
+			l.decoder.feed(chunk.bytes[i]);
+
+			if (l.hasNewMessage) {
+				if (l.decoder.parseMessage()) {
+					worker.frames++;
+					this->emit(worker, link);
+				} else {
+					worker.crcErrors++;
+				}
+				l.decoder.releaseMessage();
+			}
+		}
+
+		worker.bytes += chunk.length;
+	}
+}
+
+/**
+ * Turns the link's parsed frame into records: one per attribute value for
+ * write requests and read responses, otherwise one for the whole frame.
+ */
+void VN210Pipeline::emit(Worker & worker, uint32_t link) {
+	Link & l = this->links[link];
+	const VN210FrameView & frame = l.frame;
+
+	VN210PipelineRecord record;
+	record.link = link;
+	record.frame = l.frames++;
+	record.header = frame.header();
+	record.type = frame.messageType();
+	record.messageID = frame.messageID();
+	record.attribute = 0;
+	record.value = 0;
+
+	bool hasValues = frame.messageClass() == VN210SimpleAPI::DATA_PASS_THROUGH
+			&& (frame.messageType() == VN210SimpleAPI::WRITE_DATA_REQUEST || frame.messageType() == VN210SimpleAPI::READ_DATA_RESPONSE)
+			&& frame.dataSize() >= VN210_ATTRIBUTE_SIZE;
+
+	if (!hasValues) {
+		this->deliver(worker, record);
+		return;
+	}
+
+	const uint8_t * data = frame.data();
+
+	for (uint8_t i = 0; i + VN210_ATTRIBUTE_SIZE <= frame.dataSize(); i += VN210_ATTRIBUTE_SIZE) {
+		record.attribute = data[i];
+		VN210FloatCodec::decode(data + i + 1, record.value);
+		this->deliver(worker, record);
+	}
+}
+
+/**
+ * Pushes a record to sink (link % sinks), yielding while the sink is full.
+ * Gives up if stop() is called meanwhile.
+ */
+void VN210Pipeline::deliver(Worker & worker, const VN210PipelineRecord & record) {
+	VN210BoundedQueue<VN210PipelineRecord> & sink = this->sinks[record.link % this->sinkCount];
+
+	while (!sink.push(record)) {
+		if (!this->running.load(std::memory_order_relaxed)) return;
+		std::this_thread::yield();
+	}
+
+	worker.records++;
+}
@@ -0,0 +1,264 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210RxTx_Host.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <thread>
+
+#ifndef VN210Pipeline_H_
+#define VN210Pipeline_H_
+
+#define VN210_PIPELINE_CHUNK_SIZE 256								//largest block of link bytes queued at once
+#define VN210_PIPELINE_LINK_CHUNKS 16								//chunks queued per link before ingest() refuses more. power of two
+#define VN210_PIPELINE_SINK_RECORDS 65536							//records queued per sink before workers wait. power of two
+#define VN210_PIPELINE_BATCH_CHUNKS 4								//chunks a worker decodes from one link before moving on to the next
+#define VN210_PIPELINE_IDLE_YIELDS 64								//times an idle worker yields before it starts sleeping
+#define VN210_PIPELINE_IDLE_SLEEP_US 50								//sleep between looks for work once a worker has been idle for a while
+
+/**
+ * Bounded lock-free queue for any number of producer and consumer threads
+ * (D. Vyukov's bounded MPMC queue).  Each cell has a sequence number which says
+ * whether it is ready to be written or read for a given lap of the ring, so
+ * push() and pop() only contend on the head or tail index they move.  Items
+ * pushed by one thread are popped in the order they were pushed, and an item
+ * pushed after another has been pushed by a different thread is popped after it.
+ */
+template <typename T>
+class VN210BoundedQueue {
+public:
+	VN210BoundedQueue() {
+		this->cells = NULL;
+		this->mask = 0;
+	}
+
+	~VN210BoundedQueue() {
+		delete [] this->cells;
+	}
+
+	/**
+	 * Allocates room for 'capacity' items, which must be a power of two.  Not thread safe.
+	 */
+	void init(size_t capacity) {
+		delete [] this->cells;
+		this->cells = new Cell[capacity];
+		this->mask = capacity - 1;
+
+		for (size_t i = 0; i < capacity; i++) this->cells[i].sequence.store(i, std::memory_order_relaxed);
+		this->head.store(0, std::memory_order_relaxed);
+		this->tail.store(0, std::memory_order_relaxed);
+	}
+
+	/**
+	 * Copies 'value' onto the back of the queue.  Returns false if it is full.
+	 */
+	bool push(const T & value) {
+		size_t pos = this->tail.load(std::memory_order_relaxed);
+
+		for (;;) {
+			Cell & cell = this->cells[pos & this->mask];
+			intptr_t lap = (intptr_t) cell.sequence.load(std::memory_order_acquire) - (intptr_t) pos;
+
+			if (lap == 0) {
+				if (this->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					cell.value = value;
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (lap < 0) {
+				return false;		//the cell still holds last lap's item
+			} else {
+				pos = this->tail.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/**
+	 * Copies the item at the front of the queue to 'value' and removes it.
+	 * Returns false if the queue is empty.
+	 */
+	bool pop(T & value) {
+		size_t pos = this->head.load(std::memory_order_relaxed);
+
+		for (;;) {
+			Cell & cell = this->cells[pos & this->mask];
+			intptr_t lap = (intptr_t) cell.sequence.load(std::memory_order_acquire) - (intptr_t) (pos + 1);
+
+			if (lap == 0) {
+				if (this->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					value = cell.value;
+					cell.sequence.store(pos + this->mask + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (lap < 0) {
+				return false;		//nothing pushed into this cell yet
+			} else {
+				pos = this->head.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/**
+	 * Returns true if there was nothing to pop when called.
+	 */
+	bool isEmpty() const {
+		size_t pos = this->head.load(std::memory_order_relaxed);
+		return (intptr_t) this->cells[pos & this->mask].sequence.load(std::memory_order_acquire) - (intptr_t) (pos + 1) < 0;
+	}
+private:
+	struct Cell {
+		std::atomic<size_t> sequence;								//!< Position the cell can next be pushed at, or that position + 1 once it holds an item
+		T value;													//!< Item
+	};
+
+	Cell * cells;													//!< Ring of cells
+	size_t mask;													//!< Capacity - 1
+	alignas(64) std::atomic<size_t> head;							//!< Position of the next pop
+	alignas(64) std::atomic<size_t> tail;							//!< Position of the next push
+};
+
+/**
+ * One decoded frame, or one attribute value from it.
+ */
+typedef struct {
+	uint32_t link;													//!< Link the frame arrived on
+	uint32_t frame;													//!< Number of the frame on its link, counting valid frames from 0
+	uint8_t header;													//!< Message class and request / response flag
+	uint8_t type;													//!< Message type
+	uint8_t messageID;												//!< Message ID
+	uint8_t attribute;												//!< Attribute ID, or 0 for a frame without attribute values
+	float value;													//!< Attribute value, or 0
+} VN210PipelineRecord;
+
+/**
+ * Totals over all links and workers.
+ */
+typedef struct {
+	uint64_t bytes;													//!< Link bytes decoded
+	uint64_t frames;												//!< Frames with a valid CRC
+	uint64_t crcErrors;												//!< Frames with a bad CRC
+	uint64_t framingErrors;											//!< Frames abandoned by the framing state machine (see VN210RxTx)
+	uint64_t records;												//!< Records passed to sinks
+	uint64_t steals;												//!< Links a worker took from another worker's ready queue
+} VN210PipelineStats;
+
+/**
+ * Multi-threaded receive pipeline for a gateway or concentrator terminating
+ * many radio links, where one thread calling receiveByte() / parseMessage()
+ * for every link can't keep up.
+ *
+ *  - I/O threads (the caller's) hand each link's raw bytes to ingest(), which
+ *    queues them on the link.  Each link must only be fed by one thread.
+ *  - A pool of worker threads does the framing, CRC check and attribute
+ *    decoding, with one VN210RxTx_Host decoder per link.  A link with bytes
+ *    waiting goes on its home worker's ready queue; a worker with nothing to do
+ *    takes links from the other workers' queues, so busy links spread over the
+ *    pool.  A link is only ever on one ready queue and held by one worker at a
+ *    time, and a worker decodes at most VN210_PIPELINE_BATCH_CHUNKS of its
+ *    chunks before putting it back, so frames are decoded in order and one busy
+ *    link can't hold a worker.
+ *  - Valid frames are turned into records, one per attribute value for write
+ *    requests and read responses and one per frame otherwise, and go to sink
+ *    (link % sinks) through a lock-free queue.  The sink's consumer pop()s them.
+ *    Records from one link reach its sink in the order the frames arrived.
+ *
+ * Nothing is locked on the data path: the queues are VN210BoundedQueues.  If a
+ * link's queue fills up, ingest() queues what it can and the I/O thread should
+ * pass the rest again later.  If a sink's queue is full its workers wait, so slow consumers
+ * hold up decoding rather than lose records.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+class VN210Pipeline {
+public:
+	VN210Pipeline(uint32_t links, uint16_t workers, uint16_t sinks);
+	~VN210Pipeline();
+
+	void start(void);												//starts the worker threads
+	void stop(void);												//stops the worker threads.  bytes still queued are left
+
+	size_t ingest(uint32_t link, const uint8_t * bytes, size_t length);	//queues a link's bytes for decoding. returns how many were queued
+	bool pop(uint16_t sink, VN210PipelineRecord & record);			//takes the next record for a sink. false if there is none
+	bool isIdle(void) const;										//returns true if no bytes are waiting or being decoded
+
+	VN210PipelineStats getStats(void) const;						//totals.  exact once stop() has returned
+
+	uint32_t getLinkCount(void) const;
+	uint16_t getWorkerCount(void) const;
+	uint16_t getSinkCount(void) const;
+private:
+	/**
+	 * Block of bytes from a link.
+	 */
+	typedef struct {
+		uint16_t length;											//!< Bytes used
+		uint8_t bytes[VN210_PIPELINE_CHUNK_SIZE];					//!< Link bytes, in arrival order
+	} Chunk;
+
+	/**
+	 * Per link state.
+	 */
+	struct alignas(64) Link {
+		VN210BoundedQueue<Chunk> chunks;							//!< Bytes waiting to be decoded
+		std::atomic<bool> scheduled;								//!< Set while the link is on a ready queue or being decoded
+		VN210RxTx_Host decoder;										//!< Framing state and receive buffer
+		VN210FrameView frame;										//!< Last frame parsed by the decoder
+		bool hasNewMessage;											//!< Set by the decoder when a frame is complete
+		uint32_t frames;											//!< Valid frames so far
+	};
+
+	/**
+	 * Per worker state.  Only the worker writes its counters.
+	 */
+	struct alignas(64) Worker {
+		VN210BoundedQueue<uint32_t> ready;							//!< Links with bytes waiting, homed on this worker or put back by it
+		std::thread thread;											//!< Worker thread
+		uint64_t bytes;												//!< Link bytes decoded
+		uint64_t frames;											//!< Frames with a valid CRC
+		uint64_t crcErrors;											//!< Frames with a bad CRC
+		uint64_t records;											//!< Records pushed to sinks
+		uint64_t steals;											//!< Links taken from other workers
+	};
+
+	uint32_t linkCount;												//!< Number of links
+	uint16_t workerCount;											//!< Number of worker threads
+	uint16_t sinkCount;												//!< Number of sinks
+
+	Link * links;													//!< Link state, indexed by link number
+	Worker * workers;												//!< Worker state
+	VN210BoundedQueue<VN210PipelineRecord> * sinks;					//!< Records waiting for each sink
+
+	std::atomic<bool> running;										//!< Cleared by stop()
+	std::atomic<uint32_t> busy;										//!< Links scheduled and not yet finished
+
+	void run(uint16_t w);											//worker thread body
+	bool next(uint16_t w, uint32_t & link);							//takes a ready link, from the worker's own queue or another's
+	void schedule(uint16_t w, uint32_t link);						//puts a link with bytes waiting on worker w's ready queue, unless it is already scheduled
+	void decode(Worker & worker, uint32_t link);					//decodes up to VN210_PIPELINE_BATCH_CHUNKS chunks of a link
+	void emit(Worker & worker, uint32_t link);						//turns the link's parsed frame into records
+	void deliver(Worker & worker, const VN210PipelineRecord & record);	//pushes a record to its sink, waiting while the sink is full
+};
+
+#endif /* VN210Pipeline_H_ */
@@ -0,0 +1,118 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210RxTx_Host.h"
+
+/**
+ * Class constructor.
+ */
+VN210RxTx_Host::VN210RxTx_Host() {
+	this->resetCount = 0;
+	this->wakeupCount = 0;
+	this->sleepCount = 0;
+	this->mosiByte = 0;
+	this->misoByte = 0;
+}
+
+/**
+ * Clocks one byte from the simulated SPI master into the transport, returning
+ * the byte the transport sends back.
+ */
+uint8_t VN210RxTx_Host::exchange(uint8_t mosi) {
+	this->mosiByte = mosi;
+	this->rxtx();
+	return this->misoByte;
+}
+
+/**
+ * Clocks 'length' bytes from 'mosi' into the transport.  The bytes sent back are
+ * written to 'miso', unless it is NULL.
+ */
+void VN210RxTx_Host::exchange(const uint8_t * mosi, uint8_t * miso, size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		uint8_t b = this->exchange(mosi[i]);
+		if (miso != NULL) miso[i] = b;
+	}
+}
+
+/**
+ * Passes a byte to the receive decoder without touching the transmit buffer.
+ */
+void VN210RxTx_Host::feed(uint8_t rxb) {
+	this->receiveByte(rxb);
+}
+
+/**
+ * Receives and transmits one byte, in the same way as the Arduino SPI interrupt.
+ */
+void VN210RxTx_Host::rxtx() {
+	if (this->packing) {
+		this->misoByte = 0x00;
+	} else {
+		this->misoByte = txBuff.idx < txBuff.byteCount ? txBuff.bytes[txBuff.idx++] : 0x00;
+
+		//if the entire message has been sent, reset the transmit buffer so that no more messages are sent
+		if ((txBuff.idx > 0) && (txBuff.idx == txBuff.byteCount)) this->resetTransmitBuffer();
+	}
+
+	this->receiveByte(this->mosiByte);
+}
+
+/**
+ * Counts radio resets.  There is no radio to reset.
+ */
+void VN210RxTx_Host::resetRadio() {
+	this->resetCount++;
+}
+
+/**
+ * Counts sleeps and returns straight away.  Simulators using this transport
+ * decide how long the processor would have slept.
+ */
+void VN210RxTx_Host::sleep() {
+	this->sleepCount++;
+}
+
+/**
+ * Does nothing.  There is no radio to provision.
+ */
+void VN210RxTx_Host::provisionRadio() {
+}
+
+/**
+ * Does nothing.  There is no SPI hardware.
+ */
+void VN210RxTx_Host::enable() {
+}
+
+/**
+ * Does nothing.  There are no IO pins.
+ */
+void VN210RxTx_Host::initIO() {
+}
+
+/**
+ * Counts wakeup pulses.
+ */
+void VN210RxTx_Host::wakeupRadio() {
+	this->wakeupCount++;
+}
@@ -0,0 +1,68 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "VN210RxTx.h"
+#include <stddef.h>
+
+#ifndef VN210RxTx_Host_H_
+#define VN210RxTx_Host_H_
+
+/**
+ * Host (Linux) implementation of the VN210 transport layer, with no hardware behind it.
+ *
+ * The caller plays the part of the SPI master: each call to exchange() clocks one
+ * byte to the application side and returns the byte clocked back, exactly as the
+ * SPI interrupt does on Arduino.  This lets the transport and Simple API be
+ * built, benchmarked and simulated on a PC.
+ *
+ * Radio reset and wakeup requests, and sleeps, are counted rather than acted on.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ * @ingroup Lowlevel
+ */
+class VN210RxTx_Host : public VN210RxTx {
+public:
+	VN210RxTx_Host();
+
+	uint8_t exchange(uint8_t mosi);									//clocks one byte each way, returning the byte sent by the application side
+	void exchange(const uint8_t * mosi, uint8_t * miso, size_t length);	//clocks a block of bytes each way. miso may be NULL.
+	void feed(uint8_t rxb);											//passes a byte straight to the receive decoder, without transmitting
+
+	void rxtx(void);												//exchanges the pending MOSI byte
+	void resetRadio();												//counts radio resets
+	void sleep(void);												//counts sleeps. returns straight away
+	void provisionRadio() __attribute__ ((deprecated));				//does nothing
+
+	uint32_t resetCount;											//!< Number of times resetRadio() has been called
+	uint32_t wakeupCount;											//!< Number of wakeup pulses requested
+	uint32_t sleepCount;											//!< Number of times sleep() has been called
+private:
+	uint8_t mosiByte;												//!< Byte being clocked in by the simulated master
+	uint8_t misoByte;												//!< Byte clocked out in reply
+
+	void enable();													//does nothing - no SPI hardware
+	void initIO();													//does nothing - no IO pins
+	void wakeupRadio();												//counts wakeup pulses
+};
+
+#endif /* VN210RxTx_Host_H_ */
@@ -0,0 +1,350 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210SeriesStore.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Returns the position of the first record in 'records' with a timestamp of at
+ * least 'time', or 'count' if there isn't one.
+ */
+static size_t lowerBound(const VN210SeriesRecord * records, size_t count, uint64_t time) {
+	size_t lo = 0;
+	size_t hi = count;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (records[mid].time < time) lo = mid + 1; else hi = mid;
+	}
+
+	return lo;
+}
+
+/**
+ * Returns the file offset of the first block in a segment with 'blockCount'
+ * blocks: after the header and index, rounded up to a page boundary.
+ */
+static uint64_t blocksOffset(uint32_t blockCount) {
+	uint64_t offset = sizeof(VN210SeriesSegmentHeader) + (uint64_t) blockCount * sizeof(VN210SeriesBlockIndex);
+	return (offset + VN210_SERIES_BLOCK_BYTES - 1) / VN210_SERIES_BLOCK_BYTES * VN210_SERIES_BLOCK_BYTES;
+}
+
+/**
+ * Class constructor.  Nothing is mapped until open() is called.
+ */
+VN210SeriesStore::VN210SeriesStore() {
+	this->segmentBytes = VN210_SERIES_SEGMENT_BYTES;
+}
+
+/**
+ * Class destructor.  Unmaps every segment.
+ */
+VN210SeriesStore::~VN210SeriesStore() {
+	this->close();
+}
+
+/**
+ * Opens the store in 'directory' and maps the segment files already there.  New
+ * segments are created 'segmentBytes' long, which must be big enough for a few
+ * blocks; existing segments keep the size they were made with.
+ *
+ * Returns false if a segment file couldn't be mapped or isn't a segment.
+ */
+bool VN210SeriesStore::open(const char * directory, size_t segmentBytes) {
+	this->close();
+	this->directory = directory;
+	this->segmentBytes = segmentBytes;
+
+	for (size_t n = 0; access(this->segmentPath(n).c_str(), F_OK) == 0; n++) {
+		if (!this->mapSegment(this->segmentPath(n), false)) {
+			this->close();
+			return false;
+		}
+
+		const Segment & segment = this->segments.back();
+
+		for (uint32_t b = 0; b < segment.header->blocksUsed; b++) {
+			BlockRef ref = { (uint32_t) n, b };
+			this->seriesBlocks[seriesKey(segment.index[b].node, segment.index[b].attribute)].push_back(ref);
+		}
+	}
+
+	//carry on filling the blocks of the newest segment. later blocks of a series replace earlier ones.
+	if (!this->segments.empty()) {
+		const Segment & newest = this->segments.back();
+
+		for (uint32_t b = 0; b < newest.header->blocksUsed; b++) {
+			this->openBlocks[seriesKey(newest.index[b].node, newest.index[b].attribute)] = b;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Unmaps every segment.  The kernel still writes back any dirty pages.
+ */
+void VN210SeriesStore::close(void) {
+	for (size_t i = 0; i < this->segments.size(); i++) {
+		munmap(this->segments[i].base, this->segments[i].size);
+	}
+
+	this->segments.clear();
+	this->openBlocks.clear();
+	this->seriesBlocks.clear();
+}
+
+/**
+ * Appends a value to its series.  'value' is the 4 byte value as sent by the
+ * node, which is stored as it is.
+ */
+bool VN210SeriesStore::append(uint16_t node, uint8_t attribute, uint64_t time, const uint8_t * value) {
+	uint32_t block = VN210_SERIES_NO_BLOCK;
+
+	std::map<uint32_t, uint32_t>::const_iterator open = this->openBlocks.find(seriesKey(node, attribute));
+
+	if (open != this->openBlocks.end()) {
+		const Segment & segment = this->segments.back();
+		const VN210SeriesBlockIndex & entry = segment.index[open->second];
+
+		//a full block, or a timestamp going backwards, needs a new block
+		if (entry.count < segment.header->recordsPerBlock && time >= entry.lastTime) block = open->second;
+	}
+
+	if (block == VN210_SERIES_NO_BLOCK) block = this->newBlock(node, attribute);
+	if (block == VN210_SERIES_NO_BLOCK) return false;
+
+	Segment & segment = this->segments.back();
+	VN210SeriesBlockIndex & entry = segment.index[block];
+	VN210SeriesRecord & record = segment.records[(size_t) block * segment.header->recordsPerBlock + entry.count];
+
+	record.time = time;
+	record.node = node;
+	record.attribute = attribute;
+	record.reserved = 0;
+	memcpy(record.value, value, VN210_ATTRIBUTE_VALUE_SIZE);
+
+	if (entry.count == 0) entry.firstTime = time;
+	entry.lastTime = time;
+	entry.count++;		//only once the record is complete
+
+	if (time < segment.header->firstTime) segment.header->firstTime = time;
+	if (time > segment.header->lastTime) segment.header->lastTime = time;
+
+	return true;
+}
+
+/**
+ * Appends every attribute in a passthrough payload: a run of 1 byte ID and
+ * 4 byte value pairs, as in a READ_DATA_RESPONSE or WRITE_DATA_REQUEST.  All the
+ * values get the same timestamp.
+ */
+uint8_t VN210SeriesStore::appendAttributes(uint16_t node, uint64_t time, const uint8_t * pairs, uint8_t dataSize) {
+	uint8_t stored = 0;
+
+	for (uint8_t i = 0; i < dataSize / VN210_ATTRIBUTE_SIZE; i++) {
+		if (!this->append(node, pairs[0], time, pairs + 1)) break;
+
+		pairs += VN210_ATTRIBUTE_SIZE;
+		stored++;
+	}
+
+	return stored;
+}
+
+/**
+ * Passes every record of the node's attribute with a timestamp from 'from' to
+ * 'to' inclusive to 'callback', a block at a time.  The records are in the
+ * mapping, so they are only valid until the store is closed.  Blocks are passed
+ * oldest first; the records in each are in time order.
+ */
+size_t VN210SeriesStore::scan(uint16_t node, uint8_t attribute, uint64_t from, uint64_t to, ScanCallback callback, void * context) const {
+	size_t total = 0;
+
+	std::map<uint32_t, std::vector<BlockRef> >::const_iterator series = this->seriesBlocks.find(seriesKey(node, attribute));
+	if (series == this->seriesBlocks.end()) return 0;
+
+	const std::vector<BlockRef> & blocks = series->second;
+
+	for (size_t i = 0; i < blocks.size(); i++) {
+		const Segment & segment = this->segments[blocks[i].segment];
+		const VN210SeriesBlockIndex & entry = segment.index[blocks[i].block];
+
+		if (entry.count == 0 || entry.lastTime < from || entry.firstTime > to) continue;
+
+		const VN210SeriesRecord * records = &segment.records[(size_t) blocks[i].block * segment.header->recordsPerBlock];
+		size_t first = lowerBound(records, entry.count, from);
+		size_t end = to == UINT64_MAX ? entry.count : lowerBound(records, entry.count, to + 1);
+
+		if (end > first) {
+			callback(records + first, end - first, context);
+			total += end - first;
+		}
+	}
+
+	return total;
+}
+
+/**
+ * Writes every segment back to disk, waiting for the writes to finish.
+ */
+bool VN210SeriesStore::flush(void) {
+	bool ok = true;
+
+	for (size_t i = 0; i < this->segments.size(); i++) {
+		if (msync(this->segments[i].base, this->segments[i].size, MS_SYNC) != 0) ok = false;
+	}
+
+	return ok;
+}
+
+/**
+ * Returns the number of segment files in the store.
+ */
+size_t VN210SeriesStore::getSegmentCount(void) const {
+	return this->segments.size();
+}
+
+/**
+ * Maps a segment file.  With 'create' set, the file is made segmentBytes long and
+ * formatted with as many blocks, and their index entries, as fit.  Otherwise the
+ * header is checked.
+ */
+bool VN210SeriesStore::mapSegment(const std::string & path, bool create) {
+	int fd = ::open(path.c_str(), create ? O_RDWR | O_CREAT | O_EXCL : O_RDWR, 0644);
+	if (fd < 0) return false;
+
+	size_t size = this->segmentBytes;
+	struct stat st;
+
+	if (create ? ftruncate(fd, size) != 0 : fstat(fd, &st) != 0) {
+		::close(fd);
+		if (create) unlink(path.c_str());
+		return false;
+	}
+
+	if (!create) size = st.st_size;
+
+	if (size < sizeof(VN210SeriesSegmentHeader)) {
+		::close(fd);
+		return false;
+	}
+
+	void * base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);		//the mapping keeps the file open
+
+	if (base == MAP_FAILED) return false;
+
+	Segment segment;
+	segment.base = (uint8_t *) base;
+	segment.size = size;
+	segment.header = (VN210SeriesSegmentHeader *) base;
+	segment.index = (VN210SeriesBlockIndex *) (segment.base + sizeof(VN210SeriesSegmentHeader));
+
+	VN210SeriesSegmentHeader * header = segment.header;
+
+	if (create) {
+		//the file starts out as zeros, so only the header needs writing
+		uint32_t blockCount = (size - sizeof(VN210SeriesSegmentHeader)) / (VN210_SERIES_BLOCK_BYTES + sizeof(VN210SeriesBlockIndex));
+
+		//rounding the blocks up to a page boundary can push the last one past the end
+		while (blockCount > 0 && blocksOffset(blockCount) + (uint64_t) blockCount * VN210_SERIES_BLOCK_BYTES > size) blockCount--;
+
+		header->magic = VN210_SERIES_MAGIC;
+		header->version = VN210_SERIES_VERSION;
+		header->recordsPerBlock = VN210_SERIES_BLOCK_BYTES / sizeof(VN210SeriesRecord);
+		header->blockCount = blockCount;
+		header->blocksUsed = 0;
+		header->blocksOffset = blocksOffset(blockCount);
+		header->firstTime = UINT64_MAX;
+		header->lastTime = 0;
+	}
+
+	bool valid = header->magic == VN210_SERIES_MAGIC && header->version == VN210_SERIES_VERSION
+			&& header->recordsPerBlock > 0 && header->blockCount > 0 && header->blocksUsed <= header->blockCount
+			&& header->blocksOffset + (uint64_t) header->blockCount * header->recordsPerBlock * sizeof(VN210SeriesRecord) <= size;
+
+	if (!valid) {
+		munmap(base, size);
+		if (create) unlink(path.c_str());		//too small for a block. don't leave it to fail the next open()
+		return false;
+	}
+
+	segment.records = (VN210SeriesRecord *) (segment.base + header->blocksOffset);
+	this->segments.push_back(segment);
+
+	return true;
+}
+
+/**
+ * Creates and maps the next segment file.  Blocks in earlier segments are no
+ * longer filled.
+ */
+bool VN210SeriesStore::addSegment(void) {
+	if (!this->mapSegment(this->segmentPath(this->segments.size()), true)) return false;
+
+	this->openBlocks.clear();
+	return true;
+}
+
+/**
+ * Hands out the next unused block of the newest segment to the series, starting
+ * a new segment if they are all in use.
+ */
+uint32_t VN210SeriesStore::newBlock(uint16_t node, uint8_t attribute) {
+	if (this->segments.empty() || this->segments.back().header->blocksUsed == this->segments.back().header->blockCount) {
+		if (!this->addSegment()) return VN210_SERIES_NO_BLOCK;
+	}
+
+	Segment & segment = this->segments.back();
+	uint32_t block = segment.header->blocksUsed;
+
+	VN210SeriesBlockIndex & entry = segment.index[block];
+	entry.node = node;
+	entry.attribute = attribute;
+	entry.reserved = 0;
+	entry.count = 0;
+	entry.firstTime = 0;
+	entry.lastTime = 0;
+
+	segment.header->blocksUsed++;
+	this->openBlocks[seriesKey(node, attribute)] = block;
+
+	BlockRef ref = { (uint32_t) (this->segments.size() - 1), block };
+	this->seriesBlocks[seriesKey(node, attribute)].push_back(ref);
+
+	return block;
+}
+
+/**
+ * Returns the path of segment file 'number'.
+ */
+std::string VN210SeriesStore::segmentPath(size_t number) const {
+	char name[32];
+	snprintf(name, sizeof(name), "/segment-%06lu.vts", (unsigned long) number);
+	return this->directory + name;
+}
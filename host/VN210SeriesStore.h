@@ -0,0 +1,164 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210Schema.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifndef VN210SeriesStore_H_
+#define VN210SeriesStore_H_
+
+#define VN210_SERIES_MAGIC 0x56543231								//identifies a segment file
+#define VN210_SERIES_VERSION 1										//segment layout version
+#define VN210_SERIES_BLOCK_BYTES 4096								//bytes of records in each block, one page
+#define VN210_SERIES_SEGMENT_BYTES (64UL * 1024 * 1024)				//default segment file size
+#define VN210_SERIES_NO_BLOCK 0xFFFFFFFF							//returned by newBlock() when no block could be found
+
+/**
+ * One attribute value, as stored in a segment.  16 bytes, so a block holds 256.
+ */
+typedef struct {
+	uint64_t time;													//!< Timestamp given to append(), e.g. ms since the epoch
+	uint16_t node;													//!< Node the value came from
+	uint8_t attribute;												//!< Attribute ID
+	uint8_t reserved;												//!< Always 0
+	uint8_t value[VN210_ATTRIBUTE_VALUE_SIZE];						//!< Value as sent by the node.  Decode with the attribute's codec from VN210Schema.h
+} VN210SeriesRecord;
+
+/**
+ * Start of a segment file.  Padded to 64 bytes.
+ */
+typedef struct {
+	uint32_t magic;													//!< VN210_SERIES_MAGIC
+	uint16_t version;												//!< VN210_SERIES_VERSION
+	uint16_t recordsPerBlock;										//!< Records in each block
+	uint32_t blockCount;											//!< Blocks in the segment
+	uint32_t blocksUsed;											//!< Blocks handed out so far, in order
+	uint64_t blocksOffset;											//!< File offset of the first block
+	uint64_t firstTime;												//!< Earliest timestamp in the segment
+	uint64_t lastTime;												//!< Latest timestamp in the segment
+	uint8_t reserved[24];											//!< Always 0
+} VN210SeriesSegmentHeader;
+
+/**
+ * Index entry for one block.  Every record in a block belongs to the same node
+ * and attribute, in time order.
+ */
+typedef struct {
+	uint16_t node;													//!< Node the block's records came from
+	uint8_t attribute;												//!< Attribute ID of the block's records
+	uint8_t reserved;												//!< Always 0
+	uint32_t count;													//!< Records written to the block
+	uint64_t firstTime;												//!< Timestamp of the first record
+	uint64_t lastTime;												//!< Timestamp of the last record
+} VN210SeriesBlockIndex;
+
+/**
+ * Time-series store for attribute values received by a Linux gateway.
+ *
+ * Values are appended as (node, attribute ID, timestamp, value) records to
+ * fixed-size segment files in one directory, which are memory mapped.  Each
+ * segment is split into page-sized blocks, each holding the records of a single
+ * node and attribute in time order, with an index of the blocks after the
+ * segment header.  When every block is used, a new segment file is started.
+ *
+ * The block indexes are read into a list of blocks for each series when the
+ * store is opened.  scan() goes through the blocks of one series, skips those
+ * outside the time range, binary searches for the ends of the range and passes
+ * the records to a callback in place, straight from the mapping: nothing is
+ * copied or decoded.
+ *
+ * Timestamps must not go backwards within a series.  If they do, the value
+ * starts a new block so each block stays in order.
+ *
+ * Records reach the disk when the kernel writes the pages back, or on flush().
+ * A record is counted in its block's index entry only after it has been written,
+ * so a crash loses at most the records not yet written back.
+ *
+ * Segment files are in host byte order and are not portable between hosts of
+ * different endianness.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+class VN210SeriesStore {
+public:
+	//called by scan() with each run of records in the range, in time order
+	typedef void (*ScanCallback)(const VN210SeriesRecord * records, size_t count, void * context);
+
+	VN210SeriesStore();
+	~VN210SeriesStore();
+
+	//opens the store in 'directory', which must exist, mapping any segments already there
+	bool open(const char * directory, size_t segmentBytes = VN210_SERIES_SEGMENT_BYTES);
+	void close(void);												//unmaps every segment
+
+	//stores one value, in the 4 byte wire format. returns false if a new segment couldn't be created.
+	bool append(uint16_t node, uint8_t attribute, uint64_t time, const uint8_t * value);
+
+	//stores each ID + value pair from a read response or write request payload. returns the number stored.
+	uint8_t appendAttributes(uint16_t node, uint64_t time, const uint8_t * pairs, uint8_t dataSize);
+
+	//passes the records of one series with from <= time <= to to 'callback'. returns the number of records.
+	size_t scan(uint16_t node, uint8_t attribute, uint64_t from, uint64_t to, ScanCallback callback, void * context) const;
+
+	bool flush(void);												//writes every segment back to disk
+	size_t getSegmentCount(void) const;								//returns the number of segment files
+private:
+	/**
+	 * A mapped segment file.
+	 */
+	typedef struct {
+		uint8_t * base;												//!< Start of the mapping
+		size_t size;												//!< Length of the mapping
+		VN210SeriesSegmentHeader * header;							//!< Segment header, at the start of the mapping
+		VN210SeriesBlockIndex * index;								//!< Block index, after the header
+		VN210SeriesRecord * records;								//!< First record of the first block
+	} Segment;
+
+	/**
+	 * Location of a block.
+	 */
+	typedef struct {
+		uint32_t segment;											//!< Position in 'segments'
+		uint32_t block;												//!< Block number in the segment
+	} BlockRef;
+
+	std::string directory;											//!< Directory holding the segment files
+	size_t segmentBytes;											//!< Size of new segment files
+	std::vector<Segment> segments;									//!< Mapped segments, oldest first
+	std::map<uint32_t, uint32_t> openBlocks;						//!< Block being filled for each series in the newest segment, by seriesKey()
+	std::map<uint32_t, std::vector<BlockRef> > seriesBlocks;		//!< Every block of each series, oldest first, by seriesKey()
+
+	static uint32_t seriesKey(uint16_t node, uint8_t attribute) { return ((uint32_t) node << 8) | attribute; }
+
+	bool mapSegment(const std::string & path, bool create);			//maps a segment file, formatting it first if 'create' is set
+	bool addSegment(void);											//starts a new segment file
+	uint32_t newBlock(uint16_t node, uint8_t attribute);			//hands out the next block of the newest segment, starting a new segment if needed
+	std::string segmentPath(size_t number) const;					//returns the file name of segment 'number'
+};
+
+#endif /* VN210SeriesStore_H_ */
@@ -0,0 +1,68 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210SettingsFile.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Class constructor.  The path is not copied, so it must stay valid.
+ */
+VN210SettingsFile::VN210SettingsFile(const char * path) {
+	this->path = path;
+	this->writeCount = 0;
+}
+
+/**
+ * Reads the record into 'out'.  Whatever couldn't be read is zero, which is
+ * never a valid record.
+ */
+void VN210SettingsFile::read(uint8_t * out, uint8_t length) {
+	size_t got = 0;
+	FILE * file = fopen(this->path, "rb");
+
+	if (file != NULL) {
+		got = fread(out, 1, length, file);
+		fclose(file);
+	}
+
+	memset(out + got, 0, length - got);
+}
+
+/**
+ * Writes the record to a temporary file next to the real one, then renames it
+ * into place.  Failures are ignored: the node carries on and tries again the
+ * next time the record changes.
+ */
+void VN210SettingsFile::write(const uint8_t * in, uint8_t length) {
+	char temporary[1024];
+	snprintf(temporary, sizeof(temporary), "%s.tmp", this->path);
+
+	FILE * file = fopen(temporary, "wb");
+	if (file == NULL) return;
+
+	bool written = fwrite(in, 1, length, file) == length;
+	written &= fclose(file) == 0;
+
+	if (written && rename(temporary, this->path) == 0) this->writeCount++;
+	else remove(temporary);
+}
@@ -0,0 +1,50 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210SettingsStorage.h"
+
+#ifndef VN210SettingsFile_H_
+#define VN210SettingsFile_H_
+
+/**
+ * Warm start record (see VN210SimpleAPI::setSettingsStorage()) in a file, for
+ * host builds.  A missing or short file reads as no record.  Writes go to a
+ * temporary file which is then renamed over the old one, so a crash part way
+ * through leaves the previous record in place.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+class VN210SettingsFile : public VN210SettingsStorage {
+public:
+	VN210SettingsFile(const char * path);
+
+	void read(uint8_t * out, uint8_t length);						//reads the record, or zeros if there isn't one
+	void write(const uint8_t * in, uint8_t length);					//replaces the file with the record
+
+	uint32_t writeCount;											//!< Number of times the file has been written
+private:
+	const char * path;												//!< File holding the record
+};
+
+#endif /* VN210SettingsFile_H_ */
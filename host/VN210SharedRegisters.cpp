@@ -0,0 +1,205 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210SharedRegisters.h"
+#include <fcntl.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Class constructor.  Nothing is mapped until create() or open() is called.
+ */
+VN210SharedRegisters::VN210SharedRegisters() {
+	this->base = NULL;
+	this->size = 0;
+	this->nodes = NULL;
+}
+
+/**
+ * Class destructor.  Unmaps the segment, leaving it in place.
+ */
+VN210SharedRegisters::~VN210SharedRegisters() {
+	this->close();
+}
+
+/**
+ * Creates the segment 'name' (e.g. "/vn210") with room for 'nodeCount' nodes, all
+ * zero, and maps it for publishing.  An existing segment with the same name is
+ * replaced; processes which already have it open keep the old one.
+ */
+bool VN210SharedRegisters::create(const char * name, uint32_t nodeCount) {
+	this->close();
+
+	if (nodeCount == 0) return false;
+
+	shm_unlink(name);
+
+	int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (fd < 0) return false;
+
+	size_t size = sizeof(VN210SharedHeader) + (size_t) nodeCount * sizeof(VN210SharedNode);
+
+	if (ftruncate(fd, size) != 0 || !this->map(fd, size, true)) {
+		::close(fd);
+		shm_unlink(name);
+		return false;
+	}
+
+	::close(fd);		//the mapping keeps the segment open
+
+	//new segments are zero filled, so the nodes are ready. the header goes in last, so open() only accepts a complete segment.
+	VN210SharedHeader * header = (VN210SharedHeader *) this->base;
+	header->version = VN210_SHARED_VERSION;
+	header->nodeSize = sizeof(VN210SharedNode);
+	header->nodeCount = nodeCount;
+	__atomic_store_n(&header->magic, VN210_SHARED_MAGIC, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+/**
+ * Maps the existing segment 'name' read-only.  Fails if it doesn't exist or was
+ * made by a gateway built with a different layout.
+ */
+bool VN210SharedRegisters::open(const char * name) {
+	this->close();
+
+	int fd = shm_open(name, O_RDONLY, 0);
+	if (fd < 0) return false;
+
+	struct stat st;
+	bool mapped = fstat(fd, &st) == 0 && (size_t) st.st_size >= sizeof(VN210SharedHeader) && this->map(fd, st.st_size, false);
+	::close(fd);
+
+	if (!mapped) return false;
+
+	const VN210SharedHeader * header = (const VN210SharedHeader *) this->base;
+
+	bool valid = __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == VN210_SHARED_MAGIC
+			&& header->version == VN210_SHARED_VERSION && header->nodeSize == sizeof(VN210SharedNode)
+			&& sizeof(VN210SharedHeader) + (size_t) header->nodeCount * sizeof(VN210SharedNode) <= this->size;
+
+	if (!valid) this->close();
+
+	return valid;
+}
+
+/**
+ * Unmaps the segment.  Other processes can carry on using it.
+ */
+void VN210SharedRegisters::close(void) {
+	if (this->base != NULL) munmap(this->base, this->size);
+
+	this->base = NULL;
+	this->size = 0;
+	this->nodes = NULL;
+}
+
+/**
+ * Deletes the segment 'name'.  It goes once every process has unmapped it.
+ */
+bool VN210SharedRegisters::remove(const char * name) {
+	return shm_unlink(name) == 0;
+}
+
+/**
+ * Copies the API's uapData, info and transmit / duplicate statistics into the
+ * node's slot, with 'time' as the timestamp.  Readers see either the previous
+ * values or all of the new ones.  Only call this from the process which
+ * created the segment, and from one thread at a time.
+ */
+void VN210SharedRegisters::publish(uint32_t node, const VN210SimpleAPI & api, uint64_t time) {
+	if (this->base == NULL || node >= this->getNodeCount()) return;
+
+	VN210SharedNode & slot = this->nodes[node];
+	uint32_t sequence = slot.sequence;
+
+	//odd: readers retry until this publish is finished
+	__atomic_store_n(&slot.sequence, sequence + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	slot.publishes++;
+	slot.time = time;
+	slot.uapData = api.uapData;
+	slot.info = api.info;
+	slot.txDropped = api.txQueue.dropped;
+#if VN210_DUPLICATE_CACHE_SIZE
+	slot.duplicates = api.recentWrites.duplicates;
+#endif
+
+	__atomic_store_n(&slot.sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * Copies node 'node' to 'out'.  Retries while a publish is in progress, so the
+ * copy is always one whole publish.  Returns false if the node is out of range,
+ * or if it was being published on every attempt (e.g. the gateway died part
+ * way through).  Yields the CPU while a publish is in progress.
+ */
+bool VN210SharedRegisters::read(uint32_t node, VN210SharedNode & out) const {
+	if (this->base == NULL || node >= this->getNodeCount()) return false;
+
+	const VN210SharedNode & slot = this->nodes[node];
+
+	for (uint32_t attempt = 0; attempt < VN210_SHARED_READ_RETRIES; attempt++) {
+		uint32_t before = __atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE);
+		//mid-publish. the writer may have been preempted, so let it run rather than spin
+		if (before & 1) {
+			sched_yield();
+			continue;
+		}
+
+		memcpy(&out, &slot, sizeof(out));
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&slot.sequence, __ATOMIC_RELAXED) == before) {
+			out.sequence = before;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Returns the number of node slots in the mapped segment.
+ */
+uint32_t VN210SharedRegisters::getNodeCount(void) const {
+	return this->base != NULL ? ((const VN210SharedHeader *) this->base)->nodeCount : 0;
+}
+
+/**
+ * Maps 'size' bytes of the segment behind 'fd'.
+ */
+bool VN210SharedRegisters::map(int fd, size_t size, bool writable) {
+	void * mapping = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	if (mapping == MAP_FAILED) return false;
+
+	this->base = (uint8_t *) mapping;
+	this->size = size;
+	this->nodes = (VN210SharedNode *) (this->base + sizeof(VN210SharedHeader));
+
+	return true;
+}
@@ -0,0 +1,107 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210SimpleAPI.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef VN210SharedRegisters_H_
+#define VN210SharedRegisters_H_
+
+#define VN210_SHARED_MAGIC 0x56533231								//identifies a shared register file
+#define VN210_SHARED_VERSION 1										//layout version
+#define VN210_SHARED_READ_RETRIES 10000								//attempts read() makes before giving up on a node being written
+
+/**
+ * Start of the shared memory segment.  Padded to 64 bytes.
+ */
+typedef struct {
+	uint32_t magic;													//!< VN210_SHARED_MAGIC
+	uint16_t version;												//!< VN210_SHARED_VERSION
+	uint16_t nodeSize;												//!< sizeof(VN210SharedNode), so readers built differently are refused
+	uint32_t nodeCount;												//!< Number of node slots
+	uint8_t reserved[52];											//!< Always 0
+} VN210SharedHeader;
+
+/**
+ * One node's registers, as last published.  Each node has a cache line of its
+ * own, so publishing one node doesn't slow down readers of its neighbours.
+ */
+typedef struct __attribute__ ((aligned (64))) {
+	uint32_t sequence;												//!< Incremented before and after each publish: odd while one is in progress
+	uint32_t publishes;												//!< Number of publishes
+	uint64_t time;													//!< Timestamp given to publish()
+	VN210SimpleAPI::LocalUAPData uapData;							//!< Attribute values
+	VN210SimpleAPI::VN210Properties info;							//!< Radio information
+	uint16_t txDropped;												//!< Outgoing messages dropped by the transmit queue
+	uint16_t duplicates;											//!< Retransmitted writes acknowledged without being applied
+} VN210SharedNode;
+
+/**
+ * Register file for a gateway running a VN210SimpleAPI per node, in a named
+ * POSIX shared memory segment, so that other processes (HMI, historian, alarm
+ * logic) can read every node's current uapData and info without IPC calls or
+ * their own copy of the stack.
+ *
+ * The gateway create()s the segment and calls publish() for a node after
+ * handling its messages, in the same way as VN210SimpleAPI::publish() makes a
+ * consistent set of values visible to the radio.  Consumers open() the segment
+ * read-only and read() nodes.
+ *
+ * Each node has a sequence counter which publish() makes odd while it copies the
+ * node's values in, and even again once they're all there.  read() copies a node
+ * out and checks the counter was even and unchanged throughout, retrying if not,
+ * so readers never see a half-published node and never hold up the gateway.
+ * There must only be one writer.
+ *
+ * The segment holds the structs as they are laid out by the compiler, so readers
+ * must be built with the same compiler and configuration as the gateway.
+ * open() refuses a segment with a different version or node size.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+class VN210SharedRegisters {
+public:
+	VN210SharedRegisters();
+	~VN210SharedRegisters();
+
+	bool create(const char * name, uint32_t nodeCount);				//creates (or replaces) segment 'name' with 'nodeCount' zeroed nodes, for writing
+	bool open(const char * name);									//maps an existing segment read-only
+	void close(void);												//unmaps the segment.  it stays in place for other processes
+	static bool remove(const char * name);							//deletes segment 'name' once every process has closed it
+
+	void publish(uint32_t node, const VN210SimpleAPI & api, uint64_t time);	//copies the API's uapData, info and statistics into the node's slot
+
+	bool read(uint32_t node, VN210SharedNode & out) const;			//copies out a consistent snapshot of a node. false if out of range or never settles
+
+	uint32_t getNodeCount(void) const;								//returns the number of nodes, or 0 if nothing is mapped
+private:
+	uint8_t * base;													//!< Start of the mapping, or NULL
+	size_t size;													//!< Length of the mapping
+	VN210SharedNode * nodes;										//!< First node slot
+
+	bool map(int fd, size_t size, bool writable);					//maps the segment behind 'fd'
+};
+
+#endif /* VN210SharedRegisters_H_ */
@@ -0,0 +1,454 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * End-to-end Simple API benchmark.
+ *
+ * Runs VN210SimpleAPI on the host transport and plays the radio's side of the
+ * link: each exchange clocks one request frame followed by enough STX characters
+ * for the application's reply, then runs the application's loop() until the frame
+ * has been handled and released.  The replies clocked back are decoded and counted.
+ *
+ * For each workload it reports frames per second, time per byte in the SPI
+ * interrupt path (rxtx() and receiveByte()), time to handle each frame from
+ * hasNewMessage() to the reply being packed, and the peak stack used while
+ * handling.  Workloads with one reply per request fail the run if any are missing.
+ *
+ * Also checks that a frame arriving while a VN210Scheduler task runs is received,
+ * rather than dropped because the frame before it is still held, and that a
+ * reply packed by the interrupt just before the main loop loads a queued
+ * message is sent rather than packed over.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+#include "VN210RxTx_Host.h"
+#include "VN210FrameBuilder.h"
+#include "VN210SimpleAPI.h"
+#include "VN210Scheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <chrono>
+
+#define BENCH_EXCHANGES 1000			//radio exchanges in each workload
+#define BENCH_MIN_FRAMES 200000			//each workload is repeated until at least this many frames have been sent
+#define BENCH_REPLY_ROOM (2 * (UAP_ATTRIBUTES_BUFFER_SIZE + VN210_FRAME_SIZE_MINUS_DATA))	//STX sent after each request, room for the longest escaped reply
+#define BENCH_STACK_SAMPLES 64			//exchanges with their stack use measured
+#define BENCH_STACK_AREA 16384			//bytes of stack painted before each measurement
+#define BENCH_STACK_PAINT 0xA5			//paint pattern
+
+static const char * workloads[] = { "poll-only", "write-analog", "read-all-8", "mixed-api", "corrupted" };
+
+/**
+ * One exchange with the application: the bytes the radio clocks in, and the
+ * Simple API call the application makes beforehand, if any.
+ */
+typedef struct {
+	std::vector<uint8_t> mosi;
+	uint8_t appCall;
+} Exchange;
+
+enum {
+	APP_NONE,
+	APP_GET_FIRMWARE_VERSION,
+	APP_GET_MAX_BUFFER,
+	APP_SEND_ALARM
+};
+
+typedef struct {
+	uint32_t frames;
+	uint32_t bytes;
+	uint32_t handled;
+	uint32_t crcErrors;
+	uint32_t replies;
+	double exchangeNs;
+	double handleNs;
+	size_t peakStack;
+} BenchResult;
+
+/**
+ * Appends a write request for one analog attribute, as in VN210_MasterPoller.
+ */
+static void appendWrite(std::vector<uint8_t> & out, uint8_t id, uint8_t attribute, float value) {
+	uint8_t data[VN210_ATTRIBUTE_SIZE];
+	data[0] = attribute;
+	VN210FloatCodec::encode(value, &data[1]);			//big-endian, as the radio sends it
+	VN210FrameBuilder::append(out, 0x10, 0x01, id, data, sizeof(data));
+}
+
+/**
+ * Appends a read request for every attribute in uapData.
+ */
+static void appendReadAll(std::vector<uint8_t> & out, uint8_t id) {
+	static const uint8_t ids[UAP_ATTRIBUTES_COUNT] = { 1, 2, 3, 4, 16, 17, 18, 19 };
+	VN210FrameBuilder::append(out, 0x10, 0x02, id, ids, sizeof(ids));
+}
+
+/**
+ * Builds the exchanges for the named workload.  Returns true if every request
+ * should get a reply.
+ */
+static bool buildWorkload(const char * name, std::vector<Exchange> & exchanges) {
+	uint8_t data[4];
+	srand(1);
+
+	exchanges.resize(BENCH_EXCHANGES);
+
+	for (int i = 0; i < BENCH_EXCHANGES; i++) {
+		std::vector<uint8_t> & out = exchanges[i].mosi;
+		uint8_t id = i & 0xFF;
+		exchanges[i].appCall = APP_NONE;
+
+		if (!strcmp(name, "poll-only")) {
+			VN210FrameBuilder::appendPoll(out, id);
+		} else if (!strcmp(name, "write-analog")) {
+			appendWrite(out, id, 1 + i % UAP_ANALOGS_COUNT, (float) i * 0.25f);
+		} else if (!strcmp(name, "read-all-8")) {
+			appendReadAll(out, id);
+		} else if (!strcmp(name, "mixed-api")) {
+			//the radio's traffic, with the application's own API requests and their replies mixed in
+			switch (i % 8) {
+				case 0: case 4: VN210FrameBuilder::appendPoll(out, id); break;
+				case 1: appendWrite(out, id, 1 + i % UAP_ANALOGS_COUNT, (float) i); break;
+				case 2: appendReadAll(out, id); break;
+				case 3:
+					data[0] = 1 + i % UAP_ANALOGS_COUNT;
+					VN210FrameBuilder::append(out, 0x10, 0x02, id, data, 1);
+					break;
+				case 5:
+					data[0] = 0x03;
+					data[1] = 0x01;
+					VN210FrameBuilder::append(out, 0x48, VN210SimpleAPI::API_FW_VERSION, id, data, 2);
+					break;
+				case 6:
+					data[0] = 0x00;
+					data[1] = 0x80;
+					VN210FrameBuilder::append(out, 0x48, VN210SimpleAPI::API_MAX_BUFFER, id, data, 2);
+					break;
+				case 7:
+					data[0] = 0x00;
+					data[1] = 0x01;
+					VN210FrameBuilder::append(out, 0x48, VN210SimpleAPI::API_HW_PLATFORM, id, data, 2);
+					break;
+			}
+
+			if (i % 16 == 4) exchanges[i].appCall = APP_GET_FIRMWARE_VERSION;
+			if (i % 16 == 12) exchanges[i].appCall = APP_GET_MAX_BUFFER;
+			if (i % 32 == 20) exchanges[i].appCall = APP_SEND_ALARM;
+		} else if (!strcmp(name, "corrupted")) {
+			size_t start = out.size();
+
+			switch (rand() % 4) {
+				case 0:
+					appendWrite(out, id, 1 + i % UAP_ANALOGS_COUNT, (float) i);
+					out[start + 1 + rand() % (out.size() - start - 1)] ^= 1 << (rand() % 8);	//one bad bit
+					break;
+				case 1:
+					appendReadAll(out, id);
+					out.resize(out.size() - 1 - rand() % 4);									//truncated
+					break;
+				case 2:
+					appendWrite(out, id, 1, 0.0f);
+					out[start + 4] = 0xF0;														//size byte too big
+					break;
+				case 3:
+					for (int j = 8 + rand() % 24; j > 0; j--) out.push_back(rand() & 0xFF);	//noise, then a poll
+					VN210FrameBuilder::appendPoll(out, id);
+					break;
+			}
+		}
+
+		VN210FrameBuilder::appendStxFlood(out, BENCH_REPLY_ROOM);
+	}
+
+	return !strcmp(name, "write-analog") || !strcmp(name, "read-all-8");
+}
+
+/**
+ * Makes the application's own Simple API call for an exchange.
+ */
+static void appCall(VN210SimpleAPI & api, uint8_t call) {
+	static const uint8_t alarm[4] = { 0xDE, 0xAD, 0xBE, 0xEF };
+
+	switch (call) {
+		case APP_GET_FIRMWARE_VERSION: api.getFirmwareVersion(); break;
+		case APP_GET_MAX_BUFFER: api.getMaxBufferSize(); break;
+		case APP_SEND_ALARM: api.sendAlarm(0x20, sizeof(alarm), alarm); break;
+	}
+}
+
+/**
+ * The application's loop(), run until the received frame has been handled and
+ * released, counting the frames handled and those with a bad CRC.
+ */
+static void appLoop(VN210SimpleAPI & api, BenchResult & result) {
+	while (api.hasNewMessage()) {
+		api.handleMessage();
+		result.handled++;
+		result.crcErrors += !api.info.crcValid;
+	}
+}
+
+/**
+ * Fills an area of stack with the paint pattern.  Has the same frame as
+ * unpaintedStack(), so both see the same addresses when called from the same function.
+ */
+static void __attribute__((noinline)) paintStack(void) {
+	volatile uint8_t area[BENCH_STACK_AREA];
+	for (size_t i = 0; i < sizeof(area); i++) area[i] = BENCH_STACK_PAINT;
+}
+
+/**
+ * Returns the number of bytes of the area painted by paintStack() that have been
+ * overwritten since.  The stack grows down, so the search starts at the bottom.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+static size_t __attribute__((noinline)) unpaintedStack(void) {
+	volatile uint8_t area[BENCH_STACK_AREA];		//deliberately uninitialised: holds what the handler left
+	size_t i = 0;
+	while (i < sizeof(area) && area[i] == BENCH_STACK_PAINT) i++;
+	return sizeof(area) - i;
+}
+#pragma GCC diagnostic pop
+
+/**
+ * Handles the frame from one exchange on a painted stack, returning the stack used.
+ */
+static size_t __attribute__((noinline)) measureStack(VN210SimpleAPI & api, BenchResult & result) {
+	paintStack();
+	appLoop(api, result);
+	return unpaintedStack();
+}
+
+/**
+ * Counts the replies in the bytes clocked back to the radio.
+ */
+static void countReplies(VN210RxTx_Host & radio, bool & flag, const uint8_t * miso, size_t length, BenchResult & result) {
+	for (size_t i = 0; i < length; i++) {
+		radio.feed(miso[i]);
+
+		if (flag) {
+			if (radio.parseMessage()) result.replies++;
+			radio.releaseMessage();
+		}
+	}
+}
+
+/**
+ * Runs a workload through a freshly started Simple API.
+ */
+static BenchResult runWorkload(const std::vector<Exchange> & exchanges) {
+	BenchResult result;
+	memset(&result, 0, sizeof(result));
+
+	VN210RxTx_Host transport;
+	VN210SimpleAPI api(&transport);
+	memset(&api.uapData, 0, sizeof(api.uapData));
+	api.begin(false);
+
+	//the radio's receive decoder, for the replies
+	VN210RxTx_Host radio;
+	VN210FrameView radioView;
+	bool radioFlag = false;
+	radio.registerNewMessageFlag(&radioFlag);
+	radio.rxFrame = &radioView;
+	radio.begin();
+
+	std::vector<uint8_t> miso(BENCH_EXCHANGES * (UAP_ATTRIBUTES_BUFFER_SIZE + BENCH_REPLY_ROOM) * 2);
+
+	for (uint32_t round = 0; result.frames < BENCH_MIN_FRAMES; round++) {
+		for (size_t i = 0; i < exchanges.size(); i++) {
+			const std::vector<uint8_t> & mosi = exchanges[i].mosi;
+
+			appCall(api, exchanges[i].appCall);
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			transport.exchange(&mosi[0], &miso[0], mosi.size());
+			std::chrono::steady_clock::time_point received = std::chrono::steady_clock::now();
+
+			if (round == 0 && i < BENCH_STACK_SAMPLES) {
+				//untimed: painting the stack would swamp the handling time
+				size_t used = measureStack(api, result);
+				if (used > result.peakStack) result.peakStack = used;
+			} else {
+				appLoop(api, result);
+
+				std::chrono::steady_clock::time_point handled = std::chrono::steady_clock::now();
+				result.handleNs += std::chrono::duration<double, std::nano>(handled - received).count();
+			}
+
+			result.exchangeNs += std::chrono::duration<double, std::nano>(received - start).count();
+			result.frames++;
+			result.bytes += mosi.size();
+
+			countReplies(radio, radioFlag, &miso[0], mosi.size(), result);
+		}
+	}
+
+	//one more exchange to clock out the reply to the last request
+	std::vector<uint8_t> flood(BENCH_REPLY_ROOM, API_STX);
+	transport.exchange(&flood[0], &miso[0], flood.size());
+	countReplies(radio, radioFlag, &miso[0], flood.size(), result);
+
+	return result;
+}
+
+static VN210RxTx_Host * taskTransport;						//transport the task below clocks a frame into
+static std::vector<uint8_t> taskFrame;						//frame clocked in by the task
+
+/**
+ * Scheduler task which plays the radio sending a frame while the task runs.
+ */
+static void feedFrameFromTask(void) {
+	taskTransport->exchange(&taskFrame[0], NULL, taskFrame.size());
+}
+
+/**
+ * Checks that a frame arriving during a scheduler task isn't dropped.  run()
+ * handles a write, then its task clocks in a second write before the next run().
+ * Returns false if the second write was dropped.
+ */
+static bool checkFrameDuringTask(void) {
+	VN210RxTx_Host transport;
+	VN210SimpleAPI api(&transport);
+	memset(&api.uapData, 0, sizeof(api.uapData));
+	api.begin(false);
+
+	VN210Scheduler scheduler(&api);
+	taskTransport = &transport;
+	scheduler.addTask(feedFrameFromTask, 1, 0);
+
+	std::vector<uint8_t> first;
+	appendWrite(first, 1, 1, 1.0f);
+	VN210FrameBuilder::appendStxFlood(first, BENCH_REPLY_ROOM);
+
+	taskFrame.clear();
+	appendWrite(taskFrame, 2, 2, 2.0f);
+	VN210FrameBuilder::appendStxFlood(taskFrame, BENCH_REPLY_ROOM);
+
+	transport.exchange(&first[0], NULL, first.size());
+
+	bool handledFirst = scheduler.run(1);		//the task runs after the first write is handled
+	bool handledSecond = scheduler.run(1);
+
+	return handledFirst && handledSecond && transport.droppedBytes == 0 && api.uapData.analogs[1].value == 2.0f;
+}
+
+/**
+ * Clocks out whatever the application has to send, returning the frames the
+ * radio decodes as "type:id" pairs.
+ */
+static std::string clockOut(VN210RxTx_Host & transport) {
+	VN210RxTx_Host radio;
+	VN210FrameView radioView;
+	bool radioFlag = false;
+	radio.registerNewMessageFlag(&radioFlag);
+	radio.rxFrame = &radioView;
+	radio.begin();
+
+	std::vector<uint8_t> flood(BENCH_REPLY_ROOM, API_STX);
+	std::vector<uint8_t> miso(flood.size());
+	transport.exchange(&flood[0], &miso[0], flood.size());
+
+	std::string frames;
+	char frame[16];
+
+	for (size_t i = 0; i < miso.size(); i++) {
+		radio.feed(miso[i]);
+
+		if (radioFlag) {
+			if (radio.parseMessage()) {
+				snprintf(frame, sizeof(frame), "%02X:%02X ", radioView.messageType(), radioView.messageID());
+				frames += frame;
+			}
+			radio.releaseMessage();
+		}
+	}
+
+	return frames;
+}
+
+/**
+ * Checks that a reply packed by the interrupt between the transmit queue
+ * finding the buffer empty and packing its next message is sent, and that the
+ * queued message follows it.  Returns false if either is lost.
+ */
+static bool checkInterruptReplyKept(void) {
+	VN210RxTx_Host transport;
+	VN210SimpleAPI api(&transport);
+	memset(&api.uapData, 0, sizeof(api.uapData));
+	api.begin(false);
+
+	//the interrupt answers a read just before the queue loads the request below
+	VN210_APIMessage reply = { API_STX, 0x18, 0x02, 0x33, 0, NULL, { 0 } };
+	transport.sendMsgFromInterrupt(&reply);
+	api.getFirmwareVersion();
+
+	std::string frames = clockOut(transport);
+	api.hasNewMessage();							//loads the request now the reply has gone
+	frames += clockOut(transport);
+
+	char request[16];
+	snprintf(request, sizeof(request), "%02X:", VN210SimpleAPI::API_FW_VERSION);
+
+	return frames.compare(0, 6, "02:33 ") == 0 && frames.find(request, 6) != std::string::npos && api.txQueue.dropped == 0;
+}
+
+int main(void) {
+	bool allReplied = true;
+
+	printf("VN210_BUFFER_SIZE %d, shared buffer %d, snapshot %d\n\n", VN210_BUFFER_SIZE, VN210_SHARED_BUFFER, VN210_UAP_SNAPSHOT);
+	printf("%-14s %10s %10s %10s %10s %10s %10s %8s\n", "workload", "frames/s", "rxtx ns/B", "handle ns", "handled", "crc errs", "replies", "stack B");
+
+	for (size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++) {
+		std::vector<Exchange> exchanges;
+		bool replyEach = buildWorkload(workloads[w], exchanges);
+
+		BenchResult result = runWorkload(exchanges);
+		uint32_t timedFrames = result.frames - BENCH_STACK_SAMPLES;
+
+		bool replied = !replyEach || result.replies == result.frames;
+		allReplied = allReplied && replied;
+
+		printf("%-14s %10.0f %10.2f %10.1f %10u %10u %10u %8lu%s\n", workloads[w],
+				result.frames / ((result.exchangeNs + result.handleNs * result.frames / timedFrames) * 1e-9),
+				result.exchangeNs / result.bytes,
+				result.handleNs / timedFrames,
+				result.handled,
+				result.crcErrors,
+				result.replies,
+				(unsigned long) result.peakStack,
+				replied ? "" : "  MISSING REPLIES");
+	}
+
+	bool taskFrameReceived = checkFrameDuringTask();
+	printf("\nframe during a scheduler task: %s\n", taskFrameReceived ? "received" : "FAIL: dropped");
+
+	bool interruptReplyKept = checkInterruptReplyKept();
+	printf("interrupt reply before a queued message: %s\n", interruptReplyKept ? "sent" : "FAIL: overwritten");
+
+	return allReplied && taskFrameReceived && interruptReplyKept ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * SCADA register bank benchmark.
+ *
+ * Feeds the same random samples, one per channel per tick, to an array of
+ * per-channel registers using SCADARegister's update (one addValue() call per
+ * channel per tick) and to a SCADARegisterBank (one addSamples() call per tick),
+ * for several channel counts.  Both are reset every 60 ticks, as at the end of a
+ * SCADA period.  It checks that the bank's averages, minima and maxima match the
+ * registers', then prints the time per channel sample for each and the speedup.
+ * It exits non-zero if the results differ.
+ *
+ * Usage: bench_bank [ticks]
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+#include "SCADARegisterBank.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#define BENCH_PERIOD_TICKS 60			//ticks between resets
+
+/**
+ * SCADARegister's values and update.  SCADARegister itself prints through the
+ * Arduino Serial object, so it doesn't build on the host.
+ */
+struct BenchRegister {
+	float average;
+	float minimum;
+	float maximum;
+	unsigned int total;
+
+	void reset() {
+		total = 0;
+		average = 0;
+		maximum = SC_FLOAT_MIN_VALUE;
+		minimum = SC_FLOAT_MAX_VALUE;
+	}
+
+	//not inlined, as each SCADARegister::addValue() is a call into another translation unit
+	__attribute__ ((noinline)) void addValue(float num) {
+		if (num > maximum) maximum = num;
+		if (num < minimum) minimum = num;
+
+		float sum = average * total;
+		average = (sum + num) / ++total;
+	}
+};
+
+static bool close(float a, float b) {
+	return fabsf(a - b) <= 1e-4f * (1 + fabsf(a));
+}
+
+/**
+ * Runs both layouts for N channels over 'ticks' ticks.  Returns false if they disagree.
+ */
+template <uint16_t N>
+static bool runBank(size_t ticks) {
+	std::vector<float> samples(ticks * N);
+	for (size_t i = 0; i < samples.size(); i++) samples[i] = (rand() % 200000) / 100.0f - 1000;
+
+	std::vector<BenchRegister> registers(N);
+	SCADARegisterBank<N> * bank = new SCADARegisterBank<N>();
+	bool match = true;
+
+	for (uint16_t c = 0; c < N; c++) registers[c].reset();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (size_t t = 0; t < ticks; t++) {
+		if (t % BENCH_PERIOD_TICKS == 0) for (uint16_t c = 0; c < N; c++) registers[c].reset();
+		for (uint16_t c = 0; c < N; c++) registers[c].addValue(samples[t * N + c]);
+	}
+	double registerNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	for (size_t t = 0; t < ticks; t++) {
+		if (t % BENCH_PERIOD_TICKS == 0) bank->reset();
+		bank->addSamples(&samples[t * N]);
+	}
+	double bankNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+	for (uint16_t c = 0; c < N; c++) {
+		if (!close(bank->average[c], registers[c].average) || bank->minimum[c] != registers[c].minimum
+				|| bank->maximum[c] != registers[c].maximum || bank->total != registers[c].total) {
+			match = false;
+		}
+	}
+
+	double channelSamples = (double) ticks * N;
+	printf("%8u %14.2f %14.2f %9.1fx %7s\n", N, registerNs / channelSamples, bankNs / channelSamples,
+			registerNs / bankNs, match ? "yes" : "NO");
+
+	delete bank;
+	return match;
+}
+
+int main(int argc, char ** argv) {
+	size_t ticks = argc > 1 ? atol(argv[1]) : 20000;
+	bool ok = true;
+
+	srand(1);
+
+#if SCADA_BANK_SSE
+	printf("bank update: SSE, 4 channels per instruction\n\n");
+#else
+	printf("bank update: scalar loop, as vectorised by the compiler\n\n");
+#endif
+	printf("%8s %14s %14s %10s %7s\n", "channels", "registers ns", "bank ns", "speedup", "match");
+
+	ok &= runBank<4>(ticks);
+	ok &= runBank<16>(ticks);
+	ok &= runBank<18>(ticks);
+	ok &= runBank<256>(ticks);
+	ok &= runBank<4096>(ticks / 16);
+
+	printf("\nchecks: %s\n", ok ? "pass" : "FAIL");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,245 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Bulk codec benchmark.
+ *
+ * Checks that VN210BulkCodec produces exactly the frames the transport's receive
+ * decoder does, and the same escaped bytes as sendMsg(), then reports decode and
+ * escape throughput for each scan implementation the CPU supports, with the
+ * byte-at-a-time transport decoder as the baseline.
+ *
+ * The test stream mixes frames with random payloads, escape-heavy payloads, STX
+ * floods, corrupted size bytes and random noise.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+#include "VN210BulkCodec.h"
+#include "VN210RxTx_Host.h"
+#include "VN210FrameBuilder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#define BENCH_STREAM_BYTES (16UL * 1024 * 1024)		//approximate size of the test stream
+#define BENCH_ROUNDS 8								//timed passes over the stream for each implementation
+
+static const char * levelNames[] = { "scalar", "sse2", "avx2" };
+
+/**
+ * Builds the test stream.
+ */
+static void buildStream(std::vector<uint8_t> & out) {
+	uint8_t data[VN210_BUFFER_SIZE];
+	srand(1);
+
+	for (uint32_t i = 0; out.size() < BENCH_STREAM_BYTES; i++) {
+		uint8_t size = rand() % (VN210_BUFFER_SIZE / 2 - VN210_FRAME_SIZE_MINUS_DATA);
+		int kind = rand() % 16;
+
+		for (int j = 0; j < size; j++) {
+			data[j] = kind == 0 ? (rand() & 1 ? API_STX : API_CHX) : rand() & 0xFF;
+		}
+
+		size_t start = out.size();
+		VN210FrameBuilder::append(out, 0x10, 0x01, i & 0xFF, data, size);
+
+		if (kind == 1) out[start + 4] = 0xF0;								//size byte too big
+		if (kind == 2) out[start + 1 + rand() % (out.size() - start - 1)] ^= 0x04;	//one bad bit
+		if (kind == 3) out.resize(out.size() - 1 - rand() % 4);				//truncated
+
+		if (kind == 4) VN210FrameBuilder::appendStxFlood(out, 64);
+		if (kind == 5) {
+			for (int j = rand() % 64; j > 0; j--) out.push_back(rand() & 0xFF);
+		}
+	}
+}
+
+/**
+ * Runs the stream through the transport's receive decoder, parsing each frame
+ * as soon as it's flagged.  Returns the elapsed time in ns.
+ */
+static double referenceDecode(const std::vector<uint8_t> & stream, std::vector<uint8_t> & out, std::vector<VN210BulkFrame> & frames) {
+	VN210FrameView view;
+	bool flag = false;
+
+	VN210RxTx_Host transport;
+	transport.registerNewMessageFlag(&flag);
+	transport.rxFrame = &view;
+	transport.begin();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (size_t i = 0; i < stream.size(); i++) {
+		transport.feed(stream[i]);
+
+		if (flag) {
+			VN210BulkFrame f;
+			f.streamOffset = 0;
+			f.offset = out.size();
+			f.length = transport.rxBuff.byteCount;
+
+			for (int j = 0; j < transport.rxBuff.byteCount; j++) out.push_back((uint8_t) transport.rxBuff.bytes[j]);
+
+			f.crcValid = transport.parseMessage();
+			transport.releaseMessage();
+			frames.push_back(f);
+		}
+	}
+
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+/**
+ * Decodes the stream in randomly sized blocks and compares the result with the reference.
+ */
+static bool checkDecode(const std::vector<uint8_t> & stream, const std::vector<uint8_t> & refOut, const std::vector<VN210BulkFrame> & refFrames) {
+	VN210BulkCodec codec;
+	std::vector<uint8_t> out;
+	std::vector<VN210BulkFrame> frames;
+
+	for (size_t i = 0; i < stream.size(); ) {
+		size_t block = 1 + rand() % 4096;
+		if (block > stream.size() - i) block = stream.size() - i;
+
+		codec.decode(&stream[i], block, out, frames);
+		i += block;
+	}
+
+	if (frames.size() != refFrames.size() || out != refOut) return false;
+
+	for (size_t i = 0; i < frames.size(); i++) {
+		if (frames[i].length != refFrames[i].length || frames[i].crcValid != refFrames[i].crcValid) return false;
+		if (stream[frames[i].streamOffset] != API_STX) return false;
+	}
+
+	return true;
+}
+
+/**
+ * Compares escape() with the frames sendMsg() packs for a range of payloads.
+ */
+static bool checkEscape(void) {
+	uint8_t data[VN210_BUFFER_SIZE];
+	uint8_t plain[VN210_BUFFER_SIZE];
+	uint8_t escaped[2 * VN210_BUFFER_SIZE];
+
+	VN210RxTx_Host transport;
+	bool flag = false;
+	transport.registerNewMessageFlag(&flag);
+	transport.begin();
+
+	for (int n = 0; n < 10000; n++) {
+		VN210_APIMessage msg;
+		msg.STX = API_STX;
+		msg.header = 0x18;
+		msg.messageType = rand() % 4 == 0 ? API_CHX : 0x01;
+		msg.messageID = rand() & 0xFF;
+		msg.dataSize = rand() % (VN210_BUFFER_SIZE / 2 - VN210_FRAME_SIZE_MINUS_DATA);
+		msg.data = data;
+
+		int density = rand() % 4;
+		for (int i = 0; i < msg.dataSize; i++) {
+			data[i] = rand() % 4 < density ? (rand() & 1 ? API_STX : API_CHX) : rand() & 0xFF;
+		}
+
+		if (!transport.sendMsg(&msg)) continue;
+
+		plain[0] = msg.header;
+		plain[1] = msg.messageType;
+		plain[2] = msg.messageID;
+		plain[3] = msg.dataSize;
+		memcpy(&plain[4], data, msg.dataSize);
+		plain[4 + msg.dataSize] = msg.crc.value >> 8;
+		plain[5 + msg.dataSize] = msg.crc.value & 0xFF;
+
+		size_t length = VN210BulkCodec::escape(plain, msg.dataSize + 6, escaped);
+
+		if (length != (size_t) transport.txBuff.byteCount - 1U) return false;
+		for (size_t i = 0; i < length; i++) {
+			if (escaped[i] != transport.txBuff.bytes[i + 1]) return false;
+		}
+	}
+
+	return true;
+}
+
+static double mbPerSecond(size_t bytes, double ns) {
+	return bytes / ns * 1e9 / (1024 * 1024);
+}
+
+int main(void) {
+	std::vector<uint8_t> stream;
+	buildStream(stream);
+
+	std::vector<uint8_t> refOut;
+	std::vector<VN210BulkFrame> refFrames;
+	double refNs = referenceDecode(stream, refOut, refFrames);
+
+	uint32_t valid = 0;
+	for (size_t i = 0; i < refFrames.size(); i++) valid += refFrames[i].crcValid;
+
+	printf("stream: %lu bytes, %lu frames (%u with a valid CRC)\n\n", (unsigned long) stream.size(), (unsigned long) refFrames.size(), valid);
+	printf("%-12s %14s %14s %8s\n", "scan", "decode MB/s", "escape MB/s", "match");
+	printf("%-12s %14.1f %14s %8s\n", "receiveByte", mbPerSecond(stream.size(), refNs), "-", "-");
+
+	//the unescaped frames make a realistic escape workload
+	std::vector<uint8_t> escaped(2 * refOut.size());
+	bool allMatch = true;
+
+	for (int level = VN210BulkCodec::SIMD_SCALAR; level <= VN210BulkCodec::SIMD_AVX2; level++) {
+		if (!VN210BulkCodec::setSimdLevel((VN210BulkCodec::SimdLevel) level)) continue;
+
+		bool match = checkDecode(stream, refOut, refFrames) && checkEscape();
+		allMatch = allMatch && match;
+
+		std::vector<uint8_t> out;
+		std::vector<VN210BulkFrame> frames;
+		out.reserve(refOut.size());
+		frames.reserve(refFrames.size());
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int r = 0; r < BENCH_ROUNDS; r++) {
+			VN210BulkCodec codec;
+			out.clear();
+			frames.clear();
+			codec.decode(&stream[0], stream.size(), out, frames);
+		}
+		std::chrono::duration<double, std::nano> decodeNs = std::chrono::steady_clock::now() - start;
+
+		start = std::chrono::steady_clock::now();
+		for (int r = 0; r < BENCH_ROUNDS; r++) {
+			VN210BulkCodec::escape(&refOut[0], refOut.size(), &escaped[0]);
+		}
+		std::chrono::duration<double, std::nano> escapeNs = std::chrono::steady_clock::now() - start;
+
+		printf("%-12s %14.1f %14.1f %8s\n", levelNames[level],
+				mbPerSecond(stream.size() * BENCH_ROUNDS, decodeNs.count()),
+				mbPerSecond(refOut.size() * BENCH_ROUNDS, escapeNs.count()),
+				match ? "yes" : "NO");
+	}
+
+	return allMatch ? 0 : 1;
+}
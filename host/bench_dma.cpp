@@ -0,0 +1,274 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * DMA transport benchmark and conformance check.
+ *
+ * Runs the same byte streams through the per-byte transport (one rxtx() per byte,
+ * as the Arduino SPI interrupt does) and through VN210RxTx_DMA on the simulated
+ * DMA HAL, and checks that both deliver exactly the same frames.  It then
+ * reports, for each transport:
+ *
+ *  - events/KB:   rxtx() calls per 1024 bytes clocked, i.e. the interrupt rate
+ *  - ns/byte:     host time per byte, including the simulated DMA copy
+ *  - intact / crc-fail: frames delivered with good and bad CRCs
+ *  - tx-delay:    bytes of the radio's next exchange clocked before a packed message starts
+ *
+ * A final row runs the DMA transport with its events handled late (more than half
+ * a ring after the DMA raised them), to show the failure mode described in
+ * VN210RxTx_DMA.h.  Exits non-zero if the transports disagree.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+#include "VN210RxTx_Host.h"
+#include "VN210RxTx_DMA.h"
+#include "VN210DMAHal_Sim.h"
+#include "VN210FrameBuilder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#define BENCH_FRAMES 2000				//frames in each stream
+#define BENCH_GAP (VN210_DMA_RING_SIZE + 8)	//STX characters between frames, so no half ring holds two frames
+#define BENCH_MIN_BYTES 20000000		//each stream is run repeatedly until at least this many bytes have been clocked
+
+/**
+ * Transport results for one stream.
+ */
+typedef struct {
+	double nsPerByte;
+	double eventsPerKB;
+	uint32_t valid;
+	uint32_t crcErrors;
+} BenchResult;
+
+/**
+ * Builds the named stream, returning the number of frames in it.
+ */
+static uint32_t buildStream(const char * name, std::vector<uint8_t> & out) {
+	uint8_t data[40];
+	srand(1);
+
+	for (int i = 0; i < BENCH_FRAMES; i++) {
+		uint8_t id = i & 0xFF;
+
+		if (!strcmp(name, "polls")) {
+			VN210FrameBuilder::appendPoll(out, id);
+		} else if (!strcmp(name, "writes")) {
+			for (int j = 0; j < 40; j++) data[j] = (j % 5) ? 0x40 + j : 1 + (j / 5);
+			VN210FrameBuilder::append(out, 0x10, 0x01, id, data, 40);
+		} else if (!strcmp(name, "escapes")) {
+			memset(data, (i & 1) ? API_STX : API_CHX, sizeof(data));
+			VN210FrameBuilder::append(out, 0x10, 0x01, id, data, 20);
+		} else if (!strcmp(name, "noise")) {
+			for (int j = rand() % 32; j > 0; j--) out.push_back(rand() & 0xFF);
+			for (int j = 0; j < 10; j++) data[j] = rand() & 0xFF;
+			VN210FrameBuilder::append(out, 0x10, 0x01, id, data, 10);
+		}
+
+		VN210FrameBuilder::appendStxFlood(out, BENCH_GAP);
+	}
+
+	return BENCH_FRAMES;
+}
+
+/**
+ * Parses and releases the transport's frame if one is waiting, counting it.
+ * Appends the frame bytes to 'log', if given.
+ */
+static void takeFrame(VN210RxTx & transport, bool & flag, VN210FrameView & view, BenchResult & result, std::vector<uint8_t> * log) {
+	if (!flag) return;
+
+	if (transport.parseMessage()) result.valid++; else result.crcErrors++;
+	if (log != NULL) log->insert(log->end(), view.bytes(), view.bytes() + view.size());
+	transport.releaseMessage();
+}
+
+/**
+ * Clocks the stream through the per-byte transport, taking frames every 'takeEvery'
+ * bytes: after every byte for timing, or every half ring to match the DMA transport
+ * when checking that both decode the same frames.
+ */
+static BenchResult runPerByte(const std::vector<uint8_t> & stream, size_t takeEvery, std::vector<uint8_t> * log) {
+	BenchResult result = { 0, 0, 0, 0 };
+	VN210FrameView view;
+	bool flag = false;
+	size_t processed = 0;
+
+	VN210RxTx_Host transport;
+	transport.registerNewMessageFlag(&flag);
+	transport.rxFrame = &view;
+	transport.begin();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	do {
+		result.valid = 0;
+		result.crcErrors = 0;
+
+		for (size_t i = 0; i < stream.size(); i++) {
+			transport.exchange(stream[i]);
+			if ((i + 1) % takeEvery == 0 || i + 1 == stream.size()) takeFrame(transport, flag, view, result, log);
+		}
+
+		processed += stream.size();
+	} while (log == NULL && processed < BENCH_MIN_BYTES);
+
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	result.nsPerByte = elapsed.count() / processed;
+	result.eventsPerKB = 1024.0;
+	return result;
+}
+
+/**
+ * Clocks the stream through the DMA transport half a ring at a time, taking
+ * frames after each block as a main loop would between interrupts.
+ */
+static BenchResult runDMA(const std::vector<uint8_t> & stream, uint16_t latency, std::vector<uint8_t> * log) {
+	BenchResult result = { 0, 0, 0, 0 };
+	VN210FrameView view;
+	bool flag = false;
+	size_t processed = 0;
+
+	VN210DMAHal_Sim hal;
+	VN210RxTx_DMA transport(&hal);
+	hal.attach(&transport);
+	hal.eventLatency = latency;
+	transport.registerNewMessageFlag(&flag);
+	transport.rxFrame = &view;
+	transport.begin();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	do {
+		result.valid = 0;
+		result.crcErrors = 0;
+
+		for (size_t i = 0; i < stream.size(); i += VN210_DMA_RING_SIZE / 2) {
+			size_t count = stream.size() - i < VN210_DMA_RING_SIZE / 2 ? stream.size() - i : VN210_DMA_RING_SIZE / 2;
+			hal.exchange(&stream[i], NULL, count);
+			takeFrame(transport, flag, view, result, log);
+		}
+
+		processed += stream.size();
+	} while (log == NULL && processed < BENCH_MIN_BYTES);
+
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	result.nsPerByte = elapsed.count() / processed;
+	result.eventsPerKB = 1024.0 * transport.events / processed;
+	return result;
+}
+
+/**
+ * Packs a message, then clocks a poll exchange from the radio through 'exchange'.
+ * Returns the number of bytes clocked before the message's STX came back, or -1
+ * if the message didn't come back intact.
+ */
+template <class Exchange>
+static int txDelay(VN210RxTx & transport, Exchange exchange) {
+	uint8_t data[20];
+	for (int i = 0; i < 20; i++) data[i] = i;
+
+	VN210_APIMessage msg = { API_STX, 0x18, 0x03, 0x21, 20, data, { 0 } };
+	transport.sendMsg(&msg);
+
+	std::vector<uint8_t> mosi;
+	VN210FrameBuilder::appendPoll(mosi, 0x21);
+	VN210FrameBuilder::appendStxFlood(mosi, 100);
+	std::vector<uint8_t> miso(mosi.size());
+	exchange(&mosi[0], &miso[0], mosi.size());
+
+	std::vector<uint8_t> expected;
+	VN210FrameBuilder::append(expected, 0x18, 0x03, 0x21, data, 20);
+
+	for (size_t i = 0; i + expected.size() <= miso.size(); i++) {
+		if (miso[i] == API_STX) {
+			return memcmp(&miso[i], &expected[0], expected.size()) ? -1 : (int) i;
+		}
+	}
+
+	return -1;
+}
+
+int main(void) {
+	const char * streams[] = { "polls", "writes", "escapes", "noise" };
+	int rc = 0;
+
+	printf("ring %d bytes\n", VN210_DMA_RING_SIZE);
+	printf("%-10s %-10s %10s %10s %10s %8s %10s\n", "stream", "transport", "events/KB", "ns/byte", "frames", "intact", "crc-fail");
+
+	for (size_t s = 0; s < sizeof(streams) / sizeof(streams[0]); s++) {
+		std::vector<uint8_t> stream;
+		uint32_t frames = buildStream(streams[s], stream);
+
+		//both transports must deliver the same frames
+		std::vector<uint8_t> perByteLog, dmaLog;
+		runPerByte(stream, VN210_DMA_RING_SIZE / 2, &perByteLog);
+		runDMA(stream, 0, &dmaLog);
+
+		if (perByteLog != dmaLog) {
+			printf("%-10s MISMATCH: per-byte and DMA transports delivered different frames\n", streams[s]);
+			rc = 1;
+		}
+
+		BenchResult perByte = runPerByte(stream, 1, NULL);
+		BenchResult dma = runDMA(stream, 0, NULL);
+
+		printf("%-10s %-10s %10.1f %10.2f %10u %8u %10u\n", streams[s], "per-byte", perByte.eventsPerKB, perByte.nsPerByte, frames, perByte.valid, perByte.crcErrors);
+		printf("%-10s %-10s %10.1f %10.2f %10u %8u %10u\n", streams[s], "dma", dma.eventsPerKB, dma.nsPerByte, frames, dma.valid, dma.crcErrors);
+	}
+
+	std::vector<uint8_t> stream;
+	uint32_t frames = buildStream("writes", stream);
+	BenchResult late = runDMA(stream, VN210_DMA_RING_SIZE / 2 + 4, NULL);
+	printf("%-10s %-10s %10.1f %10.2f %10u %8u %10u\n", "writes", "dma-late", late.eventsPerKB, late.nsPerByte, frames, late.valid, late.crcErrors);
+
+	//transmit path: how far into the radio's exchange a packed message starts
+	VN210FrameView view;
+	bool flag = false;
+
+	VN210RxTx_Host host;
+	host.registerNewMessageFlag(&flag);
+	host.rxFrame = &view;
+	host.begin();
+	int hostDelay = txDelay(host, [&](const uint8_t * mosi, uint8_t * miso, size_t n) { host.exchange(mosi, miso, n); });
+
+	VN210DMAHal_Sim hal;
+	VN210RxTx_DMA dma(&hal);
+	hal.attach(&dma);
+	dma.registerNewMessageFlag(&flag);
+	dma.rxFrame = &view;
+	dma.begin();
+	int dmaDelay = txDelay(dma, [&](const uint8_t * mosi, uint8_t * miso, size_t n) { hal.exchange(mosi, miso, n); });
+
+	printf("tx-delay   per-byte %d bytes, dma %d bytes\n", hostDelay, dmaDelay);
+
+	if (hostDelay < 0 || dmaDelay < 0 || dmaDelay > VN210_DMA_RING_SIZE / 2) {
+		printf("transmit path FAILED\n");
+		rc = 1;
+	}
+
+	return rc;
+}
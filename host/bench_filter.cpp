@@ -0,0 +1,148 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * SCADA filter stage check and benchmark.
+ *
+ * Feeds a constant input to each filter stage in SCADAFilter.h, and checks that
+ * every value it produces, from the first one after reset() on, equals the input.
+ * A start-up transient would otherwise reach the register's minimum and maximum.
+ * It then prints the time per input sample of each stage with random int16_t
+ * samples.  It exits non-zero if a check fails.
+ *
+ * Usage: bench_filter [samples]
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+#include "SCADAFilter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#define BENCH_CONSTANT 1000				//input for the constant input checks
+#define BENCH_CHECK_SAMPLES 256			//samples in each constant input check
+
+/**
+ * Feeds BENCH_CHECK_SAMPLES of BENCH_CONSTANT to 'filter', twice with a reset()
+ * in between.  Returns false, and prints the first wrong output, unless every
+ * output equals the input.
+ */
+template <class Filter>
+static bool checkConstant(const char * name, Filter & filter) {
+	typedef typename Filter::SampleType T;
+	bool ok = true;
+	uint32_t outputs = 0;
+
+	for (int pass = 0; pass < 2 && ok; pass++) {
+		filter.reset();
+
+		for (int i = 0; i < BENCH_CHECK_SAMPLES; i++) {
+			T output;
+
+			if (!filter.push((T) BENCH_CONSTANT, output)) continue;
+			outputs++;
+
+			if (output != (T) BENCH_CONSTANT) {
+				printf("%-26s output %u after reset is %.2f\n", name, outputs, (double) output);
+				ok = false;
+				break;
+			}
+		}
+	}
+
+	if (ok && outputs == 0) {
+		printf("%-26s no output\n", name);
+		ok = false;
+	}
+
+	return ok;
+}
+
+/**
+ * Times 'filter' over 'samples', printing the time per input sample.
+ */
+template <class Filter>
+static void timeFilter(const char * name, Filter & filter, const std::vector<int16_t> & samples) {
+	volatile int32_t sink = 0;
+	uint32_t outputs = 0;
+
+	filter.reset();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < samples.size(); i++) {
+		int16_t output;
+
+		if (filter.push(samples[i], output)) {
+			sink += output;
+			outputs++;
+		}
+	}
+	double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+	printf("%-26s %12.2f %10u\n", name, ns / samples.size(), outputs);
+}
+
+int main(int argc, char ** argv) {
+	size_t count = argc > 1 ? atol(argv[1]) : 4000000;
+	bool ok = true;
+
+	CICDecimator<int16_t, 4, 1> cic4x1;
+	CICDecimator<int16_t, 4, 2> cic4x2;
+	CICDecimator<int16_t, 4, 3> cic4x3;
+	CICDecimator<int16_t, 8, 3> cic8x3;
+	CICDecimator<int32_t, 8, 4> cic8x4;
+	MovingAverageFilter<int16_t, 8> average8;
+	EMAFilter<int16_t, 3> ema3;
+	MedianFilter<int16_t, 5> median5;
+	SCADAFilterChain<MedianFilter<int16_t, 4>, MovingAverageFilter<int16_t, 8> > chain;
+	SCADAFilterChain<CICDecimator<int16_t, 4, 3>, MedianFilter<int16_t, 3> > cicChain;
+
+	ok &= checkConstant("cic r4 order 1", cic4x1);
+	ok &= checkConstant("cic r4 order 2", cic4x2);
+	ok &= checkConstant("cic r4 order 3", cic4x3);
+	ok &= checkConstant("cic r8 order 3", cic8x3);
+	ok &= checkConstant("cic r8 order 4 int32", cic8x4);
+	ok &= checkConstant("moving average 8", average8);
+	ok &= checkConstant("ema 1/8", ema3);
+	ok &= checkConstant("median 5", median5);
+	ok &= checkConstant("median 4 > average 8", chain);
+	ok &= checkConstant("cic r4 order 3 > median 3", cicChain);
+
+	printf("constant input checks: %s\n\n", ok ? "pass" : "FAIL");
+
+	std::vector<int16_t> samples(count);
+	srand(1);
+	for (size_t i = 0; i < count; i++) samples[i] = (rand() % 2001) - 1000;
+
+	printf("%-26s %12s %10s\n", "stage", "ns/sample", "outputs");
+	timeFilter("cic r4 order 3", cic4x3, samples);
+	timeFilter("cic r8 order 3", cic8x3, samples);
+	timeFilter("moving average 8", average8, samples);
+	timeFilter("ema 1/8", ema3, samples);
+	timeFilter("median 5", median5, samples);
+	timeFilter("median 4 > average 8", chain, samples);
+
+	return ok ? 0 : 1;
+}
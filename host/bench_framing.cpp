@@ -0,0 +1,335 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Receive framing benchmark.
+ *
+ * Runs the transport's receive decoder over adversarial byte streams and reports
+ * the decode cost per byte and how many frames were recovered intact.  The
+ * decoder used before the framing state machine is included for comparison,
+ * built the same way as the transport's, so the costs can be compared directly.
+ *
+ * Streams:
+ *  - clean:      polls and writes separated by short STX runs
+ *  - stx-flood:  every frame followed by a long STX run, as sent while the radio waits
+ *  - escapes:    writes whose payloads are all STX / CHX, so every byte is escaped
+ *  - bad-length: every other frame has its size byte corrupted
+ *  - noise:      frames separated by random bytes
+ *
+ * Before the benchmark, checks that noise arriving while a frame is held for the
+ * API can't change the frame, and that stray escapes between frames aren't
+ * counted as framing errors.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+#include "VN210RxTx_Host.h"
+#include "VN210FrameBuilder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#define BENCH_FRAMES 2000				//frames in each stream
+#define BENCH_MIN_BYTES 20000000		//each stream is decoded repeatedly until at least this many bytes have been processed
+
+/**
+ * Copy of the receive decoder as it was before the framing state machine:
+ * resets on every STX and detects the end of a frame by comparing the byte count
+ * with the size byte after every byte.
+ *
+ * Built the same way as the transport's decoder, so only the decoding differs:
+ * the buffer and flags are volatile, as they are shared with the SPI interrupt,
+ * and each byte goes through two calls that aren't inlined, as feed() and
+ * receiveByte() do.
+ */
+class LegacyDecoder {
+public:
+	volatile uint8_t bytes[VN210_BUFFER_SIZE];
+	volatile uint8_t byteCount;
+	volatile bool escape;
+	volatile bool hasNewMessage;
+
+	LegacyDecoder() { this->reset(); }
+
+	void __attribute__((noinline)) feed(uint8_t rxb) {
+		this->receiveByte(rxb);
+	}
+
+	void reset() {
+		this->byteCount = 0;
+		this->escape = false;
+		this->hasNewMessage = false;
+	}
+
+	void __attribute__((noinline)) receiveByte(uint8_t rxb) {
+		if (rxb == API_CHX) {
+			this->escape = true;
+		} else {
+			if (rxb == API_STX || this->byteCount == VN210_BUFFER_SIZE) {
+				this->reset();
+			}
+
+			if (this->escape) {
+				this->escape = false;
+				if (rxb == 0x0E) rxb = API_STX;
+				else if (rxb == 0x0D) rxb = API_CHX;
+			}
+
+			this->bytes[this->byteCount++] = rxb;
+		}
+
+		if (this->byteCount >= VN210_FRAME_SIZE_MINUS_DATA) {
+			if (this->byteCount == (this->bytes[VN210_DATASIZE_FRAME_FIELD_INDEX] + VN210_FRAME_SIZE_MINUS_DATA)) {
+				this->hasNewMessage = true;
+			}
+		}
+	}
+
+	bool parse() {
+		uint16_t crc = VN210_CRC_INITIAL_VALUE;
+		for (int i = 1; i < this->byteCount - 2; i++) crc = _crc_xmodem_update(crc, this->bytes[i]);
+		bool valid = crc == (((uint16_t) this->bytes[this->byteCount - 2] << 8) | this->bytes[this->byteCount - 1]);
+		this->reset();
+		return valid;
+	}
+};
+
+/**
+ * Decoder results for one stream.
+ */
+typedef struct {
+	double nsPerByte;
+	uint32_t valid;
+	uint32_t crcErrors;
+	uint32_t framingErrors;
+} BenchResult;
+
+/**
+ * Builds a write request with 'attributes' analog attributes, each set to 'fill'.
+ */
+static void appendWrite(std::vector<uint8_t> & out, uint8_t id, uint8_t attributes, uint8_t fill) {
+	uint8_t data[100];
+	for (int i = 0; i < attributes; i++) {
+		data[i * 5] = 1 + (i % 4);
+		memset(&data[i * 5 + 1], fill, 4);
+	}
+	VN210FrameBuilder::append(out, 0x10, 0x01, id, data, attributes * 5);
+}
+
+/**
+ * Builds the named stream, returning the number of intact frames in it.
+ */
+static uint32_t buildStream(const char * name, std::vector<uint8_t> & out) {
+	uint32_t frames = 0;
+	srand(1);
+
+	for (int i = 0; i < BENCH_FRAMES; i++) {
+		uint8_t id = i & 0xFF;
+
+		if (!strcmp(name, "clean")) {
+			if (i & 1) VN210FrameBuilder::appendPoll(out, id); else appendWrite(out, id, 4, 0x40);
+			VN210FrameBuilder::appendStxFlood(out, 4);
+			frames++;
+		} else if (!strcmp(name, "stx-flood")) {
+			VN210FrameBuilder::appendPoll(out, id);
+			VN210FrameBuilder::appendStxFlood(out, 120);
+			frames++;
+		} else if (!strcmp(name, "escapes")) {
+			appendWrite(out, id, 4, (i & 1) ? API_STX : API_CHX);
+			VN210FrameBuilder::appendStxFlood(out, 4);
+			frames++;
+		} else if (!strcmp(name, "bad-length")) {
+			size_t start = out.size();
+			appendWrite(out, id, 4, 0x40);
+			if (i & 1) {
+				out[start + 4] = (i & 2) ? 0x70 : 0x03;		//too long, or too short
+			} else {
+				frames++;
+			}
+			//no STX gap: a corrupted frame runs straight into the next one
+		} else if (!strcmp(name, "noise")) {
+			for (int j = rand() % 32; j > 0; j--) out.push_back(rand() & 0xFF);
+			appendWrite(out, id, 2, 0x40);
+			frames++;
+		}
+	}
+
+	return frames;
+}
+
+/**
+ * Runs a decoder over the stream, parsing each frame as soon as it is flagged,
+ * as a main loop polling hasNewMessage() would.
+ */
+static BenchResult runFSM(const std::vector<uint8_t> & stream) {
+	BenchResult result = { 0, 0, 0, 0 };
+	VN210FrameView view;
+	bool flag = false;
+	size_t processed = 0;
+
+	VN210RxTx_Host transport;
+	transport.registerNewMessageFlag(&flag);
+	transport.rxFrame = &view;
+	transport.begin();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	while (processed < BENCH_MIN_BYTES) {
+		result.valid = 0;
+		result.crcErrors = 0;
+		transport.framingErrors = 0;
+
+		for (size_t i = 0; i < stream.size(); i++) {
+			transport.feed(stream[i]);
+
+			if (flag) {
+				if (transport.parseMessage()) result.valid++; else result.crcErrors++;
+				transport.releaseMessage();
+			}
+		}
+
+		processed += stream.size();
+	}
+
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	result.nsPerByte = elapsed.count() / processed;
+	result.framingErrors = transport.framingErrors;
+	return result;
+}
+
+/**
+ * As runFSM(), for the legacy decoder.
+ */
+static BenchResult runLegacy(const std::vector<uint8_t> & stream) {
+	BenchResult result = { 0, 0, 0, 0 };
+	LegacyDecoder decoder;
+	size_t processed = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	while (processed < BENCH_MIN_BYTES) {
+		result.valid = 0;
+		result.crcErrors = 0;
+
+		for (size_t i = 0; i < stream.size(); i++) {
+			decoder.feed(stream[i]);
+
+			if (decoder.hasNewMessage) {
+				if (decoder.parse()) result.valid++; else result.crcErrors++;
+			}
+		}
+
+		processed += stream.size();
+	}
+
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	result.nsPerByte = elapsed.count() / processed;
+	return result;
+}
+
+/**
+ * Feeds a write request, parses it, then feeds escapes, bad escape sequences and
+ * the start of another frame before the API releases it.  Returns true if the
+ * view still shows the write request.
+ */
+static bool checkHeldFrame(void) {
+	static const uint8_t noise[] = { API_CHX, API_CHX, API_STX, 0x99, 0x77, 0x66, 0x55, API_CHX, 0x33, API_STX, 0x10, 0x01 };
+	std::vector<uint8_t> stream;
+	VN210FrameView view;
+	bool flag = false;
+
+	VN210RxTx_Host transport;
+	transport.registerNewMessageFlag(&flag);
+	transport.rxFrame = &view;
+	transport.begin();
+
+	appendWrite(stream, 7, 2, 0x40);
+	for (size_t i = 0; i < stream.size(); i++) transport.feed(stream[i]);
+	if (!flag || !transport.parseMessage()) return false;
+
+	for (size_t i = 0; i < sizeof(noise); i++) transport.feed(noise[i]);
+
+	return view.messageType() == 0x01 && view.messageID() == 7 && view.dataSize() == 10
+		&& view.data(1) == 0x40 && VN210RxTx::isCrcValid(view);
+}
+
+/**
+ * Feeds two polls with doubled and bad escape sequences between them.  Returns
+ * true if both are received and no framing error is counted.
+ */
+static bool checkEscapesBetweenFrames(void) {
+	static const uint8_t stray[] = { API_CHX, API_CHX, API_CHX, 0x33, 0x00, API_CHX };
+	std::vector<uint8_t> stream;
+	VN210FrameView view;
+	bool flag = false;
+	uint32_t valid = 0;
+
+	VN210RxTx_Host transport;
+	transport.registerNewMessageFlag(&flag);
+	transport.rxFrame = &view;
+	transport.begin();
+
+	VN210FrameBuilder::appendPoll(stream, 1);
+	stream.insert(stream.end(), stray, stray + sizeof(stray));
+	VN210FrameBuilder::appendPoll(stream, 2);
+
+	for (size_t i = 0; i < stream.size(); i++) {
+		transport.feed(stream[i]);
+
+		if (flag) {
+			if (transport.parseMessage()) valid++;
+			transport.releaseMessage();
+		}
+	}
+
+	return valid == 2 && transport.framingErrors == 0;
+}
+
+int main(void) {
+	const char * streams[] = { "clean", "stx-flood", "escapes", "bad-length", "noise" };
+
+	if (!checkHeldFrame()) {
+		printf("HELD FRAME OVERWRITTEN\n");
+		return 1;
+	}
+
+	if (!checkEscapesBetweenFrames()) {
+		printf("ESCAPES BETWEEN FRAMES COUNTED AS ERRORS\n");
+		return 1;
+	}
+
+	printf("%-12s %-8s %10s %10s %8s %10s %10s\n", "stream", "decoder", "ns/byte", "frames", "intact", "crc-fail", "resyncs");
+
+	for (size_t s = 0; s < sizeof(streams) / sizeof(streams[0]); s++) {
+		std::vector<uint8_t> stream;
+		uint32_t frames = buildStream(streams[s], stream);
+
+		BenchResult fsm = runFSM(stream);
+		BenchResult legacy = runLegacy(stream);
+
+		printf("%-12s %-8s %10.2f %10u %8u %10u %10u\n", streams[s], "fsm", fsm.nsPerByte, frames, fsm.valid, fsm.crcErrors, fsm.framingErrors);
+		printf("%-12s %-8s %10.2f %10u %8u %10u %10s\n", streams[s], "legacy", legacy.nsPerByte, frames, legacy.valid, legacy.crcErrors, "-");
+	}
+
+	return 0;
+}
@@ -0,0 +1,291 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Receive pipeline benchmark.
+ *
+ * Feeds every link of a VN210Pipeline with a recorded stream of write requests
+ * (two attributes each) and polls, from I/O threads, and drains the sinks from
+ * consumer threads, for a range of worker counts.  One link in 8 carries 8 times
+ * the traffic of the others, and they all share a home worker when the worker
+ * count divides 8, so the other workers have to steal to keep busy.
+ *
+ * The sinks check each link's records arrive in stream order and none are
+ * missing.  For each worker count it prints link bytes decoded per second,
+ * frames per ms, the speedup over one worker and per-worker efficiency, and the
+ * number of steals.  The first row is a single thread decoding every link
+ * in turn without the pipeline, for comparison.  Scaling is limited by the
+ * cores available: run with no more workers than there are cores left over
+ * after the I/O and sink threads.
+ *
+ * Usage: bench_pipeline [links] [max workers]
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+#include "VN210Pipeline.h"
+#include "VN210FrameBuilder.h"
+#include "VN210Schema.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#define BENCH_UNIT_FRAMES 4000			//frames in a normal link's stream. busy links have 8 times as many
+#define BENCH_BUSY_FACTOR 8				//busy link traffic multiple, and one link in this many is busy
+#define BENCH_IO_BYTES 140				//bytes handed to ingest() at once, about one radio exchange
+
+/**
+ * A link's stream and how many of each kind of frame it holds.
+ */
+typedef struct {
+	std::vector<uint8_t> bytes;
+	uint32_t writes;
+	uint32_t polls;
+} BenchStream;
+
+/**
+ * What a sink has seen of one link.
+ */
+typedef struct {
+	uint32_t nextFrame;					//frame number the next record should have
+	uint32_t writes;					//writes seen
+	uint32_t polls;						//polls seen
+	uint8_t values;						//values seen from the current write
+	bool ordered;						//false once a record arrived out of order
+} LinkCheck;
+
+/**
+ * Builds a stream of 'frames' frames: every 4th a poll, the rest writes whose two
+ * attributes both hold the write's number, with short STX runs in between.
+ */
+static void buildStream(BenchStream & stream, uint32_t frames) {
+	stream.writes = 0;
+	stream.polls = 0;
+
+	for (uint32_t i = 0; i < frames; i++) {
+		if (i % 4 == 3) {
+			VN210FrameBuilder::appendPoll(stream.bytes, i & 0xFF);
+			stream.polls++;
+		} else {
+			uint8_t data[2 * VN210_ATTRIBUTE_SIZE];
+			for (int a = 0; a < 2; a++) {
+				data[a * VN210_ATTRIBUTE_SIZE] = 1 + a;
+				VN210FloatCodec::encode((float) stream.writes, &data[a * VN210_ATTRIBUTE_SIZE + 1]);
+			}
+			VN210FrameBuilder::append(stream.bytes, 0x10, 0x01, i & 0xFF, data, sizeof(data));
+			stream.writes++;
+		}
+		VN210FrameBuilder::appendStxFlood(stream.bytes, 4);
+	}
+}
+
+static const BenchStream & streamFor(uint32_t link, const BenchStream & normal, const BenchStream & busy) {
+	return link % BENCH_BUSY_FACTOR == 0 ? busy : normal;
+}
+
+/**
+ * I/O thread: hands out the streams of links io, io + ioThreads, ... a piece at a
+ * time, round robin, until all have been queued.
+ */
+static void feeder(VN210Pipeline * pipeline, uint32_t io, uint32_t ioThreads, const BenchStream * normal, const BenchStream * busy) {
+	std::vector<size_t> offsets(pipeline->getLinkCount(), 0);
+	bool more = true;
+
+	while (more) {
+		more = false;
+		bool progress = false;
+
+		for (uint32_t link = io; link < pipeline->getLinkCount(); link += ioThreads) {
+			const std::vector<uint8_t> & bytes = streamFor(link, *normal, *busy).bytes;
+			size_t offset = offsets[link];
+			if (offset == bytes.size()) continue;
+
+			size_t length = bytes.size() - offset < BENCH_IO_BYTES ? bytes.size() - offset : BENCH_IO_BYTES;
+			size_t queued = pipeline->ingest(link, &bytes[offset], length);
+
+			offsets[link] += queued;
+			progress |= queued > 0;
+			more |= offsets[link] < bytes.size();
+		}
+
+		if (more && !progress) std::this_thread::yield();		//every link's queue is full
+	}
+}
+
+/**
+ * Sink consumer: checks records until 'done' is set and the sink is empty.
+ */
+static void consumer(VN210Pipeline * pipeline, uint16_t sink, std::atomic<bool> * done, std::vector<LinkCheck> * checks) {
+	VN210PipelineRecord record;
+
+	for (;;) {
+		if (!pipeline->pop(sink, record)) {
+			if (done->load(std::memory_order_acquire) && !pipeline->pop(sink, record)) return;
+			std::this_thread::yield();
+			continue;
+		}
+
+		LinkCheck & check = (*checks)[record.link];
+
+		if (record.frame != check.nextFrame) check.ordered = false;
+
+		if (record.attribute == 0) {
+			check.polls++;
+			check.nextFrame++;
+		} else {
+			//both attributes of a write hold its number
+			if (record.value != (float) check.writes) check.ordered = false;
+			if (++check.values == 2) {
+				check.values = 0;
+				check.writes++;
+				check.nextFrame++;
+			}
+		}
+	}
+}
+
+/**
+ * Decodes every link's stream in turn on this thread, without the pipeline.
+ * Returns the elapsed ms.
+ */
+static double runInline(uint32_t links, const BenchStream & normal, const BenchStream & busy, uint64_t & frames) {
+	VN210RxTx_Host decoder;
+	VN210FrameView view;
+	bool flag = false;
+
+	decoder.registerNewMessageFlag(&flag);
+	decoder.rxFrame = &view;
+	decoder.begin();
+	frames = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (uint32_t link = 0; link < links; link++) {
+		const std::vector<uint8_t> & bytes = streamFor(link, normal, busy).bytes;
+
+		for (size_t i = 0; i < bytes.size(); i++) {
+			decoder.feed(bytes[i]);
+			if (flag) {
+				if (decoder.parseMessage()) frames++;
+				decoder.releaseMessage();
+			}
+		}
+	}
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Runs the pipeline with 'workers' workers until every link's stream has been
+ * decoded and checked.  Returns the elapsed ms, or a negative value if a check failed.
+ */
+static double runPipeline(uint32_t links, uint16_t workers, const BenchStream & normal, const BenchStream & busy,
+		VN210PipelineStats & stats) {
+	uint32_t ioThreads = 1 + workers / 4;
+	uint16_t sinks = 1 + workers / 4;
+
+	VN210Pipeline pipeline(links, workers, sinks);
+	std::vector<LinkCheck> checks(links);
+	std::atomic<bool> done(false);
+	std::vector<std::thread> threads;
+
+	for (uint32_t link = 0; link < links; link++) {
+		checks[link].nextFrame = 0;
+		checks[link].writes = 0;
+		checks[link].polls = 0;
+		checks[link].values = 0;
+		checks[link].ordered = true;
+	}
+
+	pipeline.start();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (uint16_t s = 0; s < sinks; s++) threads.push_back(std::thread(consumer, &pipeline, s, &done, &checks));
+	for (uint32_t io = 0; io < ioThreads; io++) threads.push_back(std::thread(feeder, &pipeline, io, ioThreads, &normal, &busy));
+
+	for (uint32_t io = 0; io < ioThreads; io++) threads[sinks + io].join();
+	while (!pipeline.isIdle()) std::this_thread::yield();
+
+	done.store(true, std::memory_order_release);
+	for (uint16_t s = 0; s < sinks; s++) threads[s].join();
+
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	pipeline.stop();
+	stats = pipeline.getStats();
+
+	bool ok = stats.crcErrors == 0;
+	for (uint32_t link = 0; link < links; link++) {
+		const BenchStream & stream = streamFor(link, normal, busy);
+		const LinkCheck & check = checks[link];
+		ok &= check.ordered && check.writes == stream.writes && check.polls == stream.polls && check.values == 0;
+	}
+
+	return ok ? ms : -ms;
+}
+
+int main(int argc, char ** argv) {
+	uint32_t links = argc > 1 ? atoi(argv[1]) : 256;
+	uint16_t maxWorkers = argc > 2 ? atoi(argv[2]) : std::thread::hardware_concurrency();
+	bool ok = true;
+
+	if (links == 0) links = 1;
+	if (maxWorkers == 0) maxWorkers = 1;
+
+	BenchStream normal, busy;
+	buildStream(normal, BENCH_UNIT_FRAMES);
+	buildStream(busy, BENCH_UNIT_FRAMES * BENCH_BUSY_FACTOR);
+
+	double totalBytes = 0;
+	for (uint32_t link = 0; link < links; link++) totalBytes += streamFor(link, normal, busy).bytes.size();
+
+	printf("%u links, %.1f MB, %u cores\n\n", links, totalBytes / 1e6, std::thread::hardware_concurrency());
+	printf("%-10s %10s %10s %10s %10s %10s %8s\n", "workers", "MB/s", "frames/ms", "speedup", "per-core", "steals", "ordered");
+
+	uint64_t frames;
+	double ms = runInline(links, normal, busy, frames);
+	printf("%-10s %10.1f %10.0f %10s %10s %10s %8s\n", "inline", totalBytes / 1e3 / ms, frames / ms, "-", "-", "-", "-");
+
+	double oneWorker = 0;
+
+	for (uint16_t workers = 1; workers <= maxWorkers; workers = workers < maxWorkers && workers * 2 > maxWorkers ? maxWorkers : workers * 2) {
+		VN210PipelineStats stats;
+		ms = runPipeline(links, workers, normal, busy, stats);
+
+		bool passed = ms > 0;
+		if (!passed) ms = -ms;
+		if (workers == 1) oneWorker = ms;
+
+		printf("%-10u %10.1f %10.0f %9.2fx %9.0f%% %10lu %8s\n", workers, totalBytes / 1e3 / ms, stats.frames / ms,
+				oneWorker / ms, 100 * oneWorker / ms / workers, (unsigned long) stats.steals, passed ? "yes" : "NO");
+
+		ok &= passed;
+		if (workers == maxWorkers) break;
+	}
+
+	printf("\nchecks: %s\n", ok ? "pass" : "FAIL");
+	return ok ? 0 : 1;
+}
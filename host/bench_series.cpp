@@ -0,0 +1,198 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Time-series store benchmark.
+ *
+ * Appends a day of per-second values for every attribute of a set of simulated
+ * nodes to a VN210SeriesStore in a temporary directory, checks that the store
+ * reopens with every record in place, and that range scans return exactly the
+ * records in the range.  It then reports the append rate and the scan rate for
+ * whole series and one hour windows.
+ *
+ * Usage: bench_series [days] [nodes]
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+#include "VN210SeriesStore.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+
+#define BENCH_ATTRIBUTES 8				//attributes per node, as in uapData
+#define BENCH_SECONDS_PER_DAY 86400
+#define BENCH_WINDOWS 10000				//one hour windows scanned
+#define BENCH_START_MS 1790000000000ULL	//timestamp of the first record
+
+static const uint8_t attributeIDs[BENCH_ATTRIBUTES] = { 1, 2, 3, 4, 16, 17, 18, 19 };
+
+/**
+ * Totals the records passed to the scan callback, decoding each value so the
+ * records are actually read.
+ */
+typedef struct {
+	size_t records;
+	uint64_t lastTime;
+	bool ordered;
+	float sum;
+} ScanTotals;
+
+static void addRecords(const VN210SeriesRecord * records, size_t count, void * context) {
+	ScanTotals * totals = (ScanTotals *) context;
+
+	for (size_t i = 0; i < count; i++) {
+		float value;
+		VN210FloatCodec::decode(records[i].value, value);
+		totals->sum += value;
+
+		if (records[i].time < totals->lastTime) totals->ordered = false;
+		totals->lastTime = records[i].time;
+	}
+
+	totals->records += count;
+}
+
+/**
+ * Scans one series, returning true if exactly 'expected' records came back in time order.
+ */
+static bool checkScan(const VN210SeriesStore & store, uint16_t node, uint8_t attribute, uint64_t from, uint64_t to, size_t expected) {
+	ScanTotals totals = { 0, 0, true, 0 };
+
+	size_t count = store.scan(node, attribute, from, to, addRecords, &totals);
+
+	return count == expected && totals.records == expected && totals.ordered;
+}
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char ** argv) {
+	int days = argc > 1 ? atoi(argv[1]) : 1;
+	int nodes = argc > 2 ? atoi(argv[2]) : 8;
+	uint32_t duration = days * BENCH_SECONDS_PER_DAY;
+	size_t total = (size_t) duration * nodes * BENCH_ATTRIBUTES;
+	bool ok = true;
+
+	char directory[] = "/tmp/bench_series.XXXXXX";
+	if (mkdtemp(directory) == NULL) {
+		perror("mkdtemp");
+		return 1;
+	}
+
+	VN210SeriesStore store;
+	if (!store.open(directory)) {
+		printf("can't open store in %s\n", directory);
+		return 1;
+	}
+
+	//each second, every node sends a read response with all its attributes
+	uint8_t payload[BENCH_ATTRIBUTES * VN210_ATTRIBUTE_SIZE];
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (uint32_t t = 0; t < duration && ok; t++) {
+		for (int n = 0; n < nodes; n++) {
+			for (int a = 0; a < BENCH_ATTRIBUTES; a++) {
+				payload[a * VN210_ATTRIBUTE_SIZE] = attributeIDs[a];
+				VN210FloatCodec::encode((float) (t % 3600) + n + a * 0.5f, &payload[a * VN210_ATTRIBUTE_SIZE + 1]);
+			}
+
+			ok = store.appendAttributes(n, BENCH_START_MS + t * 1000ULL, payload, sizeof(payload)) == BENCH_ATTRIBUTES;
+		}
+	}
+
+	double appendSeconds = elapsedSeconds(start);
+
+	if (!ok) printf("append failed\n");
+
+	//everything should still be there after reopening
+	store.close();
+	ok = ok && store.open(directory);
+
+	for (int n = 0; n < nodes && ok; n++) {
+		for (int a = 0; a < BENCH_ATTRIBUTES && ok; a++) {
+			ok = checkScan(store, n, attributeIDs[a], 0, UINT64_MAX, duration);
+		}
+	}
+
+	//windows with both ends inside the data, and one past each end
+	srand(1);
+	for (int i = 0; i < 100 && ok; i++) {
+		uint32_t first = rand() % (duration - 3600);
+		uint64_t from = BENCH_START_MS + first * 1000ULL;
+		ok = checkScan(store, rand() % nodes, attributeIDs[rand() % BENCH_ATTRIBUTES], from, from + 3600 * 1000ULL, 3601);
+	}
+
+	ok = ok && checkScan(store, 0, 1, 0, BENCH_START_MS - 1, 0);
+	ok = ok && checkScan(store, 0, 1, BENCH_START_MS + duration * 1000ULL, UINT64_MAX, 0);
+	ok = ok && checkScan(store, nodes, 1, 0, UINT64_MAX, 0);
+
+	//every series, start to end
+	ScanTotals totals = { 0, 0, true, 0 };
+	start = std::chrono::steady_clock::now();
+
+	for (int n = 0; n < nodes; n++) {
+		for (int a = 0; a < BENCH_ATTRIBUTES; a++) {
+			totals.lastTime = 0;
+			store.scan(n, attributeIDs[a], 0, UINT64_MAX, addRecords, &totals);
+		}
+	}
+
+	double fullSeconds = elapsedSeconds(start);
+
+	//random one hour windows
+	size_t windowRecords = 0;
+	start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < BENCH_WINDOWS; i++) {
+		ScanTotals window = { 0, 0, true, 0 };
+		uint64_t from = BENCH_START_MS + (rand() % (duration - 3600)) * 1000ULL;
+		store.scan(rand() % nodes, attributeIDs[rand() % BENCH_ATTRIBUTES], from, from + 3600 * 1000ULL, addRecords, &window);
+		windowRecords += window.records;
+	}
+
+	double windowSeconds = elapsedSeconds(start);
+
+	printf("%d nodes x %d attributes x %u s: %lu records, %lu segments of %lu MB\n\n", nodes, BENCH_ATTRIBUTES, duration,
+			(unsigned long) total, (unsigned long) store.getSegmentCount(), VN210_SERIES_SEGMENT_BYTES / (1024 * 1024));
+	printf("%-16s %14s %12s\n", "operation", "records/s", "MB/s");
+	printf("%-16s %14.0f %12.1f\n", "append", total / appendSeconds, total * sizeof(VN210SeriesRecord) / appendSeconds / (1024 * 1024));
+	printf("%-16s %14.0f %12.1f\n", "scan series", totals.records / fullSeconds, totals.records * sizeof(VN210SeriesRecord) / fullSeconds / (1024 * 1024));
+	printf("%-16s %14.0f %12.1f   (%.1f us per window)\n", "scan 1h window", windowRecords / windowSeconds,
+			windowRecords * sizeof(VN210SeriesRecord) / windowSeconds / (1024 * 1024), windowSeconds * 1e6 / BENCH_WINDOWS);
+	printf("\nchecks: %s\n", ok ? "pass" : "FAIL");
+
+	//clean up the temporary store
+	for (size_t i = 0; i < store.getSegmentCount(); i++) {
+		char path[64];
+		snprintf(path, sizeof(path), "%s/segment-%06lu.vts", directory, (unsigned long) i);
+		unlink(path);
+	}
+	store.close();
+	rmdir(directory);
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Shared register file benchmark.
+ *
+ * A writer thread publishes every node of a VN210SharedRegisters segment over
+ * and over, while reader threads, each with their own read-only mapping of the
+ * segment as a separate process would have, read every node and check that
+ * each copy comes from a single publish.  Prints node reads per millisecond
+ * with the writer idle and while it publishes, and the writer's publish rate.
+ *
+ * Usage: bench_shared [nodes] [readers]
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+#include "VN210SharedRegisters.h"
+#include "VN210RxTx_Host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#define BENCH_RUN_MS 1000				//length of each timed run
+
+typedef struct {
+	uint64_t reads;
+	uint64_t torn;
+	uint64_t failed;
+} ReaderResult;
+
+/**
+ * Returns true if every field of the node came from the same publish.  The
+ * writer derives them all from the publish number.
+ */
+static bool consistent(const VN210SharedNode & node) {
+	uint64_t k = node.time;
+
+	for (int i = 0; i < UAP_ANALOGS_COUNT; i++) {
+		if (node.uapData.analogs[i].value != (float) (k % 100000) + i) return false;
+	}
+	for (int i = 0; i < UAP_DIGITALS_COUNT; i++) {
+		if (node.uapData.digitals[i] != (bool) ((k >> i) & 1)) return false;
+	}
+
+	return node.info.firmwareVersion == (uint16_t) k;
+}
+
+/**
+ * Sets every field the writer publishes from the publish number.
+ */
+static void fill(VN210SimpleAPI & api, uint64_t k) {
+	for (int i = 0; i < UAP_ANALOGS_COUNT; i++) api.uapData.analogs[i].value = (float) (k % 100000) + i;
+	for (int i = 0; i < UAP_DIGITALS_COUNT; i++) api.uapData.digitals[i] = (k >> i) & 1;
+	api.info.firmwareVersion = (uint16_t) k;
+}
+
+/**
+ * Reads every node until 'stop' is set.
+ */
+static void reader(const char * name, std::atomic<bool> * stop, ReaderResult * result) {
+	VN210SharedRegisters registers;
+	result->reads = 0;
+	result->torn = 0;
+	result->failed = 0;
+
+	if (!registers.open(name)) {
+		result->failed++;
+		return;
+	}
+
+	uint32_t nodes = registers.getNodeCount();
+	VN210SharedNode node;
+
+	while (!stop->load(std::memory_order_relaxed)) {
+		for (uint32_t n = 0; n < nodes; n++) {
+			if (!registers.read(n, node)) result->failed++;
+			else if (!consistent(node)) result->torn++;
+		}
+		result->reads += nodes;
+	}
+}
+
+/**
+ * Runs the readers for BENCH_RUN_MS, with the writer publishing if 'publishing'
+ * is set.  Returns the total reads per ms, setting 'publishesPerMs'.
+ */
+static double run(const char * name, VN210SharedRegisters & registers, VN210SimpleAPI & api, int readers, bool publishing,
+		double & publishesPerMs, ReaderResult & totals) {
+	std::atomic<bool> stop(false);
+	std::vector<ReaderResult> results(readers);
+	std::vector<std::thread> threads;
+	uint64_t publishes = 0;
+
+	for (int r = 0; r < readers; r++) threads.push_back(std::thread(reader, name, &stop, &results[r]));
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point end = start + std::chrono::milliseconds(BENCH_RUN_MS);
+
+	static uint64_t k = 1;
+
+	while (std::chrono::steady_clock::now() < end) {
+		if (!publishing) {
+			usleep(1000);
+			continue;
+		}
+
+		for (uint32_t n = 0; n < registers.getNodeCount(); n++, k++) {
+			fill(api, k);
+			registers.publish(n, api, k);
+			publishes++;
+		}
+	}
+
+	stop = true;
+	for (int r = 0; r < readers; r++) threads[r].join();
+
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	uint64_t reads = 0;
+
+	for (int r = 0; r < readers; r++) {
+		reads += results[r].reads;
+		totals.torn += results[r].torn;
+		totals.failed += results[r].failed;
+	}
+
+	publishesPerMs = publishes / ms;
+	return reads / ms;
+}
+
+int main(int argc, char ** argv) {
+	uint32_t nodes = argc > 1 ? atoi(argv[1]) : 1000;
+	int readers = argc > 2 ? atoi(argv[2]) : 2;
+
+	char name[64];
+	snprintf(name, sizeof(name), "/vn210_bench_%d", (int) getpid());
+
+	VN210RxTx_Host transport;
+	VN210SimpleAPI api(&transport);
+	memset(&api.uapData, 0, sizeof(api.uapData));
+	memset(&api.info, 0, sizeof(api.info));
+
+	VN210SharedRegisters registers;
+	if (!registers.create(name, nodes)) {
+		printf("can't create shared memory segment %s\n", name);
+		return 1;
+	}
+
+	//every node starts out consistent with publish number 0
+	fill(api, 0);
+	for (uint32_t n = 0; n < nodes; n++) registers.publish(n, api, 0);
+
+	ReaderResult totals = { 0, 0, 0 };
+	double publishesPerMs;
+
+	printf("%u nodes, %d readers, %lu bytes per node\n\n", nodes, readers, (unsigned long) sizeof(VN210SharedNode));
+	printf("%-12s %16s %16s\n", "writer", "node reads/ms", "publishes/ms");
+
+	double idle = run(name, registers, api, readers, false, publishesPerMs, totals);
+	printf("%-12s %16.0f %16s\n", "idle", idle, "-");
+
+	double busy = run(name, registers, api, readers, true, publishesPerMs, totals);
+	printf("%-12s %16.0f %16.0f\n", "publishing", busy, publishesPerMs);
+
+	printf("\ntorn reads: %lu, failed reads: %lu\n", (unsigned long) totals.torn, (unsigned long) totals.failed);
+
+	registers.close();
+	VN210SharedRegisters::remove(name);
+
+	return totals.torn == 0 && totals.failed == 0 ? 0 : 1;
+}
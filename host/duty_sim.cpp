@@ -0,0 +1,329 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Low-power idle duty cycle simulator.
+ *
+ * Runs one node, a VN210SimpleAPI with a VN210Scheduler sampling task, against
+ * a simulated radio polling it at each of a list of polling intervals.  The
+ * node's loop() is the one recommended for battery powered nodes:
+ *
+ *   scheduler.run(millis());
+ *   scheduler.idle(millis());
+ *
+ * Time is simulated in microseconds, and the processor's work is charged at
+ * fixed costs: each pass of loop(), each interrupt (SPI byte or timer tick),
+ * each message handled and each run of the sampling task.  When idle() sleeps,
+ * the node sleeps until the next interrupt: the next byte from the radio, the
+ * next timer tick (millis() on Arduino ticks every 1.024 ms), or, with the tick
+ * turned off, the next task due time.  The tick is on by default, as it is with
+ * VN210RxTx_Arduino, which leaves Timer0 running while it sleeps; the figures
+ * with -k 0 are for a tickless port that doesn't exist yet.  For each polling
+ * interval it prints:
+ *
+ *  - exchanges: SPI exchanges with the radio
+ *  - wakeups/s: times the processor was woken from sleep, per second
+ *  - awake: share of time awake, as simulated
+ *  - reported: share of time awake, from the scheduler's sleepTime and activeTime,
+ *    timed with the simulated microsecond clock
+ *  - avg mA: average supply current, from the active and idle currents
+ *  - saving: reduction in average current against a loop() which never sleeps
+ *
+ * Usage: duty_sim [-p poll ms list] [-t seconds] [-b us per byte] [-k tick ms] [-s sample ms]
+ *                 [-l loop us] [-i interrupt us] [-m message us] [-e sample us] [-A active mA] [-I idle mA]
+ *
+ * e.g. duty_sim -p 500,1000,60000 -k 0
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+#include "VN210RxTx_Host.h"
+#include "VN210FrameBuilder.h"
+#include "VN210Scheduler.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+#define DUTY_REPLY_ROOM (2 * (UAP_ATTRIBUTES_BUFFER_SIZE + VN210_FRAME_SIZE_MINUS_DATA))	//STX sent after each poll, room for the longest escaped reply
+
+/**
+ * Settings from the command line.
+ */
+typedef struct {
+	std::vector<double> pollMs;			//!< Polling intervals to simulate
+	double seconds;						//!< Simulated time for each interval
+	double usPerByte;					//!< SPI time per byte
+	double tickMs;						//!< Timer tick period, or 0 for none
+	double sampleMs;					//!< Sampling task period
+	double loopUs;						//!< Cost of one pass of loop() with nothing to do
+	double interruptUs;					//!< Cost of one interrupt
+	double messageUs;					//!< Extra cost of handling a message
+	double sampleUs;					//!< Extra cost of a run of the sampling task
+	double activeMa;					//!< Supply current while awake
+	double idleMa;						//!< Supply current while asleep
+} DutySettings;
+
+/**
+ * Results of one run.
+ */
+typedef struct {
+	uint64_t exchanges;
+	uint64_t wakeups;
+	double sleepUs;
+	uint32_t reportedSleepMs;
+	uint32_t reportedActiveMs;
+} DutyResult;
+
+/**
+ * The simulated node.
+ */
+struct DutyNode {
+	VN210RxTx_Host link;				//!< The node's end of the SPI link
+	VN210SimpleAPI api;					//!< The node's Simple API
+	VN210Scheduler scheduler;			//!< Runs the sampling task and puts the node to sleep
+	uint8_t sampleTask;					//!< Index of the sampling task
+
+	bool asleep;						//!< Set while the node is asleep
+	double sleepStart;					//!< When the node went to sleep, in us
+	double busyUntil;					//!< When the current pass of loop() ends, in us
+
+	DutyNode() : api(&link), scheduler(&api) {
+		memset(&this->api.uapData, 0, sizeof(this->api.uapData));
+		this->api.begin(false);
+
+		this->asleep = false;
+		this->sleepStart = 0;
+		this->busyUntil = 0;
+	}
+};
+
+static uint32_t simulatedMicros = 0;	//!< Simulated time, read by the scheduler as micros() would be on Arduino
+
+/**
+ * Microsecond clock registered with the node's scheduler.
+ */
+static unsigned long readSimulatedMicros(void) {
+	return simulatedMicros;
+}
+
+/**
+ * Sampling task.  Its cost is charged by the simulator.
+ */
+static void sample(void) {
+}
+
+/**
+ * Runs one pass of loop() up to idle(), starting at 'now' us.  The pass ends,
+ * and idle() is called, once its cost has been charged.
+ */
+static void startPass(const DutySettings & settings, DutyNode & node, double now) {
+	uint16_t runs = node.scheduler.tasks[node.sampleTask].runs;
+	double cost = settings.loopUs;
+
+	simulatedMicros = (uint32_t) now;
+	if (node.scheduler.run((uint32_t) (now / 1000))) cost += settings.messageUs;
+	if (node.scheduler.tasks[node.sampleTask].runs != runs) cost += settings.sampleUs;
+
+	node.busyUntil = now + cost;
+}
+
+/**
+ * An interrupt at 'now' us: wakes the node if it is asleep, otherwise delays the pass in progress.
+ */
+static void interrupt(const DutySettings & settings, DutyNode & node, double now, DutyResult & result) {
+	if (node.asleep) {
+		node.asleep = false;
+		result.sleepUs += now - node.sleepStart;
+		result.wakeups++;
+
+		startPass(settings, node, now + settings.interruptUs);
+	} else {
+		node.busyUntil += settings.interruptUs;
+	}
+}
+
+/**
+ * Simulates the node for settings.seconds with the radio polling every 'pollMs'.
+ */
+static void runDuty(const DutySettings & settings, double pollMs, DutyResult & result) {
+	DutyNode * node = new DutyNode();
+	node->sampleTask = node->scheduler.addTask(sample, (uint32_t) settings.sampleMs, 0);
+	node->scheduler.setMicrosClock(readSimulatedMicros);
+
+	std::vector<uint8_t> mosi;
+	size_t byteIndex = 0;
+	double exchangeStart = 0;
+	uint8_t pollID = 0;
+
+	double endUs = settings.seconds * 1e6;
+	double nextPoll = pollMs * 1000 / 2;
+	double nextTick = settings.tickMs > 0 ? settings.tickMs * 1000 : INFINITY;
+
+	startPass(settings, *node, 0);
+
+	for (;;) {
+		double nextByte = mosi.empty() ? nextPoll : exchangeStart + byteIndex * settings.usPerByte;
+		double passEnd = node->asleep ? INFINITY : node->busyUntil;
+		double taskWake = INFINITY;
+
+		//without a tick, a timer is set for the next task
+		if (node->asleep && settings.tickMs <= 0) {
+			taskWake = (floor(node->sleepStart / 1000) + node->scheduler.timeUntilNextTask((uint32_t) (node->sleepStart / 1000))) * 1000;
+		}
+
+		double now = fmin(fmin(nextByte, nextTick), fmin(passEnd, taskWake));
+		if (now >= endUs) break;
+
+		if (now == passEnd) {
+			simulatedMicros = (uint32_t) now;
+			if (node->scheduler.idle((uint32_t) (now / 1000))) {
+				node->asleep = true;
+				node->sleepStart = now;
+			} else {
+				startPass(settings, *node, now);
+			}
+		} else if (now == nextByte) {
+			if (mosi.empty()) {
+				VN210FrameBuilder::appendPoll(mosi, pollID++);
+				VN210FrameBuilder::appendStxFlood(mosi, DUTY_REPLY_ROOM);
+				exchangeStart = now;
+				byteIndex = 0;
+			}
+
+			node->link.exchange(mosi[byteIndex++]);
+
+			if (byteIndex == mosi.size()) {
+				mosi.clear();
+				nextPoll += pollMs * 1000;
+				result.exchanges++;
+			}
+
+			interrupt(settings, *node, now, result);
+		} else if (now == nextTick) {
+			nextTick += settings.tickMs * 1000;
+			interrupt(settings, *node, now, result);
+		} else {
+			interrupt(settings, *node, now, result);
+		}
+	}
+
+	if (node->asleep) result.sleepUs += endUs - node->sleepStart;
+
+	result.reportedSleepMs = node->scheduler.sleepTime;
+	result.reportedActiveMs = node->scheduler.activeTime;
+
+	delete node;
+}
+
+/**
+ * Parses a comma separated list of polling intervals.
+ */
+static std::vector<double> parseIntervals(const char * list) {
+	std::vector<double> intervals;
+
+	for (const char * p = list; *p != '\0'; ) {
+		double interval = atof(p);
+		if (interval > 0) intervals.push_back(interval);
+
+		p = strchr(p, ',');
+		if (p == NULL) break;
+		p++;
+	}
+
+	return intervals;
+}
+
+int main(int argc, char ** argv) {
+	DutySettings settings;
+	settings.pollMs = parseIntervals("500,1000,60000");
+	settings.seconds = 600;
+	settings.usPerByte = 40;			//measured on the VN210 clock line, see VN210_MasterPoller
+	settings.tickMs = 1.024;			//Timer0 overflow on a 16 MHz Arduino
+	settings.sampleMs = 1000;
+	settings.loopUs = 30;
+	settings.interruptUs = 5;
+	settings.messageUs = 100;
+	settings.sampleUs = 500;
+	settings.activeMa = 9.0;			//ATmega328P at 16 MHz and 5 V
+	settings.idleMa = 2.5;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "p:t:b:k:s:l:i:m:e:A:I:")) != -1) {
+		switch (opt) {
+			case 'p': settings.pollMs = parseIntervals(optarg); break;
+			case 't': settings.seconds = atof(optarg); break;
+			case 'b': settings.usPerByte = atof(optarg); break;
+			case 'k': settings.tickMs = atof(optarg); break;
+			case 's': settings.sampleMs = atof(optarg); break;
+			case 'l': settings.loopUs = atof(optarg); break;
+			case 'i': settings.interruptUs = atof(optarg); break;
+			case 'm': settings.messageUs = atof(optarg); break;
+			case 'e': settings.sampleUs = atof(optarg); break;
+			case 'A': settings.activeMa = atof(optarg); break;
+			case 'I': settings.idleMa = atof(optarg); break;
+			default:
+				fprintf(stderr, "usage: %s [-p poll ms list] [-t seconds] [-b us per byte] [-k tick ms] [-s sample ms]\n"
+						"       [-l loop us] [-i interrupt us] [-m message us] [-e sample us] [-A active mA] [-I idle mA]\n", argv[0]);
+				return 1;
+		}
+	}
+
+	if (settings.pollMs.empty() || settings.seconds <= 0 || settings.sampleMs < 1 || settings.loopUs <= 0) {
+		fprintf(stderr, "nothing to simulate\n");
+		return 1;
+	}
+
+	printf("%.0f s simulated, %.0f us per byte, tick %s, sampling every %.0f ms\n", settings.seconds, settings.usPerByte,
+			settings.tickMs > 0 ? "on" : "off", settings.sampleMs);
+	printf("costs: loop %.0f us, interrupt %.0f us, message %.0f us, sample %.0f us; %.1f mA awake, %.1f mA asleep\n",
+			settings.loopUs, settings.interruptUs, settings.messageUs, settings.sampleUs, settings.activeMa, settings.idleMa);
+	printf(settings.tickMs > 0 ? "tick as with VN210RxTx_Arduino, which keeps Timer0 running while asleep\n\n"
+			: "tick off: not reachable with VN210RxTx_Arduino, which keeps Timer0 running while asleep\n\n");
+	printf("%8s %10s %10s %8s %9s %8s %7s\n", "poll ms", "exchanges", "wakeups/s", "awake", "reported", "avg mA", "saving");
+
+	for (size_t i = 0; i < settings.pollMs.size(); i++) {
+		DutyResult result;
+		memset(&result, 0, sizeof(result));
+
+		runDuty(settings, settings.pollMs[i], result);
+
+		double awake = 1 - result.sleepUs / (settings.seconds * 1e6);
+		uint32_t reportedTotal = result.reportedSleepMs + result.reportedActiveMs;
+		double reported = reportedTotal > 0 ? (double) result.reportedActiveMs / reportedTotal : 1;
+		double current = awake * settings.activeMa + (1 - awake) * settings.idleMa;
+
+		printf("%8.0f %10lu %10.1f %7.2f%% %8.2f%% %8.2f %6.1f%%\n",
+				settings.pollMs[i],
+				(unsigned long) result.exchanges,
+				result.wakeups / settings.seconds,
+				awake * 100,
+				reported * 100,
+				current,
+				(1 - current / settings.activeMa) * 100);
+	}
+
+	return 0;
+}
@@ -0,0 +1,349 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Virtual node fleet load generator.
+ *
+ * Simulates N nodes, each a VN210SimpleAPI on its own VN210RxTx_Host link, with
+ * the tool playing every node's radio.  Each radio polls its node at the polling
+ * interval and, on each poll, sends a poll, a write or a read of all 8
+ * attributes, at the configured mix, sometimes with a bit flipped.  The node's
+ * loop() runs after each exchange, and its reply goes back in the next one.
+ *
+ * Time is simulated: exchanges happen in order of their simulated start time
+ * as fast as the host can run them, and take as long in simulated time as
+ * their bytes would take on the SPI bus.  For each fleet size it prints:
+ *
+ *  - frames/s: exchanges handled per second of wall clock time
+ *  - speedup: simulated seconds per wall clock second.  Below 1, one core can't
+ *    keep up with the fleet in real time
+ *  - service p50 / p99: wall clock time to clock one exchange through a link and
+ *    run its node's loop(), in us
+ *  - reply p50 / p99: simulated time from the start of a write or read request to
+ *    the end of its reply, in ms
+ *  - lost: writes and reads which got no reply
+ *  - cpu/link: CPU time per link per simulated second, in us.  This includes
+ *    building requests and decoding replies for the simulated radios
+ *
+ * Usage: fleet_sim [-n sizes] [-t seconds] [-p poll ms] [-b us per byte] [-w write %] [-r read %] [-c corrupt %]
+ *
+ * e.g. fleet_sim -n 10,100,500 -t 600 -p 1000 -w 30 -r 30 -c 1
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Host
+ */
+#include "VN210RxTx_Host.h"
+#include "VN210FrameBuilder.h"
+#include "VN210SimpleAPI.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <queue>
+#include <vector>
+
+#define FLEET_REPLY_ROOM (2 * (UAP_ATTRIBUTES_BUFFER_SIZE + VN210_FRAME_SIZE_MINUS_DATA))	//STX sent after each request, room for the longest escaped reply
+#define FLEET_LOST_POLLS 3				//polls without a reply before a request counts as lost
+
+/**
+ * Settings from the command line.
+ */
+typedef struct {
+	std::vector<int> sizes;				//!< Fleet sizes to run
+	double seconds;						//!< Simulated time for each run
+	double pollMs;						//!< Polling interval of every radio
+	double usPerByte;					//!< SPI time per byte
+	int writePercent;					//!< Share of polls which carry a write request
+	int readPercent;					//!< Share of polls which carry a read request
+	double corruptPercent;				//!< Share of requests with a bit flipped
+} FleetSettings;
+
+/**
+ * A write or read waiting for its reply.
+ */
+typedef struct {
+	uint8_t id;
+	double sentMs;
+	uint32_t poll;
+} PendingRequest;
+
+/**
+ * One simulated node and its radio.
+ */
+struct FleetNode {
+	VN210RxTx_Host link;				//!< The node's end of the SPI link
+	VN210SimpleAPI api;					//!< The node
+	VN210RxTx_Host radio;				//!< The radio's receive decoder, for replies
+	VN210FrameView radioView;			//!< Reply seen by the radio
+	bool radioFlag;						//!< Set by the radio's decoder when a reply arrives
+	uint8_t nextID;						//!< ID of the radio's next request
+	uint32_t polls;						//!< Exchanges so far
+	std::vector<PendingRequest> pending;	//!< Requests waiting for replies
+
+	FleetNode() : api(&link) {
+		memset(&this->api.uapData, 0, sizeof(this->api.uapData));
+		this->api.begin(false);
+
+		this->radioFlag = false;
+		this->radio.registerNewMessageFlag(&this->radioFlag);
+		this->radio.rxFrame = &this->radioView;
+		this->radio.begin();
+
+		this->nextID = rand() & 0xFF;
+		this->polls = 0;
+	}
+};
+
+/**
+ * Results of one run.
+ */
+typedef struct {
+	uint64_t exchanges;
+	uint64_t requests;
+	uint64_t lost;
+	double wallSeconds;
+	double cpuSeconds;
+	std::vector<double> serviceUs;
+	std::vector<double> replyMs;
+} FleetResult;
+
+/**
+ * A scheduled exchange: simulated start time and node.
+ */
+typedef std::pair<double, size_t> FleetEvent;
+
+static double cpuSeconds(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double percentile(std::vector<double> & samples, double p) {
+	if (samples.empty()) return 0;
+
+	size_t i = (size_t) (p / 100 * (samples.size() - 1));
+	std::nth_element(samples.begin(), samples.begin() + i, samples.end());
+	return samples[i];
+}
+
+/**
+ * Builds the radio's next request.  Returns true if it expects a reply.
+ */
+static bool buildRequest(const FleetSettings & settings, FleetNode & node, std::vector<uint8_t> & out) {
+	static const uint8_t ids[UAP_ATTRIBUTES_COUNT] = { 1, 2, 3, 4, 16, 17, 18, 19 };
+	uint8_t data[VN210_ATTRIBUTE_SIZE];
+	uint8_t id = node.nextID++;
+	int kind = rand() % 100;
+	bool wantsReply = true;
+
+	if (kind < settings.writePercent) {
+		data[0] = 1 + rand() % UAP_ANALOGS_COUNT;
+		VN210FloatCodec::encode((float) (rand() % 1000), &data[1]);
+		VN210FrameBuilder::append(out, 0x10, 0x01, id, data, sizeof(data));
+	} else if (kind < settings.writePercent + settings.readPercent) {
+		VN210FrameBuilder::append(out, 0x10, 0x02, id, ids, sizeof(ids));
+	} else {
+		VN210FrameBuilder::appendPoll(out, id);
+		wantsReply = false;
+	}
+
+	if (rand() % 10000 < settings.corruptPercent * 100) out[1 + rand() % (out.size() - 1)] ^= 1 << (rand() % 8);
+
+	if (wantsReply) {
+		PendingRequest request = { id, 0, node.polls };
+		node.pending.push_back(request);
+	}
+
+	VN210FrameBuilder::appendStxFlood(out, FLEET_REPLY_ROOM);
+	return wantsReply;
+}
+
+/**
+ * Passes the bytes the node sent back to its radio, matching replies with
+ * requests by message ID.  'endMs' is the simulated time at the end of the exchange.
+ */
+static void collectReplies(FleetNode & node, const std::vector<uint8_t> & miso, double endMs, FleetResult & result) {
+	for (size_t i = 0; i < miso.size(); i++) {
+		node.radio.feed(miso[i]);
+
+		if (!node.radioFlag) continue;
+
+		if (node.radio.parseMessage()) {
+			for (size_t p = 0; p < node.pending.size(); p++) {
+				if (node.pending[p].id == node.radioView.messageID()) {
+					result.replyMs.push_back(endMs - node.pending[p].sentMs);
+					node.pending.erase(node.pending.begin() + p);
+					break;
+				}
+			}
+		}
+		node.radio.releaseMessage();
+	}
+
+	//requests that have gone unanswered for too long
+	for (size_t p = 0; p < node.pending.size(); ) {
+		if (node.polls - node.pending[p].poll > FLEET_LOST_POLLS) {
+			node.pending.erase(node.pending.begin() + p);
+			result.lost++;
+		} else {
+			p++;
+		}
+	}
+}
+
+/**
+ * Simulates 'size' nodes for settings.seconds.
+ */
+static void runFleet(const FleetSettings & settings, int size, FleetResult & result) {
+	std::vector<FleetNode *> nodes(size);
+	std::priority_queue<FleetEvent, std::vector<FleetEvent>, std::greater<FleetEvent> > events;
+	std::vector<uint8_t> mosi;
+	std::vector<uint8_t> miso;
+
+	srand(1);
+
+	for (int n = 0; n < size; n++) {
+		nodes[n] = new FleetNode();
+
+		//spread the first polls over one interval, as radios joining at different times would be
+		events.push(FleetEvent(settings.pollMs * rand() / RAND_MAX, n));
+	}
+
+	double endMs = settings.seconds * 1000;
+	double cpuStart = cpuSeconds();
+	std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+
+	while (!events.empty() && events.top().first < endMs) {
+		FleetEvent event = events.top();
+		events.pop();
+
+		FleetNode & node = *nodes[event.second];
+		double startMs = event.first;
+
+		mosi.clear();
+		if (buildRequest(settings, node, mosi)) {
+			node.pending.back().sentMs = startMs;
+			result.requests++;
+		}
+		miso.resize(mosi.size());
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		node.link.exchange(&mosi[0], &miso[0], mosi.size());
+		while (node.api.hasNewMessage()) node.api.handleMessage();
+
+		result.serviceUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+		double exchangeMs = mosi.size() * settings.usPerByte / 1000;
+		node.polls++;
+		collectReplies(node, miso, startMs + exchangeMs, result);
+
+		result.exchanges++;
+		events.push(FleetEvent(startMs + settings.pollMs, event.second));
+	}
+
+	result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+	result.cpuSeconds = cpuSeconds() - cpuStart;
+
+	for (int n = 0; n < size; n++) delete nodes[n];
+}
+
+/**
+ * Parses a comma separated list of fleet sizes.
+ */
+static std::vector<int> parseSizes(const char * list) {
+	std::vector<int> sizes;
+
+	for (const char * p = list; *p != '\0'; ) {
+		int size = atoi(p);
+		if (size > 0) sizes.push_back(size);
+
+		p = strchr(p, ',');
+		if (p == NULL) break;
+		p++;
+	}
+
+	return sizes;
+}
+
+int main(int argc, char ** argv) {
+	FleetSettings settings;
+	settings.sizes = parseSizes("1,10,50,100,250,500,1000");
+	settings.seconds = 600;
+	settings.pollMs = 1000;
+	settings.usPerByte = 40;			//measured on the VN210 clock line, see VN210_MasterPoller
+	settings.writePercent = 30;
+	settings.readPercent = 30;
+	settings.corruptPercent = 1;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "n:t:p:b:w:r:c:")) != -1) {
+		switch (opt) {
+			case 'n': settings.sizes = parseSizes(optarg); break;
+			case 't': settings.seconds = atof(optarg); break;
+			case 'p': settings.pollMs = atof(optarg); break;
+			case 'b': settings.usPerByte = atof(optarg); break;
+			case 'w': settings.writePercent = atoi(optarg); break;
+			case 'r': settings.readPercent = atoi(optarg); break;
+			case 'c': settings.corruptPercent = atof(optarg); break;
+			default:
+				fprintf(stderr, "usage: %s [-n sizes] [-t seconds] [-p poll ms] [-b us per byte] [-w write %%] [-r read %%] [-c corrupt %%]\n", argv[0]);
+				return 1;
+		}
+	}
+
+	if (settings.sizes.empty() || settings.pollMs <= 0 || settings.seconds <= 0) {
+		fprintf(stderr, "nothing to simulate\n");
+		return 1;
+	}
+
+	printf("%.0f s simulated, polling every %.0f ms, %.0f us per byte, %d%% writes, %d%% reads, %.1f%% corrupted\n\n",
+			settings.seconds, settings.pollMs, settings.usPerByte, settings.writePercent, settings.readPercent, settings.corruptPercent);
+	printf("%6s %10s %9s %11s %11s %10s %10s %8s %10s\n",
+			"nodes", "frames/s", "speedup", "service p50", "service p99", "reply p50", "reply p99", "lost", "cpu/link");
+
+	for (size_t i = 0; i < settings.sizes.size(); i++) {
+		FleetResult result;
+		result.exchanges = 0;
+		result.requests = 0;
+		result.lost = 0;
+
+		runFleet(settings, settings.sizes[i], result);
+
+		printf("%6d %10.0f %9.1f %9.2fus %9.2fus %8.1fms %8.1fms %8lu %8.1fus\n",
+				settings.sizes[i],
+				result.exchanges / result.wallSeconds,
+				settings.seconds / result.wallSeconds,
+				percentile(result.serviceUs, 50),
+				percentile(result.serviceUs, 99),
+				percentile(result.replyMs, 50),
+				percentile(result.replyMs, 99),
+				(unsigned long) result.lost,
+				result.cpuSeconds * 1e6 / settings.sizes[i] / settings.seconds);
+	}
+
+	return 0;
+}
@@ -0,0 +1,296 @@
+/*
+ * SCADAFilter.h
+ *
+ * Created on: Oct 18, 2026
+ *
+ * Compile-time filter pipeline for feeding sensor samples into a SCADARegister.
+ *
+ * Each filter stage has the same interface:
+ *
+ *  - bool push(T sample, T & output) adds a sample, returning true and setting
+ *    output when the stage produces a value.  Decimating stages only produce
+ *    one output for every few inputs.
+ *  - void reset() clears the stage state.
+ *
+ * Stages are combined with SCADAFilterChain, and the end of the chain is fed into
+ * a register with SCADAFilteredRegister.  Only decimated values reach the register,
+ * so the per-sample work at high oversampling rates is just the cheap filter
+ * arithmetic.  For example, to take the median of 4 raw readings and then
+ * average the medians over 8 points:
+ *
+ *   SCADAFilteredRegister<SCADAFilterChain<MedianFilter<int16_t, 4>,
+ *                         MovingAverageFilter<int16_t, 8> > > filtered(&reg, 0.25);
+ *
+ *   filtered.addSample(raw);
+ *
+ * On AVR use int16_t samples where possible: accumulators are then 32 bit integers
+ * and no floating point is used until the value reaches the register.
+ */
+#include "SCADARegister.h"
+#include <stdint.h>
+#include <string.h>
+
+#ifndef SCADAFILTER_H_
+#define SCADAFILTER_H_
+
+/**
+ * Accumulator types and scaling for each supported sample type.
+ */
+template <typename T> struct SCADAFilterTraits;
+
+template <> struct SCADAFilterTraits<int16_t> {
+	typedef int32_t Accumulator;										//!< Holds sums of many samples without overflowing.
+	typedef uint32_t Wrapping;											//!< Used where modular (wrapping) arithmetic is required.
+	static int32_t shiftDown(int32_t value, uint8_t bits) { return value >> bits; }
+};
+
+template <> struct SCADAFilterTraits<int32_t> {
+	typedef int32_t Accumulator;										//!< Sums may overflow with large samples.  Keep samples below 2^24.
+	typedef uint32_t Wrapping;											//!< Used where modular (wrapping) arithmetic is required.
+	static int32_t shiftDown(int32_t value, uint8_t bits) { return value >> bits; }
+};
+
+template <> struct SCADAFilterTraits<float> {
+	typedef float Accumulator;											//!< Floats are used as-is.  Slow on AVR.
+	static float shiftDown(float value, uint8_t bits) { return value / (float) (1UL << bits); }
+};
+
+/**
+ * Sliding window average over the last N samples.  Produces an output for every
+ * input once the window has filled.  Use a power of two for N to avoid a division.
+ */
+template <typename T, uint8_t N>
+class MovingAverageFilter {
+public:
+	typedef T SampleType;
+
+	MovingAverageFilter() { this->reset(); }
+
+	bool push(T sample, T & output) {
+		this->sum += sample;
+		this->sum -= this->window[this->idx];
+		this->window[this->idx] = sample;
+
+		if (++this->idx == N) {
+			this->idx = 0;
+			this->filled = true;
+		}
+
+		if (!this->filled) return false;
+
+		output = (T) (this->sum / N);
+		return true;
+	}
+
+	void reset() {
+		memset(this->window, 0, sizeof(this->window));
+		this->sum = 0;
+		this->idx = 0;
+		this->filled = false;
+	}
+private:
+	T window[N];														//!< Last N samples
+	typename SCADAFilterTraits<T>::Accumulator sum;						//!< Running sum of the window
+	uint8_t idx;														//!< Position of the oldest sample in the window
+	bool filled;														//!< True once N samples have been seen
+};
+
+/**
+ * Exponential moving average with a smoothing factor of 1 / 2^SHIFT.  Produces
+ * an output for every input.  The integer version keeps SHIFT extra bits of
+ * precision in the accumulator, so it only needs an add, subtract and shift.
+ */
+template <typename T, uint8_t SHIFT>
+class EMAFilter {
+public:
+	typedef T SampleType;
+
+	EMAFilter() { this->reset(); }
+
+	bool push(T sample, T & output) {
+		if (!this->primed) {
+			//start from the first sample, rather than ramping up from zero
+			this->acc = (typename SCADAFilterTraits<T>::Accumulator) sample * (1L << SHIFT);
+			this->primed = true;
+		} else {
+			this->acc += sample - SCADAFilterTraits<T>::shiftDown(this->acc, SHIFT);
+		}
+
+		output = (T) SCADAFilterTraits<T>::shiftDown(this->acc, SHIFT);
+		return true;
+	}
+
+	void reset() {
+		this->acc = 0;
+		this->primed = false;
+	}
+private:
+	typename SCADAFilterTraits<T>::Accumulator acc;						//!< Average scaled up by 2^SHIFT
+	bool primed;														//!< True once the first sample has been seen
+};
+
+/**
+ * Cascaded integrator-comb decimator of order ORDER, producing one output for
+ * every R inputs.  The output is normalised by the filter gain R^ORDER, so it is
+ * in the same units as the input.
+ *
+ * Until the comb delays have filled, the first ORDER - 1 decimated outputs after
+ * reset() are transients (a constant input of 1000 gives 312 and 937 at order 3),
+ * so they are dropped rather than passed on to the register's minimum and maximum.
+ *
+ * Integer sample types only.  The integrators rely on wrapping arithmetic, so
+ * R^ORDER * (largest sample) must fit in 31 bits.
+ */
+template <typename T, uint8_t R, uint8_t ORDER>
+class CICDecimator {
+public:
+	typedef T SampleType;
+
+	CICDecimator() { this->reset(); }
+
+	bool push(T sample, T & output) {
+		typedef typename SCADAFilterTraits<T>::Wrapping Wrapping;
+
+		Wrapping value = (Wrapping) (int32_t) sample;
+
+		for (uint8_t i = 0; i < ORDER; i++) {
+			this->integrators[i] += value;
+			value = this->integrators[i];
+		}
+
+		if (++this->count < R) return false;
+		this->count = 0;
+
+		for (uint8_t i = 0; i < ORDER; i++) {
+			Wrapping delayed = this->combs[i];
+			this->combs[i] = value;
+			value -= delayed;
+		}
+
+		if (this->settling > 0) {
+			this->settling--;
+			return false;
+		}
+
+		output = (T) ((int32_t) value / gain());
+		return true;
+	}
+
+	void reset() {
+		memset(this->integrators, 0, sizeof(this->integrators));
+		memset(this->combs, 0, sizeof(this->combs));
+		this->count = 0;
+		this->settling = ORDER - 1;
+	}
+private:
+	typename SCADAFilterTraits<T>::Wrapping integrators[ORDER];			//!< Integrator stages, run at the input rate
+	typename SCADAFilterTraits<T>::Wrapping combs[ORDER];				//!< Comb stage delays, run at the output rate
+	uint8_t count;														//!< Number of inputs since the last output
+	uint8_t settling;													//!< Decimated outputs still to drop while the filter settles
+
+	static int32_t gain() {
+		int32_t g = 1;
+		for (uint8_t i = 0; i < ORDER; i++) g *= R;
+		return g;
+	}
+};
+
+/**
+ * Block median of N samples, producing one output for every N inputs.  Rejects
+ * single-sample spikes that would otherwise end up in the register's min / max.
+ * For even N the upper of the two middle values is used.
+ */
+template <typename T, uint8_t N>
+class MedianFilter {
+public:
+	typedef T SampleType;
+
+	MedianFilter() { this->reset(); }
+
+	bool push(T sample, T & output) {
+		//insertion sort as we go. N is small, so this is cheaper than sorting at the end.
+		uint8_t i = this->count++;
+		while (i > 0 && this->sorted[i - 1] > sample) {
+			this->sorted[i] = this->sorted[i - 1];
+			i--;
+		}
+		this->sorted[i] = sample;
+
+		if (this->count < N) return false;
+
+		output = this->sorted[N / 2];
+		this->count = 0;
+		return true;
+	}
+
+	void reset() {
+		this->count = 0;
+	}
+private:
+	T sorted[N];														//!< Samples in the current block, in ascending order
+	uint8_t count;														//!< Number of samples in the current block
+};
+
+/**
+ * Joins two filter stages so that the output of the first is the input of the
+ * second.  Chains can be nested to build longer pipelines.
+ */
+template <class First, class Second>
+class SCADAFilterChain {
+public:
+	typedef typename First::SampleType SampleType;
+
+	bool push(SampleType sample, SampleType & output) {
+		SampleType intermediate;
+
+		if (!this->first.push(sample, intermediate)) return false;
+		return this->second.push(intermediate, output);
+	}
+
+	void reset() {
+		this->first.reset();
+		this->second.reset();
+	}
+
+	First first;														//!< First stage
+	Second second;														//!< Second stage, fed by the first
+};
+
+/**
+ * Feeds the output of a filter pipeline into a SCADA register.  Raw samples are
+ * multiplied by 'scale' as they leave the pipeline, so the filters can work
+ * in integer sensor counts while the register holds engineering units.
+ */
+template <class Filter>
+class SCADAFilteredRegister {
+public:
+	typedef typename Filter::SampleType SampleType;
+
+	Filter filter;														//!< Filter pipeline
+
+	SCADAFilteredRegister(SCADARegister * reg, float scale = 1.0) {
+		this->reg = reg;
+		this->scale = scale;
+	}
+
+	/**
+	 * Adds a raw sample to the filter.  Returns true if a value was added to the register.
+	 */
+	bool addSample(SampleType sample) {
+		SampleType output;
+
+		if (!this->filter.push(sample, output)) return false;
+
+		this->reg->addValue(output * this->scale);
+		return true;
+	}
+
+	void reset() {
+		this->filter.reset();
+	}
+private:
+	SCADARegister * reg;												//!< Register fed by the filter
+	float scale;														//!< Multiplier from filter units to register units
+};
+
+#endif /* SCADAFILTER_H_ */
@@ -4,7 +4,9 @@
  * Created on: Jun 19, 2012
  * Author: Vic Catterson, Pete Baker
  */
-#include "Arduino.h";
+#if defined(ARDUINO)
+#include "Arduino.h"
+#endif
 
 #ifndef SCADAREGISTER_H_
 #define SCADAREGISTER_H_
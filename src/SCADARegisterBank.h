@@ -0,0 +1,110 @@
+/*
+ * SCADARegisterBank.h
+ *
+ * Created on: Oct 18, 2026
+ *
+ * Bank of N SCADA registers updated together from one sample per channel.
+ *
+ * A node sampling many channels at the same rate (or a gateway aggregating
+ * thousands) would otherwise keep one SCADARegister per channel and call
+ * addValue() on each in turn.  The bank keeps the averages, minima and maxima
+ * as parallel arrays with a single sample count, so one call updates every
+ * channel, the division for the average is done once rather than per channel,
+ * and each array is walked in order:
+ *
+ *   SCADARegisterBank<16> bank;
+ *   float samples[16];
+ *
+ *   bank.addSamples(samples);
+ *   ...
+ *   VN210.uapData.analogs[0].value = bank.average[3];
+ *   bank.reset();
+ *
+ * The results match SCADARegister's for the same samples, to within float
+ * rounding.  On x86 host builds the update runs four channels at a time with
+ * SSE.  Elsewhere the loop is written so that the compiler can vectorise it,
+ * e.g. with NEON.  On AVR there is no vector unit, but the per-register call
+ * and the per-sample division are still saved.
+ *
+ * Doesn't depend on Arduino.h, so it can be used in host builds.
+ */
+#include <stdint.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#ifndef SCADAREGISTERBANK_H_
+#define SCADAREGISTERBANK_H_
+
+#if defined(__SSE__)
+#define SCADA_BANK_SSE 1			//addSamples() uses SSE
+#else
+#define SCADA_BANK_SSE 0
+#endif
+
+#ifndef SC_FLOAT_MAX_VALUE
+#define SC_FLOAT_MAX_VALUE 32767
+#define SC_FLOAT_MIN_VALUE -32766
+#endif
+
+template <uint16_t N>
+class SCADARegisterBank {
+public:
+	float average[N];													//!< Average of each channel's samples
+	float minimum[N];													//!< Smallest sample of each channel
+	float maximum[N];													//!< Largest sample of each channel
+	unsigned int total;													//!< Number of samples added to every channel
+
+	SCADARegisterBank() { this->reset(); }
+
+	/**
+	 * Resets every channel, as SCADARegister::reset() does.
+	 */
+	void reset() {
+		for (uint16_t i = 0; i < N; i++) {
+			this->average[i] = 0;
+			this->minimum[i] = SC_FLOAT_MAX_VALUE;
+			this->maximum[i] = SC_FLOAT_MIN_VALUE;
+		}
+
+		this->total = 0;
+	}
+
+	/**
+	 * Adds one sample to each channel: samples[i] goes to channel i.
+	 */
+	void addSamples(const float * samples) {
+		//average = (average * total + sample) / (total + 1), with the division done once for the bank
+		float count = (float) this->total;
+		float scale = 1.0f / (float) (this->total + 1);
+		uint16_t i = 0;
+
+#if SCADA_BANK_SSE
+		const __m128 count4 = _mm_set1_ps(count);
+		const __m128 scale4 = _mm_set1_ps(scale);
+
+		for (; i + 4 <= N; i += 4) {
+			__m128 x = _mm_loadu_ps(samples + i);
+
+			//minps / maxps return the second operand if either is NaN, so a NaN sample is ignored as it is by SCADARegister
+			_mm_storeu_ps(this->minimum + i, _mm_min_ps(x, _mm_loadu_ps(this->minimum + i)));
+			_mm_storeu_ps(this->maximum + i, _mm_max_ps(x, _mm_loadu_ps(this->maximum + i)));
+
+			__m128 sum = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(this->average + i), count4), x);
+			_mm_storeu_ps(this->average + i, _mm_mul_ps(sum, scale4));
+		}
+#endif
+
+		for (; i < N; i++) {
+			float x = samples[i];
+
+			this->minimum[i] = x < this->minimum[i] ? x : this->minimum[i];
+			this->maximum[i] = x > this->maximum[i] ? x : this->maximum[i];
+			this->average[i] = (this->average[i] * count + x) * scale;
+		}
+
+		this->total++;
+	}
+};
+
+#endif /* SCADAREGISTERBANK_H_ */
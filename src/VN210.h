@@ -57,6 +57,12 @@
 #define API_STX 0xF1
 #define API_CHX 0xF2
 
+// Section 3.1.3.3 - Data pass-through read request and response
+#define API_PASSTHROUGH_REQUEST_HEADER 0x10
+#define API_PASSTHROUGH_RESPONSE_HEADER 0x18
+#define API_READ_DATA_REQUEST 2
+#define API_READ_DATA_RESPONSE 3
+
 /**
  * VN210 API message structure.  This is defined in both the Simple and Full APIs.
  */
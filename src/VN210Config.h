@@ -0,0 +1,251 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Compile-time configuration of the VN210 library.
+ *
+ * The Arduino IDE doesn't pass compiler flags to libraries, so edit the defaults
+ * below to change the configuration.  Every setting can also be overridden with a
+ * -D compiler flag, which is how tools/footprint.sh builds each configuration.
+ *
+ * Static RAM used by the transport and API:
+ *
+ *  - VN210_BUFFER_SIZE * 2 bytes of frame buffer, or VN210_BUFFER_SIZE bytes
+ *    when VN210_SHARED_BUFFER is enabled.
+ *  - UAP_ATTRIBUTES_BUFFER_SIZE bytes of read response buffer in the API.
+ *  - With VN210_UAP_SNAPSHOT enabled, 2 * VN210_SNAPSHOT_MAX_ATTRIBUTES * 5 bytes
+ *    of attribute snapshots.
+ *  - VN210_TX_QUEUE_DATA_SIZE + 7 * VN210_TX_QUEUE_LENGTH bytes of transmit queue.
+ *  - With the DMA transport, 2 * VN210_DMA_RING_SIZE bytes of DMA rings.
+ *  - Two VN210_APIMessage structs and the UAP / info registers.
+ *
+ * Run tools/footprint.sh to print the exact RAM and flash cost of each configuration.
+ *
+ * Pin assignments for the Arduino transport are in VN210Pins.h.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Headers
+ */
+#ifndef VN210CONFIG_H_
+#define VN210CONFIG_H_
+
+/**
+ * Size of the receive and transmit buffers in bytes.  114 matches the largest
+ * buffer of any VN210.  The radio never sends a frame longer than its own buffer,
+ * so this can be reduced to the value the radio reports in info.maxBufferSize
+ * (see VN210SimpleAPI::getMaxBufferSize()).  Outgoing frames which don't fit once
+ * escaped are dropped by VN210RxTx::sendMsg(), so read responses are limited to
+ * the attributes which fit when every byte is escaped: 4 with a 64 byte buffer.
+ */
+#ifndef VN210_BUFFER_SIZE
+#define VN210_BUFFER_SIZE 114
+#endif
+
+/**
+ * Set to 1 to use a single buffer for both receiving and transmitting.
+ *
+ * This halves the buffer RAM.  It works because a response is only packed after
+ * the request it answers has been handled and released, and while a response is
+ * being clocked out, received bytes are only stored over bytes which have
+ * already been sent.  The cost is that frames from the radio which arrive while
+ * a response is being packed are dropped, and that responses wait in the
+ * transmit queue until the next hasNewMessage() after the frame is released.
+ */
+#ifndef VN210_SHARED_BUFFER
+#define VN210_SHARED_BUFFER 0
+#endif
+
+/**
+ * Set to 1 to serve passthrough reads from a published snapshot of the attribute
+ * values (see VN210Snapshot.h and VN210SimpleAPI::publish()).
+ *
+ * Reads then always see a consistent set of values, even if the application is
+ * part-way through updating uapData, and read requests can optionally be
+ * answered straight from the SPI interrupt (VN210SimpleAPI::setInterruptReads()).
+ * The cost is the RAM for two copies of the encoded attributes, and values only
+ * reach the radio when publish() is called.
+ */
+#ifndef VN210_UAP_SNAPSHOT
+#define VN210_UAP_SNAPSHOT 0
+#endif
+
+/**
+ * Largest number of attributes held in each snapshot.
+ */
+#ifndef VN210_SNAPSHOT_MAX_ATTRIBUTES
+#define VN210_SNAPSHOT_MAX_ATTRIBUTES 8
+#endif
+
+/**
+ * Number of outgoing messages which can wait in the transmit queue (see
+ * VN210TxQueue.h), including the one in the transmit buffer.  When the queue is
+ * full, a new message displaces the newest message of lower priority, or is
+ * dropped if there isn't one.
+ */
+#ifndef VN210_TX_QUEUE_LENGTH
+#define VN210_TX_QUEUE_LENGTH 4
+#endif
+
+/**
+ * Bytes of payload storage shared by the queued messages.  The default holds the
+ * largest payload which always fits in the transmit buffer (a segment fragment)
+ * and a full read response at the same time.
+ */
+#ifndef VN210_TX_QUEUE_DATA_SIZE
+#define VN210_TX_QUEUE_DATA_SIZE ((VN210_BUFFER_SIZE - 1) / 2 + 40)
+#endif
+
+/**
+ * Number of times a queued message can be overtaken by more urgent messages
+ * before it is sent next regardless of priority.  Bounds how long routine
+ * traffic waits while alarms and responses keep arriving.
+ */
+#ifndef VN210_TX_MAX_BYPASS
+#define VN210_TX_MAX_BYPASS 4
+#endif
+
+/**
+ * Number of polls from the radio, after the last fragment of a segmented
+ * transfer (see VN210Segment.h) was sent, without a SEGMENT_ACK before the
+ * unacknowledged fragments are sent again.
+ */
+#ifndef VN210_SEGMENT_RETRY_POLLS
+#define VN210_SEGMENT_RETRY_POLLS 3
+#endif
+
+/**
+ * Number of times the unacknowledged fragments of a segmented transfer are sent
+ * again, with no SEGMENT_ACK in between, before the transfer is abandoned.  With
+ * VN210_SEGMENT_RETRY_POLLS, sets how many polls a silent receiver can hold the
+ * link for.
+ */
+#ifndef VN210_SEGMENT_MAX_RETRIES
+#define VN210_SEGMENT_MAX_RETRIES 5
+#endif
+
+/**
+ * Number of most recent frames from the radio in which write requests are
+ * remembered by message ID and CRC (see VN210DuplicateFilter.h).  A write
+ * matching one of them is a retransmission by the radio: it is acknowledged
+ * again but not applied.  Set to 0 to apply every write, as before.
+ */
+#ifndef VN210_DUPLICATE_CACHE_SIZE
+#define VN210_DUPLICATE_CACHE_SIZE 4
+#endif
+
+/**
+ * Number of SCADA register snapshots kept in the history ring (see
+ * VN210History.h) for the radio to fetch after a network outage.  Costs
+ * VN210_HISTORY_LENGTH * 21 bytes for the ring (unless it is moved to EEPROM)
+ * and as much again for the reply being sent.  0 (the default) leaves the
+ * history out.
+ */
+#ifndef VN210_HISTORY_LENGTH
+#define VN210_HISTORY_LENGTH 0
+#endif
+
+/**
+ * Number of expected poll intervals without a poll before the link monitor
+ * (see VN210LinkMonitor.h) resets the radio, when the application calls
+ * checkLink().  Keep the silence this allows longer than the radio takes to
+ * start polling after a reset, about 5 s.  0 leaves the monitor out.
+ */
+#ifndef VN210_LINK_MISSED_POLLS
+#define VN210_LINK_MISSED_POLLS 10
+#endif
+
+/**
+ * Longest wait between radio resets by the link monitor, in milliseconds, while
+ * the radio still isn't polling.  The wait doubles after each reset up to this.
+ */
+#ifndef VN210_LINK_MAX_BACKOFF_MS
+#define VN210_LINK_MAX_BACKOFF_MS 600000UL
+#endif
+
+/**
+ * Set to 1 to support keeping the radio's information and the polling frequency
+ * and SPI speed in EEPROM (see VN210SimpleAPI::setSettingsStorage()), so a
+ * restarted node only has to check the radio's firmware version.  Costs a few
+ * bytes of RAM, and nothing is stored until the application sets the storage.
+ */
+#ifndef VN210_WARM_START
+#define VN210_WARM_START 1
+#endif
+
+/**
+ * Size of each of the receive and transmit DMA rings used by VN210RxTx_DMA.
+ * The transport runs on every half ring, so this sets both the interrupt rate
+ * (one per VN210_DMA_RING_SIZE / 2 bytes) and the delay before a packed message
+ * starts to go out (up to VN210_DMA_RING_SIZE / 2 bytes of zeros first).  Keep
+ * it well below the length of the radio's exchanges.  Must be a power of two.
+ * Not used on Arduino.
+ */
+#ifndef VN210_DMA_RING_SIZE
+#define VN210_DMA_RING_SIZE 32
+#endif
+
+#if VN210_BUFFER_SIZE < 32 || VN210_BUFFER_SIZE > 255
+#error VN210_BUFFER_SIZE must be between 32 and 255 bytes
+#endif
+
+#if VN210_TX_QUEUE_LENGTH < 1 || VN210_TX_QUEUE_LENGTH > 127
+#error VN210_TX_QUEUE_LENGTH must be between 1 and 127 messages
+#endif
+
+#if VN210_TX_QUEUE_DATA_SIZE > 255
+#error VN210_TX_QUEUE_DATA_SIZE must be no more than 255 bytes
+#endif
+
+#if VN210_SEGMENT_RETRY_POLLS < 1 || VN210_SEGMENT_RETRY_POLLS > 255
+#error VN210_SEGMENT_RETRY_POLLS must be between 1 and 255 polls
+#endif
+
+#if VN210_SEGMENT_MAX_RETRIES < 1 || VN210_SEGMENT_MAX_RETRIES > 255
+#error VN210_SEGMENT_MAX_RETRIES must be between 1 and 255 retransmissions
+#endif
+
+#if VN210_DUPLICATE_CACHE_SIZE < 0 || VN210_DUPLICATE_CACHE_SIZE > 32
+#error VN210_DUPLICATE_CACHE_SIZE must be between 0 and 32 frames
+#endif
+
+#if VN210_HISTORY_LENGTH < 0 || VN210_HISTORY_LENGTH > 255
+#error VN210_HISTORY_LENGTH must be between 0 and 255 entries
+#endif
+
+#if VN210_LINK_MISSED_POLLS < 0 || VN210_LINK_MISSED_POLLS > 255
+#error VN210_LINK_MISSED_POLLS must be between 0 and 255 polls
+#endif
+
+#if VN210_LINK_MAX_BACKOFF_MS < 10000
+#error VN210_LINK_MAX_BACKOFF_MS must be at least 10000 ms
+#endif
+
+#if VN210_WARM_START != 0 && VN210_WARM_START != 1
+#error VN210_WARM_START must be 0 or 1
+#endif
+
+#if VN210_DMA_RING_SIZE < 4 || VN210_DMA_RING_SIZE > 1024 || (VN210_DMA_RING_SIZE & (VN210_DMA_RING_SIZE - 1))
+#error VN210_DMA_RING_SIZE must be a power of two between 4 and 1024 bytes
+#endif
+
+#endif /* VN210CONFIG_H_ */
@@ -0,0 +1,78 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdint.h>
+
+#ifndef VN210DMAHAL_H_
+#define VN210DMAHAL_H_
+
+/**
+ * Hardware abstraction used by VN210RxTx_DMA.  Implement this once per MCU
+ * family (e.g. on the STM32 HAL or CMSIS drivers) to run the transport there,
+ * or use the simulated HAL in host/ to run it on a PC.
+ *
+ * The SPI peripheral runs as a slave, with both directions on circular DMA over
+ * rings of the same length, and the DMA half-transfer and transfer-complete
+ * interrupts calling VN210RxTx_DMA::rxtx().  Calling rxtx() from the chip select
+ * (NSS) rising edge as well is recommended, so the end of each exchange with the
+ * radio is decoded straight away rather than at the next half ring.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Lowlevel
+ * @ingroup Headers
+ */
+class VN210DMAHal {
+public:
+	/**
+	 * Radio control lines, driven by writePin().
+	 */
+	enum Pin {
+		PIN_WAKEUP,					//!< WKU, pulsed high to wake the radio
+		PIN_RESET,					//!< RESET, active low
+		PIN_PROVISIONING,			//!< PROVISIONING, active low
+		PIN_BOOT					//!< BOOT, selects the firmware the radio boots
+	};
+
+	/**
+	 * Starts the SPI peripheral as a slave in mode 0, MSB first, with circular
+	 * DMA from 'txRing' and into 'rxRing', each 'length' bytes.
+	 */
+	virtual void startSPISlave(volatile uint8_t * rxRing, volatile uint8_t * txRing, uint16_t length) = 0;
+
+	/**
+	 * Returns the index in the receive ring that the DMA will write next, i.e.
+	 * length minus the DMA's remaining transfer count.
+	 */
+	virtual uint16_t rxPosition(void) = 0;
+
+	/**
+	 * Sets a radio control line as an output at 'level'.
+	 */
+	virtual void writePin(Pin pin, bool level) = 0;
+
+	/**
+	 * Blocks for 'ms' milliseconds.
+	 */
+	virtual void delayMs(uint16_t ms) = 0;
+};
+
+#endif /* VN210DMAHAL_H_ */
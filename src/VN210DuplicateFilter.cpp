@@ -0,0 +1,95 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210DuplicateFilter.h"
+
+#if VN210_DUPLICATE_CACHE_SIZE
+
+/**
+ * Class constructor.  Starts with nothing remembered.
+ */
+VN210DuplicateFilter::VN210DuplicateFilter() {
+	this->clear();
+	this->duplicates = 0;
+}
+
+/**
+ * Returns true if a write with the same message ID and CRC is remembered.
+ * Otherwise counts the write as a newer frame, remembers it in place of the
+ * oldest, and returns false.
+ */
+bool VN210DuplicateFilter::seen(const VN210FrameView & frame) {
+	uint8_t id = frame.messageID();
+	uint16_t crc = frame.crc();
+
+	for (uint8_t i = 0; i < this->count; i++) {
+		uint8_t entry = (this->next + VN210_DUPLICATE_CACHE_SIZE - 1 - i) % VN210_DUPLICATE_CACHE_SIZE;
+
+		if (this->ids[entry] == id && this->crcs[entry] == crc) {
+			this->duplicates++;
+			return true;
+		}
+	}
+
+	this->passed(1);
+
+	this->ids[this->next] = id;
+	this->crcs[this->next] = crc;
+	this->stamps[this->next] = this->clock;
+
+	if (++this->next == VN210_DUPLICATE_CACHE_SIZE) this->next = 0;
+	if (this->count < VN210_DUPLICATE_CACHE_SIZE) this->count++;
+
+	return false;
+}
+
+/**
+ * Counts 'frames' newer frames from the radio, forgetting the writes they push
+ * out of the window.  Entries are kept oldest first, so only the oldest need
+ * checking.
+ */
+void VN210DuplicateFilter::passed(uint16_t frames) {
+	if (frames >= VN210_DUPLICATE_CACHE_SIZE) {
+		this->count = 0;
+		return;
+	}
+
+	this->clock += frames;
+
+	while (this->count > 0) {
+		uint8_t oldest = (this->next + VN210_DUPLICATE_CACHE_SIZE - this->count) % VN210_DUPLICATE_CACHE_SIZE;
+
+		if ((uint8_t) (this->clock - this->stamps[oldest]) < VN210_DUPLICATE_CACHE_SIZE) break;
+		this->count--;
+	}
+}
+
+/**
+ * Forgets every frame.
+ */
+void VN210DuplicateFilter::clear(void) {
+	this->count = 0;
+	this->next = 0;
+	this->clock = 0;
+}
+
+#endif
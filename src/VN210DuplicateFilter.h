@@ -0,0 +1,67 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210Config.h"
+#include "VN210FrameView.h"
+
+#ifndef VN210DUPLICATEFILTER_H_
+#define VN210DUPLICATEFILTER_H_
+
+/**
+ * Remembers the write requests among the last few frames from the radio, by
+ * message ID and CRC, so that a radio retransmission of a write can be
+ * acknowledged again without being applied a second time.
+ *
+ * The CRC covers the header, type, ID, size and data, so a frame only matches
+ * if it is byte-for-byte the same as one remembered.  The radio moves its 8 bit
+ * message ID on for every frame it sends, not just writes, so every other frame
+ * must be counted with passed().  A write is forgotten once
+ * VN210_DUPLICATE_CACHE_SIZE newer frames have followed it, long before the ID
+ * counter wraps, so a new write reusing its ID and payload isn't mistaken for a
+ * retransmission.  A retransmission keeps the ID of the original, so it isn't
+ * counted as a newer frame.
+ *
+ * The number of frames is set by VN210_DUPLICATE_CACHE_SIZE in VN210Config.h.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup SimpleAPI
+ */
+class VN210DuplicateFilter {
+public:
+	VN210DuplicateFilter();
+
+	bool seen(const VN210FrameView & frame);						//true if the write was seen recently.  otherwise remembers it
+	void passed(uint16_t frames);									//counts frames from the radio which weren't writes
+	void clear(void);												//forgets every frame, e.g. when the radio restarts its message IDs
+
+	uint16_t duplicates;											//!< Number of retransmissions found
+private:
+	uint8_t ids[VN210_DUPLICATE_CACHE_SIZE];						//!< Message IDs of the remembered frames
+	uint16_t crcs[VN210_DUPLICATE_CACHE_SIZE];						//!< CRCs of the remembered frames
+	uint8_t stamps[VN210_DUPLICATE_CACHE_SIZE];						//!< Value of 'clock' when each frame was remembered
+	uint8_t clock;													//!< Number of frames counted, wrapping
+	uint8_t count;													//!< Number of frames remembered
+	uint8_t next;													//!< Entry replaced by the next frame remembered
+};
+
+#endif /* VN210DUPLICATEFILTER_H_ */
@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210.h"
+#include <stddef.h>
+
+#ifndef VN210FRAMEVIEW_H_
+#define VN210FRAMEVIEW_H_
+
+/**
+ * Read-only view of a received API frame, in place in the transport's receive
+ * buffer.  Nothing is copied: the accessors read the frame fields directly.
+ *
+ * The transport holds the frame for the API once its CRC has been checked, so
+ * the interrupt no longer writes to it and the bytes can be read without
+ * volatile.  A view is valid until the next call to VN210SimpleAPI::hasNewMessage(),
+ * or, with VN210_SHARED_BUFFER enabled, until a message is sent.  Copy out
+ * anything that's needed for longer.
+ *
+ * A default-constructed view reads as an empty frame with every field zero.
+ *
+ * Frame layout (3.1.3): STX, header, type, ID, size, data[size], CRC MSB, CRC LSB.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Lowlevel
+ * @ingroup Headers
+ */
+class VN210FrameView {
+public:
+	VN210FrameView() : frame(empty()), length(7) {}
+	VN210FrameView(const uint8_t * frame, uint8_t length) : frame(frame), length(length) {}
+
+	bool isEmpty() const { return this->frame == empty(); }			//true if no frame is being viewed
+
+	uint8_t header() const { return this->frame[1]; }				//message class and request / response flag
+	uint8_t messageClass() const { return this->frame[1] >> 4; }	//message class.  One of VN210SimpleAPI::MessageClass
+	bool isResponse() const { return this->frame[1] & 0x08; }		//true if the response bit is set
+	uint8_t messageType() const { return this->frame[2]; }			//message type
+	uint8_t messageID() const { return this->frame[3]; }			//message ID
+	uint8_t dataSize() const { return this->frame[4]; }				//number of data bytes
+
+	const uint8_t * data() const { return this->frame + 5; }		//pointer to the data bytes
+	uint8_t data(uint8_t i) const { return this->frame[5 + i]; }	//data byte i
+
+	//big-endian 16 bit value starting at data byte i
+	uint16_t data16(uint8_t i) const { return ((uint16_t) this->frame[5 + i] << 8) | this->frame[6 + i]; }
+
+	//frame CRC, as sent (MSB first)
+	uint16_t crc() const { return ((uint16_t) this->frame[this->length - 2] << 8) | this->frame[this->length - 1]; }
+
+	const uint8_t * bytes() const { return this->frame; }			//the whole frame, STX to CRC
+	uint8_t size() const { return this->length; }					//length of the whole frame
+private:
+	const uint8_t * frame;											//!< First byte (STX) of the frame
+	uint8_t length;													//!< Frame length, STX to CRC inclusive
+
+	/**
+	 * Frame returned by a view with nothing to look at.  Shared by every view.
+	 */
+	static const uint8_t * empty() {
+		static const uint8_t frame[7] = { API_STX, 0, 0, 0, 0, 0, 0 };
+		return frame;
+	}
+};
+
+#endif /* VN210FRAMEVIEW_H_ */
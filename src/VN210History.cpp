@@ -0,0 +1,162 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210History.h"
+
+#if VN210_HISTORY_LENGTH
+
+/**
+ * Class constructor.  Starts with an empty ring in RAM.
+ */
+VN210History::VN210History() {
+	this->storage = &this->ram;
+	this->nextSequence = 0;
+	this->clear();
+}
+
+/**
+ * Keeps the ring in 'storage' from now on, or in RAM if NULL.  If the storage
+ * already holds a ring of the same length, e.g. EEPROM from before a reset, its
+ * entries and sequence numbers carry on.  Otherwise the ring starts empty.
+ */
+void VN210History::setStorage(VN210HistoryStorage * storage) {
+	uint8_t state[VN210_HISTORY_STATE_SIZE];
+
+	this->storage = storage != NULL ? storage : &this->ram;
+	this->storage->read(0, state, sizeof(state));
+
+	if (state[0] == VN210_HISTORY_STATE_MARKER && state[1] == VN210_HISTORY_LENGTH
+			&& state[4] < VN210_HISTORY_LENGTH && state[5] <= VN210_HISTORY_LENGTH) {
+		this->nextSequence = ((uint16_t) state[2] << 8) | state[3];
+		this->nextSlot = state[4];
+		this->count = state[5];
+	} else {
+		this->clear();
+	}
+}
+
+/**
+ * Removes every entry.  Sequence numbers aren't reused, so the radio can tell
+ * the entries it asked for have gone.
+ */
+void VN210History::clear(void) {
+	this->nextSlot = 0;
+	this->count = 0;
+	this->saveState();
+}
+
+/**
+ * Adds an entry for register 'id' with the given values, e.g. those of a
+ * SCADARegister just before it is reset.  The timestamp is the application's,
+ * e.g. seconds since boot.
+ */
+void VN210History::add(uint32_t time, uint8_t id, float average, float minimum, float maximum, uint16_t count) {
+	uint8_t entry[VN210_HISTORY_ENTRY_SIZE];
+
+	entry[0] = this->nextSequence >> 8;
+	entry[1] = this->nextSequence & 0xFF;
+	VN210BigEndian::put(time, &entry[2]);
+	entry[6] = id;
+	VN210FloatCodec::encode(average, &entry[7]);
+	VN210FloatCodec::encode(minimum, &entry[11]);
+	VN210FloatCodec::encode(maximum, &entry[15]);
+	entry[19] = count >> 8;
+	entry[20] = count & 0xFF;
+
+	this->storage->write(this->slotOffset(this->nextSlot), entry, sizeof(entry));
+
+	//the entry is in place before the state says so
+	this->nextSequence++;
+	if (++this->nextSlot == VN210_HISTORY_LENGTH) this->nextSlot = 0;
+	if (this->count < VN210_HISTORY_LENGTH) this->count++;
+
+	this->saveState();
+}
+
+/**
+ * Writes the reply to a history read to 'out', which must hold
+ * VN210_HISTORY_TRANSFER_SIZE bytes: the header, then the entries from sequence
+ * number 'since' onwards, or from the oldest entry held if 'since' has been
+ * overwritten.  At most 'maxEntries' are written; 0 means no limit.  Returns the
+ * payload length.
+ */
+uint16_t VN210History::read(uint16_t since, uint8_t maxEntries, uint8_t * out) {
+	//entries held are numbered nextSequence - count to nextSequence - 1. wrapping arithmetic.
+	uint16_t wanted = this->nextSequence - since;
+	uint8_t available = wanted < this->count ? wanted : this->count;
+	uint8_t entries = (maxEntries != 0 && available > maxEntries) ? maxEntries : available;
+
+	uint8_t slot = (this->nextSlot + VN210_HISTORY_LENGTH - available) % VN210_HISTORY_LENGTH;
+	uint8_t * ptr = out + VN210_HISTORY_HEADER_SIZE;
+
+	out[0] = this->nextSequence >> 8;
+	out[1] = this->nextSequence & 0xFF;
+	out[2] = entries;
+
+	for (uint8_t i = 0; i < entries; i++) {
+		this->storage->read(this->slotOffset(slot), ptr, VN210_HISTORY_ENTRY_SIZE);
+		ptr += VN210_HISTORY_ENTRY_SIZE;
+
+		if (++slot == VN210_HISTORY_LENGTH) slot = 0;
+	}
+
+	return ptr - out;
+}
+
+/**
+ * Returns the sequence number the next entry will be given.
+ */
+uint16_t VN210History::getNextSequence(void) {
+	return this->nextSequence;
+}
+
+/**
+ * Returns the number of entries held.
+ */
+uint8_t VN210History::getCount(void) {
+	return this->count;
+}
+
+/**
+ * Writes the ring state to the start of the storage.
+ */
+void VN210History::saveState(void) {
+	uint8_t state[VN210_HISTORY_STATE_SIZE];
+
+	state[0] = VN210_HISTORY_STATE_MARKER;
+	state[1] = VN210_HISTORY_LENGTH;
+	state[2] = this->nextSequence >> 8;
+	state[3] = this->nextSequence & 0xFF;
+	state[4] = this->nextSlot;
+	state[5] = this->count;
+
+	this->storage->write(0, state, sizeof(state));
+}
+
+/**
+ * Returns the storage offset of entry slot 'slot'.
+ */
+uint16_t VN210History::slotOffset(uint8_t slot) {
+	return VN210_HISTORY_STATE_SIZE + (uint16_t) slot * VN210_HISTORY_ENTRY_SIZE;
+}
+
+#endif
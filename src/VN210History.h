@@ -0,0 +1,145 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210Config.h"
+#include "VN210Schema.h"
+#include "VN210Segment.h"
+#include <stdint.h>
+#include <string.h>
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#endif
+
+#ifndef VN210HISTORY_H_
+#define VN210HISTORY_H_
+
+// History entry, as stored and sent: sequence number (2), timestamp (4), register ID (1),
+// average (4), minimum (4), maximum (4) and sample count (2).  Multi-byte fields MSB first.
+#define VN210_HISTORY_ENTRY_SIZE 21
+
+// History read payload header: sequence number of the next entry to be added (2), entries that follow (1)
+#define VN210_HISTORY_HEADER_SIZE 3
+
+// Largest history read payload: the header and every entry
+#define VN210_HISTORY_TRANSFER_SIZE (VN210_HISTORY_HEADER_SIZE + VN210_HISTORY_LENGTH * VN210_HISTORY_ENTRY_SIZE)
+
+// Ring state kept at the start of the storage: marker (1), ring length (1), next sequence number (2), next slot (1), entry count (1)
+#define VN210_HISTORY_STATE_SIZE 6
+#define VN210_HISTORY_STATE_MARKER 0xA5
+
+// Bytes of storage used by the ring
+#define VN210_HISTORY_STORAGE_SIZE (VN210_HISTORY_STATE_SIZE + VN210_HISTORY_LENGTH * VN210_HISTORY_ENTRY_SIZE)
+
+#if VN210_HISTORY_TRANSFER_SIZE > VN210_SEGMENT_MAX_FRAGMENTS * VN210_SEGMENT_DATA_SIZE
+#error VN210_HISTORY_LENGTH is too large: the whole history must fit in one segmented transfer
+#endif
+
+/**
+ * Where the history ring is kept.  Byte addressed, from 0 to VN210_HISTORY_STORAGE_SIZE - 1.
+ */
+class VN210HistoryStorage {
+public:
+	virtual void read(uint16_t offset, uint8_t * out, uint8_t length) = 0;			//copies 'length' bytes from 'offset' to 'out'
+	virtual void write(uint16_t offset, const uint8_t * in, uint8_t length) = 0;	//copies 'length' bytes from 'in' to 'offset'
+};
+
+/**
+ * History ring in RAM.  Lost on reset.
+ */
+class VN210HistoryRAM : public VN210HistoryStorage {
+public:
+	void read(uint16_t offset, uint8_t * out, uint8_t length) { memcpy(out, this->bytes + offset, length); }
+	void write(uint16_t offset, const uint8_t * in, uint8_t length) { memcpy(this->bytes + offset, in, length); }
+private:
+	uint8_t bytes[VN210_HISTORY_STORAGE_SIZE];						//!< Ring state and entries
+};
+
+#if defined(__AVR__)
+/**
+ * History ring in the AVR's EEPROM, starting at 'address', so it survives a reset
+ * or power cut.  Only bytes which change are written, but every add() rewrites
+ * an entry and the ring state, so size the ring and the rate of adds with the
+ * EEPROM's write endurance in mind.
+ */
+class VN210HistoryEEPROM : public VN210HistoryStorage {
+public:
+	VN210HistoryEEPROM(uint16_t address) : address(address) {}
+
+	void read(uint16_t offset, uint8_t * out, uint8_t length) { eeprom_read_block(out, (const void *) (size_t) (this->address + offset), length); }
+	void write(uint16_t offset, const uint8_t * in, uint8_t length) { eeprom_update_block(in, (void *) (size_t) (this->address + offset), length); }
+private:
+	uint16_t address;												//!< EEPROM address of the ring state
+};
+#endif
+
+/**
+ * Fixed-size ring of timestamped SCADA register snapshots, so that values
+ * recorded while the wireless network is down can be fetched by the radio once
+ * it is back, rather than lost.
+ *
+ * The application adds the register's average, minimum, maximum and sample count
+ * before resetting it for the next window.  Each entry gets the next sequence
+ * number.  When the ring is full, the oldest entry is overwritten.
+ *
+ * The radio fetches entries with a HISTORY_READ_REQUEST pass-through message
+ * holding the sequence number of the first entry it wants (2 bytes, MSB first)
+ * and, optionally, the most entries to send (1 byte).  The reply is a segmented
+ * transfer (see VN210Segment.h) of a header giving the sequence number the next
+ * entry will get and the number of entries, followed by the entries, oldest
+ * first.  If entries have been overwritten, the first one sent has a later
+ * sequence number than asked for, and the difference is the number lost.  The
+ * radio asks again from the header's sequence number next time.
+ *
+ * Entries are stored in the format they are sent in, in RAM by default, or in
+ * EEPROM with setStorage().
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup SimpleAPI
+ */
+class VN210History {
+public:
+	VN210History();
+
+	void setStorage(VN210HistoryStorage * storage);					//moves the ring, restoring any history kept there. NULL is RAM
+	void clear(void);												//removes every entry.  sequence numbers carry on
+
+	//adds a snapshot of a SCADA register, overwriting the oldest entry if the ring is full
+	void add(uint32_t time, uint8_t id, float average, float minimum, float maximum, uint16_t count);
+
+	//writes the history read payload for entries from 'since', at most 'maxEntries' of them. returns its length.
+	uint16_t read(uint16_t since, uint8_t maxEntries, uint8_t * out);
+
+	uint16_t getNextSequence(void);									//returns the sequence number the next entry will get
+	uint8_t getCount(void);											//returns the number of entries held
+private:
+	VN210HistoryRAM ram;											//!< Default storage
+	VN210HistoryStorage * storage;									//!< Storage in use
+	uint16_t nextSequence;											//!< Sequence number of the next entry added
+	uint8_t nextSlot;												//!< Slot the next entry goes in
+	uint8_t count;													//!< Number of entries held
+
+	void saveState(void);											//writes the ring state to storage
+	uint16_t slotOffset(uint8_t slot);								//returns the storage offset of a slot
+};
+
+#endif /* VN210HISTORY_H_ */
@@ -0,0 +1,144 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210LinkMonitor.h"
+
+#if VN210_LINK_MISSED_POLLS
+
+/**
+ * Class constructor.  The expected interval isn't known until it is set or learnt.
+ */
+VN210LinkMonitor::VN210LinkMonitor() {
+	this->expectedInterval = 0;
+	this->resetCounters();
+	this->restart();
+}
+
+/**
+ * Forgets the time of the last poll.  The next call to poll() or resetDue()
+ * starts timing again, so the time spent e.g. in setup() isn't taken as silence.
+ */
+void VN210LinkMonitor::restart(void) {
+	this->started = false;
+	this->polled = false;
+	this->backingOff = false;
+}
+
+/**
+ * Sets the interval between polls the radio has been asked for, in milliseconds.
+ */
+void VN210LinkMonitor::setExpectedInterval(uint32_t interval) {
+	this->expectedInterval = interval;
+	if (!this->backingOff) this->wait = this->silenceAllowed();
+}
+
+/**
+ * Returns the interval between polls expected, in milliseconds, or 0 if it
+ * hasn't been set or learnt yet.
+ */
+uint32_t VN210LinkMonitor::getExpectedInterval(void) {
+	return this->expectedInterval;
+}
+
+/**
+ * Records a poll from the radio at time 'now', adding the interval since the
+ * last one to the histogram.  Ends any reset backoff.
+ */
+void VN210LinkMonitor::poll(uint32_t now) {
+	if (this->polled) {
+		uint32_t interval = now - this->lastPoll;
+
+		if (this->expectedInterval == 0) this->expectedInterval = interval;
+
+		if (this->expectedInterval != 0) {
+			uint32_t quarters = (interval * 4) / this->expectedInterval;
+			uint8_t bin = quarters < VN210_LINK_HISTOGRAM_BINS ? quarters : VN210_LINK_HISTOGRAM_BINS - 1;
+
+			if (this->histogram[bin] != 0xFFFF) this->histogram[bin]++;
+
+			//an interval of 1.5 or more expected intervals means polls were missed. round to the nearest whole number.
+			uint32_t intervals = (interval + this->expectedInterval / 2) / this->expectedInterval;
+			uint32_t missed = intervals > 1 ? intervals - 1 : 0;
+			this->missedPolls = missed > (uint32_t) (0xFFFF - this->missedPolls) ? 0xFFFF : this->missedPolls + missed;
+		}
+
+		if (interval > this->maxInterval) this->maxInterval = interval;
+	}
+
+	if (this->polls != 0xFFFF) this->polls++;
+
+	this->lastPoll = now;
+	this->started = true;
+	this->polled = true;
+	this->backingOff = false;
+	this->wait = this->silenceAllowed();
+}
+
+/**
+ * Returns true if the radio hasn't polled for VN210_LINK_MISSED_POLLS expected
+ * intervals, or for the backoff wait since the last reset.  The caller should
+ * reset the radio straight away: the wait before the next reset starts now and
+ * is twice as long.
+ */
+bool VN210LinkMonitor::resetDue(uint32_t now) {
+	if (!this->started) {
+		this->lastPoll = now;
+		this->wait = this->silenceAllowed();
+		this->started = true;
+		return false;
+	}
+
+	if (now - this->lastPoll < this->wait) return false;
+
+	this->lastPoll = now;
+	this->polled = false;		//the interval across a reset isn't a poll interval
+	this->resets++;
+
+	this->backingOff = true;
+	this->wait = this->wait > VN210_LINK_MAX_BACKOFF_MS / 2 ? VN210_LINK_MAX_BACKOFF_MS : this->wait * 2;
+
+	return true;
+}
+
+/**
+ * Clears the histogram, poll, missed poll and reset counters, and the longest interval.
+ */
+void VN210LinkMonitor::resetCounters(void) {
+	for (uint8_t i = 0; i < VN210_LINK_HISTOGRAM_BINS; i++) this->histogram[i] = 0;
+
+	this->polls = 0;
+	this->missedPolls = 0;
+	this->resets = 0;
+	this->maxInterval = 0;
+}
+
+/**
+ * Returns the silence allowed before the radio is first reset: VN210_LINK_MISSED_POLLS
+ * expected intervals, assuming the slowest polling frequency if it isn't known.
+ */
+uint32_t VN210LinkMonitor::silenceAllowed(void) {
+	uint32_t interval = this->expectedInterval != 0 ? this->expectedInterval : VN210_LINK_SLOWEST_INTERVAL_MS;
+
+	return interval * VN210_LINK_MISSED_POLLS;
+}
+
+#endif
@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210Config.h"
+#include <stdint.h>
+
+#ifndef VN210LINKMONITOR_H_
+#define VN210LINKMONITOR_H_
+
+// Poll interval histogram bins, each a quarter of the expected interval wide.  The last bin holds everything longer.
+#define VN210_LINK_HISTOGRAM_BINS 8
+
+// Expected interval assumed until the polling frequency is set or learnt: the slowest the radio polls.
+#define VN210_LINK_SLOWEST_INTERVAL_MS 60000UL
+
+/**
+ * Watches the radio's polling messages, so that a radio which has stopped
+ * polling is noticed and reset, and erratic polling shows up in a histogram.
+ *
+ * Each poll interval is added to a histogram scaled to the expected interval:
+ * bin i counts intervals from i / 4 up to (i + 1) / 4 of the expected interval,
+ * so a steady radio fills bins 3 and 4, and late polls land further up.  The
+ * expected interval is set from the polling frequency requested of the radio,
+ * or taken from the first interval seen if it has never been set.
+ *
+ * When nothing has been heard for VN210_LINK_MISSED_POLLS expected intervals,
+ * resetDue() reports that the radio should be reset.  If it still doesn't poll,
+ * the wait before the next reset doubles each time, up to
+ * VN210_LINK_MAX_BACKOFF_MS, so a radio which is merely out of range isn't
+ * reset over and over.  The first poll afterwards ends the backoff.  The wait
+ * must be longer than the radio takes to start polling after a reset (about 5 s).
+ *
+ * The monitor does not read a clock itself.  The current time in milliseconds
+ * is passed in by the caller, e.g. using millis() on Arduino.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup SimpleAPI
+ */
+class VN210LinkMonitor {
+public:
+	VN210LinkMonitor();
+
+	void restart(void);												//starts timing again from the next call, e.g. after the radio is reset
+	void setExpectedInterval(uint32_t interval);					//sets the poll interval expected, in ms
+	uint32_t getExpectedInterval(void);								//returns the poll interval expected, in ms. 0 until set or learnt
+	void poll(uint32_t now);										//records a poll from the radio
+	bool resetDue(uint32_t now);									//true if the radio has been silent for too long and should be reset now
+	void resetCounters(void);										//clears the histogram and counters
+
+	uint16_t histogram[VN210_LINK_HISTOGRAM_BINS];					//!< Poll intervals, in quarters of the expected interval
+	uint16_t polls;													//!< Polls seen
+	uint16_t missedPolls;											//!< Polls which should have been seen between those that were
+	uint16_t resets;												//!< Radio resets asked for
+	uint32_t maxInterval;											//!< Longest interval between polls, in ms
+private:
+	uint32_t expectedInterval;										//!< Poll interval expected, in ms.  0 if not known
+	uint32_t lastPoll;												//!< Time of the last poll, or of the last reset
+	uint32_t wait;													//!< Silence allowed since lastPoll before the radio is reset, in ms
+	bool started;													//!< Set once lastPoll holds a time
+	bool polled;													//!< Set once a poll has been seen since the last restart
+	bool backingOff;												//!< Set from a reset until the next poll, while the wait doubles
+
+	uint32_t silenceAllowed(void);									//returns the silence allowed before the first reset
+};
+
+#endif /* VN210LINKMONITOR_H_ */
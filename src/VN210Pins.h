@@ -0,0 +1,136 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "spi_helper.h"
+#include <avr/io.h>
+#include <stdint.h>
+
+#ifndef VN210PINS_H_
+#define VN210PINS_H_
+
+/**
+ * Compile-time pin assignments for the Arduino transport, driven through the
+ * port registers directly.
+ *
+ * Each pin is a VN210Pin type naming its port and bit, so setting or clearing
+ * it compiles down to a single sbi / cbi instruction rather than a call to
+ * digitalWrite() and its pin table lookups.  The defaults match the original
+ * VN210 shield on an ATmega328P Arduino:
+ *
+ *  - WKU on pin 9 (PB1)
+ *  - RESET on pin 7 (PD7)
+ *  - PROVISIONING on pin 6 (PD6)
+ *  - BOOT on pin 5 (PD5)
+ *
+ * The radio's RDY line (pin 8 on the shield) isn't used by the transport.  For a
+ * different pinout, edit the defaults below or override them with -D flags, e.g.
+ * -DVN210_WKU_PIN="VN210Pin<VN210PortD, 2>".  Pins which clash with the SPI
+ * pins in spi_helper.h, or with each other, fail to compile.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Arduino
+ * @ingroup Headers
+ */
+
+/**
+ * AVR I/O ports.  ID is the port letter, used to check pin assignments.
+ */
+struct VN210PortB {
+	enum { ID = 'B' };
+	static volatile uint8_t & port() { return PORTB; }
+	static volatile uint8_t & ddr() { return DDRB; }
+};
+
+struct VN210PortC {
+	enum { ID = 'C' };
+	static volatile uint8_t & port() { return PORTC; }
+	static volatile uint8_t & ddr() { return DDRC; }
+};
+
+struct VN210PortD {
+	enum { ID = 'D' };
+	static volatile uint8_t & port() { return PORTD; }
+	static volatile uint8_t & ddr() { return DDRD; }
+};
+
+/**
+ * Output pin BIT of PORT.
+ */
+template <class PORT, uint8_t BIT>
+struct VN210Pin {
+	enum { PORT_ID = PORT::ID, BIT_NUMBER = BIT };
+
+	static void output() { PORT::ddr() |= _BV(BIT); }
+	static void high() { PORT::port() |= _BV(BIT); }
+	static void low() { PORT::port() &= (uint8_t) ~_BV(BIT); }
+	static void write(bool level) { if (level) high(); else low(); }
+};
+
+#ifndef VN210_WKU_PIN
+#define VN210_WKU_PIN VN210Pin<VN210PortB, 1>				//!< Pulsed to wake the radio.  Arduino pin 9.
+#endif
+
+#ifndef VN210_RESET_PIN
+#define VN210_RESET_PIN VN210Pin<VN210PortD, 7>				//!< Held low to reset the radio.  Arduino pin 7.
+#endif
+
+#ifndef VN210_PROVISIONING_PIN
+#define VN210_PROVISIONING_PIN VN210Pin<VN210PortD, 6>		//!< Held low to provision the radio.  Arduino pin 6.
+#endif
+
+#ifndef VN210_BOOT_PIN
+#define VN210_BOOT_PIN VN210Pin<VN210PortD, 5>				//!< Selects the firmware the radio boots.  Arduino pin 5.
+#endif
+
+/**
+ * value is true if PIN is one of the SPI pins, which spi_helper.h puts on port B.
+ */
+template <class PIN>
+struct VN210IsSPIPin {
+	enum { value = PIN::PORT_ID == 'B' && (PIN::BIT_NUMBER == SPI_SS_PIN || PIN::BIT_NUMBER == SPI_SCK_PIN
+			|| PIN::BIT_NUMBER == SPI_MOSI_PIN || PIN::BIT_NUMBER == SPI_MISO_PIN) };
+};
+
+/**
+ * value is true if A and B are the same pin.
+ */
+template <class A, class B>
+struct VN210IsSamePin {
+	enum { value = (int) A::PORT_ID == (int) B::PORT_ID && (int) A::BIT_NUMBER == (int) B::BIT_NUMBER };
+};
+
+//fails to compile, with 'message' in the error, unless 'condition' is true. wrap conditions containing commas in brackets.
+#define VN210_STATIC_CHECK(condition, message) typedef char message[(condition) ? 1 : -1]
+
+VN210_STATIC_CHECK((!VN210IsSPIPin<VN210_WKU_PIN>::value), VN210_WKU_PIN_is_an_SPI_pin);
+VN210_STATIC_CHECK((!VN210IsSPIPin<VN210_RESET_PIN>::value), VN210_RESET_PIN_is_an_SPI_pin);
+VN210_STATIC_CHECK((!VN210IsSPIPin<VN210_PROVISIONING_PIN>::value), VN210_PROVISIONING_PIN_is_an_SPI_pin);
+VN210_STATIC_CHECK((!VN210IsSPIPin<VN210_BOOT_PIN>::value), VN210_BOOT_PIN_is_an_SPI_pin);
+
+VN210_STATIC_CHECK((!VN210IsSamePin<VN210_WKU_PIN, VN210_RESET_PIN>::value), VN210_WKU_PIN_and_VN210_RESET_PIN_clash);
+VN210_STATIC_CHECK((!VN210IsSamePin<VN210_WKU_PIN, VN210_PROVISIONING_PIN>::value), VN210_WKU_PIN_and_VN210_PROVISIONING_PIN_clash);
+VN210_STATIC_CHECK((!VN210IsSamePin<VN210_WKU_PIN, VN210_BOOT_PIN>::value), VN210_WKU_PIN_and_VN210_BOOT_PIN_clash);
+VN210_STATIC_CHECK((!VN210IsSamePin<VN210_RESET_PIN, VN210_PROVISIONING_PIN>::value), VN210_RESET_PIN_and_VN210_PROVISIONING_PIN_clash);
+VN210_STATIC_CHECK((!VN210IsSamePin<VN210_RESET_PIN, VN210_BOOT_PIN>::value), VN210_RESET_PIN_and_VN210_BOOT_PIN_clash);
+VN210_STATIC_CHECK((!VN210IsSamePin<VN210_PROVISIONING_PIN, VN210_BOOT_PIN>::value), VN210_PROVISIONING_PIN_and_VN210_BOOT_PIN_clash);
+
+#endif /* VN210PINS_H_ */
@@ -29,6 +29,19 @@
  * communication with the VN210.
  */
 void VN210RxTx::begin() {
+#if VN210_SHARED_BUFFER
+	rxBuff.bytes = sharedBytes;
+	txBuff.bytes = sharedBytes;
+#endif
+	this->packing = false;
+	this->interruptReply = false;
+	this->deferred = false;
+	this->framingErrors = 0;
+	this->droppedBytes = 0;
+	this->interruptHandler = NULL;
+	this->wakeupPending = false;
+	this->txSequence = 0;
+
 	this->resetTransmitBuffer();
 	this->resetReceiveBuffer();
 
@@ -45,9 +58,84 @@ void VN210RxTx::begin() {
  * are sent from this buffer at the same time as the VN210 sends a message as
  * the VN210 is the SPI master, and therefore clocks both the MOSI and MISO
  * SPI lines.
+ *
+ * In wakeup mode, request messages (response bit clear) also ask for the radio
+ * to be woken, so it polls for the message rather than waiting for its polling
+ * schedule.  The WKU pulse itself is sent by serviceWakeup().
+ *
+ * Returns false, and sends nothing, if the escaped message is too long for
+ * the transmit buffer, or if a reply packed by sendMsgFromInterrupt() is still
+ * waiting to go.  The reply is left alone in the second case, and wasDeferred()
+ * returns true: send again once hasMessageToSend() returns false.
  */
-void VN210RxTx::sendMsg(VN210_APIMessage* msg) {
+bool VN210RxTx::sendMsg(VN210_APIMessage* msg) {
+	//claim the buffer before looking at it. the interrupt can't pack a reply once packing
+	//is set, but may have packed one since the caller last checked.
+	this->packing = true;
+	this->deferred = this->interruptReply && this->hasMessageToSend();
+
+	if (this->deferred) {
+		this->packing = false;
+		return false;
+	}
+
+	if (!this->packMsg(msg)) {
+		return false;
+	}
+
+	//requests need the radio to poll for them. responses go out in the exchange the radio is already waiting on.
+	if (!(msg->header & 0x08)) {
+		this->requestWakeup();
+	}
+
+	return true;
+}
+
+/**
+ * Packs a reply from an interrupt handler (see registerInterruptHandler()).  The
+ * radio is not signalled: the reply goes out while it is still clocking the
+ * exchange that carried the request.
+ *
+ * Returns false if the main loop is packing or waiting to send a message of its
+ * own, or if the message doesn't fit.  The transmit buffer is left alone in the
+ * first case.
+ */
+bool VN210RxTx::sendMsgFromInterrupt(VN210_APIMessage* msg) {
+	if (this->packing || this->hasMessageToSend()) {
+		return false;
+	}
+
+	if (!this->packMsg(msg)) {
+		return false;
+	}
+
+	this->interruptReply = true;
+	return true;
+}
+
+/**
+ * Returns true if the last call to sendMsg() returned false because a reply
+ * packed by sendMsgFromInterrupt() hadn't been sent yet, rather than because
+ * the message didn't fit.
+ */
+bool VN210RxTx::wasDeferred(void) {
+	return this->deferred;
+}
+
+/**
+ * Packs a message into the transmit buffer, escaping it and adding the CRC.
+ *
+ * Returns false, leaving the transmit buffer empty, if the escaped message is
+ * too long for the buffer.
+ */
+bool VN210RxTx::packMsg(VN210_APIMessage* msg) {
+	//stop the SPI interrupt from sending (or, with a shared buffer, receiving into) a half-packed buffer
+	this->packing = true;
+	this->txOverflow = false;
+	this->interruptReply = false;
+
 	this->resetTransmitBuffer();
+	this->txSequence++;
 	uint16_t crc = VN210_CRC_INITIAL_VALUE;
 
 	//add next byte to the tx buffer and update CRC
@@ -67,17 +155,28 @@ void VN210RxTx::sendMsg(VN210_APIMessage* msg) {
 	addToTxBuffer(msg->crc.bytes[1]);
 	addToTxBuffer(msg->crc.bytes[0]);
 
-	//if using wakeup mode, signal to the VN210 that we have a packet to send.
-	this->wakeupRadio();
+	if (this->txOverflow) {
+		this->resetTransmitBuffer();		//drop the message rather than send a truncated frame
+		this->packing = false;
+		return false;
+	}
+
+	this->packing = false;
+
+	return true;
 }
 
 /**
  * Adds a byte to the transmit buffer, escaping it if necessary.  The unescaped byte
  * is returned as-is so it can be CRC'd.  NOTE: don't add the first STX character
  * using this method - it should not be escaped!
+ *
+ * If the byte doesn't fit, the overflow flag is set and the byte is discarded.
  */
 uint8_t VN210RxTx::addToTxBuffer(uint8_t b) {
-	if (b == API_STX) {
+	if (txBuff.byteCount > VN210_BUFFER_SIZE - 2) {			//room for an escaped pair?
+		this->txOverflow = true;
+	} else if (b == API_STX) {
 		txBuff.bytes[txBuff.byteCount++] = API_CHX;			//return the escaped char
 		txBuff.bytes[txBuff.byteCount++] = 0x0E;				//add the escaped char
 	} else if (b == API_CHX) {
@@ -91,46 +190,80 @@ uint8_t VN210RxTx::addToTxBuffer(uint8_t b) {
 }
 
 /**
- * Parses a message from the receive buffer, copying the buffer contents into
- * the response frame.
+ * Checks the CRC of the received frame.  If it's valid, the registered view is
+ * pointed at the frame and the frame is held in the receive buffer until
+ * releaseMessage() is called.  Nothing is copied.  A frame with a bad CRC is
+ * discarded straight away.
+ *
+ * Returns true if the CRC was valid.
  */
 bool VN210RxTx::parseMessage() {
-	//pull the CRC out of the message. MSB first.
-	rxMessage->crc.bytes[0] = rxBuff.bytes[rxBuff.byteCount - 1];
-	rxMessage->crc.bytes[1] = rxBuff.bytes[rxBuff.byteCount - VN210_CRC_SIZE];
-
-	//calculate the CRC from the payload
-	uint16_t crc = VN210_CRC_INITIAL_VALUE;
-	for (int i = 1; i < rxBuff.byteCount - 2; i++) {
-		crc = _crc_xmodem_update(crc, rxBuff.bytes[i]);
+	if (rxState != RX_READY) {
+		return false;
 	}
 
-	bool crcIsValid = (rxMessage->crc.value == crc);
+	//the interrupt leaves the buffer alone in RX_READY, so it can be read without volatile
+	VN210FrameView frame((const uint8_t *) rxBuff.bytes, rxBuff.byteCount);
+
+	bool crcIsValid = isCrcValid(frame);
 
 	if (crcIsValid) {
-		rxBuff.idx = 0;		//reset the buffer index
+		*this->rxFrame = frame;
+		*this->hasNewMessageForAPI = false;
+	} else {
+		this->resetReceiveBuffer();
+	}
+
+	return crcIsValid;
+}
 
-		//iterate through the receive buffer byte by byte
-		//See 3.1.3 for the API message format.
+/**
+ * Returns true if the CRC at the end of the frame matches the CRC calculated over
+ * the header, type, ID, size and data bytes.
+ */
+bool VN210RxTx::isCrcValid(const VN210FrameView & frame) {
+	const uint8_t * bytes = frame.bytes();
+	uint16_t crc = VN210_CRC_INITIAL_VALUE;
 
-		rxMessage->STX = rxBuff.bytes[rxBuff.idx++];
-		rxMessage->header = rxBuff.bytes[rxBuff.idx++];
-		rxMessage->messageType = rxBuff.bytes[rxBuff.idx++];
-		rxMessage->messageID = rxBuff.bytes[rxBuff.idx++];
-		rxMessage->dataSize = rxBuff.bytes[rxBuff.idx++];
-		rxMessage->data = &rxBuff.bytes[rxBuff.idx];		//response data points to the receive buffer
+	for (uint8_t i = 1; i < frame.size() - VN210_CRC_SIZE; i++) {
+		crc = _crc_xmodem_update(crc, bytes[i]);
 	}
 
-	this->resetReceiveBuffer();
+	return crc == frame.crc();
+}
 
-	return crcIsValid;
+/**
+ * Releases the frame held by parseMessage(), so the receive buffer can take the
+ * next frame.  The registered view is emptied.  Does nothing if no frame is held.
+ */
+void VN210RxTx::releaseMessage() {
+	if (rxState == RX_READY && !*this->hasNewMessageForAPI) {
+		*this->rxFrame = VN210FrameView();
+		this->resetReceiveBuffer();
+	}
 }
 
 /**
  * Handles the received byte, putting it into the receive buffer and dealing with
  * escape characters.
  *
- * Parses the message when the entire frame has been received.
+ * Frames are decoded by a state machine: RX_HUNT waits for a start character,
+ * RX_HEADER collects the header, type, ID and size bytes, RX_PAYLOAD counts down
+ * the declared number of data bytes and RX_CRC the two CRC bytes.  The API is told
+ * about the frame as soon as its last byte arrives, and the frame is held in
+ * RX_READY until it has been parsed and released by the API.  Every byte received
+ * while a frame is held is dropped, escapes included: the frame view points into
+ * the receive buffer, so nothing may start a new frame over it.  Dropped bytes
+ * other than start characters are counted in droppedBytes, as they are part of
+ * a frame the application has missed.  The STX flood sent while the radio reads
+ * a reply is not counted.
+ *
+ * A start character always begins a new frame.  Each further start character in
+ * a run is recognised from the decoder state and returns without writing to the
+ * buffer, though it still takes a few loads and comparisons.  Inside a frame, a
+ * size byte too big for the buffer or an invalid escape sequence abandons the
+ * frame straight away and the decoder waits for the next start character,
+ * rather than filling the buffer with junk.
  *
  * NOTE: If the RF processor detects a valid incoming message in progress
  * (from the application processor), it will keep sending the STX character
@@ -139,38 +272,170 @@ bool VN210RxTx::parseMessage() {
  * See 3.1.3.2 for more info.
  */
 void VN210RxTx::receiveByte(uint8_t rxb) {
-	if (rxb == API_CHX) {					//if we see the escape character
-		rxBuff.escape = true;						//set the escape flag
-	} else {
-		//check for the start character to reset frame position. this aborts the packet.
-		if (rxb == API_STX || rxBuff.byteCount == VN210_BUFFER_SIZE) { 	//also reset if the buffer is full.
-			this->resetReceiveBuffer();
+	//a completed frame is held until it's parsed and released
+	if (rxState == RX_READY) {
+		if (rxb != API_STX) droppedBytes++;
+		return;
+	}
+
+	if (rxb == API_STX) {
+		//already at the start of a frame? nothing to do. this is the STX flood case.
+		if (rxState == RX_HEADER && rxBuff.byteCount == 1 && !rxBuff.escape) return;
+
+		rxBuff.byteCount = 0;
+		rxBuff.escape = false;
+		rxState = RX_HEADER;
+	} else if (rxb == API_CHX) {
+		if (rxBuff.escape) {						//two escapes in a row is never valid
+			this->resynchronise();
+		} else {
+			rxBuff.escape = true;
+		}
+		return;
+	} else if (rxBuff.escape) {						//previous char was an escape
+		rxBuff.escape = false;
+
+		//3.1.3.2 - special chars are ones-complemented if they immediately follow an escape
+		if (rxb == 0x0E) {							//if its 1s-complement of STX (0x0E), replace with STX
+			rxb = API_STX;
+		} else if (rxb == 0x0D) {					//if its 1s-complement of CHX (0x0D), replace with CHX
+			rxb = API_CHX;
+		} else {
+			this->resynchronise();
+			return;
+		}
+	}
+
+	if (rxState == RX_HUNT) return;
+
+#if VN210_SHARED_BUFFER
+	//the shared buffer holds the transmit frame until it has been clocked out. received
+	//bytes may only overwrite bytes which have already been sent.
+	if (this->packing || (txBuff.byteCount > 0 && rxBuff.byteCount >= txBuff.idx)) {
+		this->resynchronise();
+		return;
+	}
+#endif
+
+	rxBuff.bytes[rxBuff.byteCount++] = rxb;			//write the byte to the receive buffer
+
+	switch (rxState) {
+		case RX_HEADER:
+			if (rxBuff.byteCount == VN210_DATASIZE_FRAME_FIELD_INDEX + 1) {		//just received the size byte
+				if (rxb > VN210_BUFFER_SIZE - VN210_FRAME_SIZE_MINUS_DATA) {
+					this->resynchronise();
+				} else if (rxb == 0) {
+					rxState = RX_CRC;
+					rxRemaining = VN210_CRC_SIZE;
+				} else {
+					rxState = RX_PAYLOAD;
+					rxRemaining = rxb;
+				}
+			}
+			break;
+		case RX_PAYLOAD:
+			if (--rxRemaining == 0) {
+				rxState = RX_CRC;
+				rxRemaining = VN210_CRC_SIZE;
+			}
+			break;
+		case RX_CRC:
+			if (--rxRemaining == 0) {
+				rxState = RX_READY;
+				this->frameReceived();
+			}
+			break;
+	}
+}
+
+/**
+ * Decodes a block of received bytes, for transports which receive by DMA rather
+ * than a byte at a time.  The result is the same as calling receiveByte() for
+ * each byte, but bytes outside a frame and runs of payload bytes with nothing to
+ * unescape are handled without going through the state machine.
+ */
+void VN210RxTx::receiveBytes(const volatile uint8_t * bytes, uint16_t count) {
+	uint16_t i = 0;
+
+	while (i < count) {
+		if (!rxBuff.escape) {
+			if (rxState == RX_HUNT) {
+				//nothing but a start character matters between frames
+				while (i < count && bytes[i] != API_STX && bytes[i] != API_CHX) i++;
+				if (i == count) break;
+			}
+#if !VN210_SHARED_BUFFER
+			else if (rxState == RX_PAYLOAD) {
+				//copy all but the last payload byte straight in. receiveByte() moves on to the CRC.
+				uint8_t remaining = rxRemaining;
+				while (remaining > 1 && i < count && bytes[i] != API_STX && bytes[i] != API_CHX) {
+					rxBuff.bytes[rxBuff.byteCount++] = bytes[i++];
+					remaining--;
+				}
+				rxRemaining = remaining;
+				if (i == count) break;
+			}
+#endif
 		}
 
-		//not an escape char
-		if (rxBuff.escape == true) {				//previous char was an escape
-			rxBuff.escape = false;					//reset escape flag.
+		this->receiveByte(bytes[i++]);
+	}
+}
 
-			//3.1.3.2 - special chars are ones-complemented if they immediately follow an escape
-			if (rxb == 0x0E)						//if its 1s-complement of STX (0x0E), replace with STX
-				rxb = API_STX;
-			else if (rxb == 0x0D)					//if its 1s-complement of CHX (0x0D), replace with CHX
-				rxb = API_CHX;
+/**
+ * Writes the next 'count' bytes to send into 'out', for transports which send by
+ * DMA.  Once the message runs out, or if there is no message or one is being
+ * packed, the rest is padded with zeros.  The transmit buffer is reset once the
+ * whole message has been taken.
+ */
+void VN210RxTx::transmitBytes(volatile uint8_t * out, uint16_t count) {
+	uint16_t i = 0;
+
+	if (!this->packing) {
+		while (i < count && txBuff.idx < txBuff.byteCount) {
+			out[i++] = txBuff.bytes[txBuff.idx++];
 		}
 
-		rxBuff.bytes[rxBuff.byteCount++] = rxb;			//write the byte to the receive buffer
+		if ((txBuff.idx > 0) && (txBuff.idx == txBuff.byteCount)) this->resetTransmitBuffer();
 	}
 
-	//check whether we have an entire message yet.
-	if (rxBuff.byteCount >= VN210_FRAME_SIZE_MINUS_DATA) {	//if we have enough bytes to constitute a message
+	while (i < count) {
+		out[i++] = 0x00;
+	}
+}
 
-		//check how many data bytes there are to find how big the frame should be
-		if (rxBuff.byteCount == (rxBuff.bytes[VN210_DATASIZE_FRAME_FIELD_INDEX] + VN210_FRAME_SIZE_MINUS_DATA)) {
+/**
+ * Offers a complete frame to the interrupt handler, if there is one and the
+ * transmit buffer is free for a reply.  Frames the handler doesn't take are
+ * passed to the API.
+ */
+void VN210RxTx::frameReceived(void) {
+	if (this->interruptHandler != NULL && !this->packing && !this->hasMessageToSend()) {
+		//nothing else writes to the buffer in RX_READY
+		VN210FrameView frame((const uint8_t *) rxBuff.bytes, rxBuff.byteCount);
 
-			//inform the API that we have a new message via flag.
-			*this->hasNewMessageForAPI = true;
+		if (this->interruptHandler->handleFrameInInterrupt(this, frame)) {
+			this->resetReceiveBuffer();
+			return;
 		}
 	}
+
+	//inform the API that we have a new message via flag.
+	*this->hasNewMessageForAPI = true;
+}
+
+/**
+ * Abandons the frame being received after a framing error, and waits for the
+ * next start character.  Between frames there is nothing to abandon, so a stray
+ * escape there only clears the escape and isn't counted as an error.
+ */
+void VN210RxTx::resynchronise(void) {
+	rxBuff.escape = false;
+	if (rxState == RX_HUNT) return;
+
+	rxBuff.byteCount = 0;
+	rxState = RX_HUNT;
+	framingErrors++;
 }
 
 /**
@@ -181,6 +446,15 @@ void VN210RxTx::registerNewMessageFlag(bool * newMessageFlagPtr) {
 	this->hasNewMessageForAPI = newMessageFlagPtr;
 }
 
+/**
+ * Registers a handler which sees each complete frame in the receive interrupt
+ * and can answer it straight away, before the API is told about it.  Call this
+ * after begin(), which removes any registered handler.  Pass NULL to remove it.
+ */
+void VN210RxTx::registerInterruptHandler(VN210InterruptHandler * handler) {
+	this->interruptHandler = handler;
+}
+
 /**
  * Checks whether there is a message currently queued to send.  This enalbles
  * the API to determine whether an ACK should immediately be sent or whether
@@ -191,14 +465,47 @@ bool VN210RxTx::hasMessageToSend(void) {
 }
 
 /**
- * Resets the receive buffer.
+ * Takes back the packed message, as long as the radio hasn't started reading it
+ * and nothing has been packed since: 'sequence' is getTxSequence() as it was
+ * just after the message was sent.  Used to pre-empt a queued message with a
+ * more urgent one.
+ *
+ * Returns true if the transmit buffer was emptied.
+ */
+bool VN210RxTx::cancelMsg(uint8_t sequence) {
+	bool cancelled = false;
+
+	//hold off the SPI interrupt so it can't start clocking the frame out while we look at it
+	this->packing = true;
+
+	if (this->txSequence == sequence && txBuff.byteCount > 0 && txBuff.idx == 0) {
+		this->resetTransmitBuffer();
+		cancelled = true;
+	}
+
+	this->packing = false;
+
+	return cancelled;
+}
+
+/**
+ * Returns the number of messages packed into the transmit buffer, modulo 256.
+ * Tells a caller whether the buffer still holds the message it sent.
+ */
+uint8_t VN210RxTx::getTxSequence(void) {
+	return this->txSequence;
+}
+
+/**
+ * Resets the receive buffer, releasing any frame held for parsing.
  */
 void VN210RxTx::resetReceiveBuffer(void) {
 	rxBuff.idx = 0;
 	rxBuff.byteCount = 0;
 	rxBuff.escape = false;
-
 	*this->hasNewMessageForAPI = false;
+
+	rxState = RX_HUNT;		//last, as this hands the buffer back to the interrupt
 }
 
 /**
@@ -208,6 +515,8 @@ void VN210RxTx::resetTransmitBuffer(void) {
 	txBuff.idx = 0;
 	txBuff.byteCount = 0;
 	txBuff.escape = false;
+
+	this->wakeupPending = false;		//the message went out, or was replaced - either way there's nothing to wake the radio for
 }
 
 /**
@@ -216,3 +525,53 @@ void VN210RxTx::resetTransmitBuffer(void) {
 void VN210RxTx::wakeupViaHWEnabled(bool wakeupSupportEnabled) {
 	this->wakeupSupportEnabled = wakeupSupportEnabled;
 }
+
+/**
+ * Asks for the radio to be woken so that it polls straight away.  Requests made
+ * before the next serviceWakeup() are coalesced into a single WKU pulse, and a
+ * request is dropped if the radio polls for the message on its own first.
+ *
+ * Does nothing unless wakeup support is enabled: without it, the radio keeps to
+ * its polling schedule and WKU is never touched.
+ */
+void VN210RxTx::requestWakeup(void) {
+	if (this->wakeupSupportEnabled) {
+		this->wakeupPending = true;
+	}
+}
+
+/**
+ * Sends the WKU pulse if a wakeup has been requested.  Called from the main loop
+ * (VN210SimpleAPI::hasNewMessage() does this), never from the SPI interrupt, as
+ * the pulse takes a couple of milliseconds.
+ *
+ * Returns true if the radio was woken.
+ */
+bool VN210RxTx::serviceWakeup(void) {
+	if (!this->wakeupPending) {
+		return false;
+	}
+
+	this->wakeupPending = false;
+	this->wakeupRadio();
+
+	return true;
+}
+
+/**
+ * Returns true if no frame is being received or waiting for the API, and no
+ * wakeup is waiting to be sent, so the main loop has nothing to do for the
+ * transport until the next interrupt.  The radio pads its exchanges with start
+ * characters, so a start character on its own doesn't count as a frame.
+ */
+bool VN210RxTx::isIdle(void) {
+	bool receiving = rxState != RX_HUNT && !(rxState == RX_HEADER && rxBuff.byteCount <= 1);
+
+	return !receiving && !this->wakeupPending;
+}
+
+/**
+ * Default sleep: returns straight away.  See the declaration.
+ */
+void VN210RxTx::sleep(void) {
+}
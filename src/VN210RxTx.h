@@ -21,18 +21,62 @@
  */
 
 #include "VN210.h"
+#include "VN210Config.h"
+#include "VN210FrameView.h"
 #include <string.h>
+
+#if defined(__AVR__)
 #include <util/crc16.h>		//for data CRC
 #include <util/delay.h>
+#endif
 
 #ifndef VN210RxTx_H_
 #define VN210RxTx_H_
 
-//VN210 frame related things.
-#define VN210_BUFFER_SIZE 114	//matches max buffer size of VN210
+#if !defined(__AVR__)
+/**
+ * Portable version of the avr-libc CRC-CCITT (XMODEM) update, used when
+ * building for other architectures.
+ */
+static inline uint16_t _crc_xmodem_update(uint16_t crc, uint8_t data) {
+	crc ^= (uint16_t) data << 8;
+	for (uint8_t i = 0; i < 8; i++) {
+		crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+	}
+	return crc;
+}
+#endif
+
+//VN210 frame related things. VN210_BUFFER_SIZE is set in VN210Config.h
 #define VN210_DATASIZE_FRAME_FIELD_INDEX 4
 #define VN210_FRAME_SIZE_MINUS_DATA 7
 
+//largest payload which always fits the transmit buffer, even if every byte of the frame has to be escaped
+#define VN210_MAX_ESCAPED_DATA_SIZE (((VN210_BUFFER_SIZE - 1) / 2) - VN210_FRAME_SIZE_MINUS_DATA)
+
+class VN210RxTx;
+
+/**
+ * Handles selected frames in the receive interrupt, before the API sees them.
+ * Registered with VN210RxTx::registerInterruptHandler().
+ *
+ * This runs in interrupt context, so it must be short and must not wait on
+ * anything.  Replies are sent with VN210RxTx::sendMsgFromInterrupt().
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Lowlevel
+ */
+class VN210InterruptHandler {
+public:
+	/**
+	 * Called with each complete frame, whose CRC has not been checked yet.  Return
+	 * true if the frame has been dealt with, in which case it is dropped without
+	 * being passed to the API.
+	 */
+	virtual bool handleFrameInInterrupt(VN210RxTx * dl, const VN210FrameView & frame) = 0;
+};
+
 /**
  * Transport layer implementation for the SPI-based communication protocol
  * between a Nivis VN210 ISA100.11a radio and an microcontroller
@@ -55,24 +99,52 @@ class VN210RxTx {
 public:
 	void begin();													//!< Instantiates the library
 
-	void sendMsg(VN210_APIMessage* msg);							//!< Sends a message to the VN210 radio
-	bool parseMessage();											//!< Parses a message from the receive buffer
+	bool sendMsg(VN210_APIMessage* msg);							//!< Sends a message to the VN210 radio
+	bool sendMsgFromInterrupt(VN210_APIMessage* msg);				//!< Packs a reply from interrupt context, without signalling the radio
+	bool wasDeferred(void);											//!< Returns true if the last sendMsg() left an unsent interrupt reply alone rather than pack over it
+	bool parseMessage();											//!< Checks the received frame and points the registered view at it
+	void releaseMessage();											//!< Hands the receive buffer back to the interrupt once the API has finished with the frame
 	void registerNewMessageFlag(bool * newMessageFlagPtr);			//!< Registers a flag to set in the API when a new message is available
+	void registerInterruptHandler(VN210InterruptHandler * handler);	//!< Registers a handler for frames in the receive interrupt.  NULL to remove.
+
+	static bool isCrcValid(const VN210FrameView & frame);			//!< Returns true if the frame's CRC matches its contents
 
 	bool hasMessageToSend();										//!< Returns true if there is a message to send, false otherwise
+	bool cancelMsg(uint8_t sequence);								//!< Takes back a packed message the radio hasn't started reading
+	uint8_t getTxSequence(void);									//!< Returns the number of messages packed, modulo 256
 
 	void wakeupViaHWEnabled(bool wakeupSupportEnabled);				//!< Sets flag indicating whether hardware wakeup is enabled in the radio firmware.
+	void requestWakeup(void);										//!< Asks for the radio to be woken at the next serviceWakeup().  Ignored unless wakeup is enabled.
+	bool serviceWakeup(void);										//!< Pulses WKU if a wakeup has been requested.  Call from the main loop.
+	bool isIdle(void);												//!< Returns true if no frame is being received or waiting, and no wakeup is waiting
+
+	/**
+	 * Puts the processor to sleep until the next interrupt, in a mode which keeps
+	 * the SPI slave running so no byte from the radio is lost.  Returns straight
+	 * away if a frame has arrived since the caller last checked.
+	 *
+	 * The default does nothing, so sleeping is a busy wait.  Implementations
+	 * must check for the frame and enter sleep without an interrupt in between.
+	 */
+	virtual void sleep(void);
 
 	/**
 	 * Communications buffer implementation.  One of these
 	 * is used for both receiving and transmitting data.
 	 *
+	 * With VN210_SHARED_BUFFER enabled, the receive and transmit
+	 * buffers point at the same byte array.
+	 *
 	 * NOTE: you may see a compiler error as no explicit volatile
 	 * copy constructor is defined.  Try a different compiler as
 	 * this is not required.
 	 */
 	typedef struct {
+#if VN210_SHARED_BUFFER
+		uint8_t volatile * bytes;									//!< Pointer to the shared buffer byte array.
+#else
 		uint8_t bytes[VN210_BUFFER_SIZE];							//!< Buffer byte array.
+#endif
 		uint8_t byteCount;											//!< The number of bytes in the buffer.
 		uint8_t escape;												//!< Flag indicating whether the current byte is an escape (API_CHX) character.
 		uint8_t idx;												//!< Iterator used for reading data back out of the buffer
@@ -81,7 +153,10 @@ public:
 	volatile Buffer rxBuff;										 	//!< Receive buffer
 	volatile Buffer txBuff;											//!< Transmit buffer
 
-	VN210_APIMessage * rxMessage;									//!< Pointer to the receive message
+	VN210FrameView * rxFrame;										//!< Pointer to the view of the received frame
+
+	volatile uint16_t framingErrors;								//!< Number of frames abandoned because of a bad size byte or escape sequence
+	volatile uint16_t droppedBytes;									//!< Number of bytes other than start characters dropped because a frame was still held
 
 	//abstract method - architecture dependent
 
@@ -92,7 +167,8 @@ public:
 	 * use receiveByte(uint8) to read bytes into the receive buffer.
 	 *
 	 * This method must also reset the transmit buffer when a full message
-	 * has been sent.
+	 * has been sent, and must not send from the transmit buffer while
+	 * the packing flag is set.
 	 */
 	virtual void rxtx(void) = 0;
 
@@ -117,11 +193,46 @@ public:
 	virtual void provisionRadio() __attribute__ ((deprecated)) = 0;
 protected:
 	void receiveByte(uint8_t);										//!< Deals with the received byte, putting it into the rx frame.
+	void receiveBytes(const volatile uint8_t * bytes, uint16_t count);	//!< Decodes a block of received bytes, as receiveByte() would one at a time.
+	void transmitBytes(volatile uint8_t * out, uint16_t count);		//!< Takes the next bytes to send from the transmit buffer, padding with zeros.
 	void resetReceiveBuffer(void);									//!< Resets the receive buffer
 	void resetTransmitBuffer(void);									//!< Resets the transmit buffer
 	uint8_t addToTxBuffer(uint8_t b);								//!< Adds a byte to the transmit buffer, handling character escaping
+
+	volatile bool packing;											//!< Flag set while sendMsg() is filling the transmit buffer.  Nothing may be sent while set.
+
+	/**
+	 * Receive frame decoder states.  See receiveByte().
+	 */
+	enum RxState {
+		RX_HUNT,													//!< Waiting for a start character.
+		RX_HEADER,													//!< Receiving the header, type, ID and size bytes.
+		RX_PAYLOAD,													//!< Receiving the data bytes.
+		RX_CRC,														//!< Receiving the two CRC bytes.
+		RX_READY													//!< A complete frame is waiting to be parsed, or is held for the API. Other bytes are ignored.
+	};
+
+	volatile uint8_t rxState;										//!< Receive decoder state.  One of RxState.
 private:
+	uint8_t rxRemaining;											//!< Data or CRC bytes still to come in the current state
+
+	void resynchronise(void);										//!< Abandons the current frame after a framing error
+	void frameReceived(void);										//!< Hands a complete frame to the interrupt handler or the API
+	bool packMsg(VN210_APIMessage* msg);							//!< Packs a message into the transmit buffer
+
+	VN210InterruptHandler * interruptHandler;						//!< Handler for frames in the receive interrupt, or NULL
+
 	bool wakeupSupportEnabled;										//!< Flag indicating whether to use wakeup support
+	volatile bool wakeupPending;									//!< Flag set when the radio should be woken.  Cleared once the message has been sent.
+
+	bool txOverflow;												//!< Flag set if the message being packed doesn't fit in the transmit buffer
+	volatile bool interruptReply;									//!< Flag set when sendMsgFromInterrupt() packs a reply.  Cleared by the next pack.
+	bool deferred;													//!< Flag set if the last sendMsg() found an interrupt reply still waiting to go
+	volatile uint8_t txSequence;									//!< Incremented each time a message is packed, including from the interrupt
+
+#if VN210_SHARED_BUFFER
+	uint8_t volatile sharedBytes[VN210_BUFFER_SIZE];				//!< Byte array used by both the receive and transmit buffers
+#endif
 
 	bool * hasNewMessageForAPI;										//!< Pointer to new message flag, used by Simple API.
 
@@ -22,6 +22,7 @@
 
 #include "VN210RxTx_Arduino.h"
 #include "Arduino.h"
+#include <avr/sleep.h>
 
 //global instance of the VN210 rxtx layer. This is used
 //by the API implementation, and can also be called by the
@@ -39,21 +40,25 @@ VN210RxTx_Arduino VN210RxTx = VN210RxTx_Arduino();
  *
  * The BOOT pin should be set before the reset pin to ensure
  * that the correct firmware is loaded at boot time.
+ *
+ * Each level is written before the pin is made an output, so RESET and
+ * PROVISIONING never glitch low on the way.
  */
 void VN210RxTx_Arduino::initIO() {
-	pinMode(9, OUTPUT);
+	WakeupPin::low();
+	WakeupPin::output();
 
 	//ensure that ISA100.11a firmware is loaded at boot time.
-	pinMode(BOOT_PIN, OUTPUT);
-	digitalWrite(BOOT_PIN, BOOT_PIN_ISA100_FIRMWARE_BOOT);
+	BootPin::write(BOOT_PIN_ISA100_FIRMWARE_BOOT);
+	BootPin::output();
 
 	//set reset pin as output:high
-	pinMode(RESET_PIN, OUTPUT);
-	digitalWrite(RESET_PIN, HIGH);
+	ResetPin::high();
+	ResetPin::output();
 
 	//set the provisioning pin as output:high
-	pinMode(PROVISIONING_PIN, OUTPUT);
-	digitalWrite(PROVISIONING_PIN, HIGH);
+	ProvisioningPin::high();
+	ProvisioningPin::output();
 }
 
 /**
@@ -80,9 +85,9 @@ void VN210RxTx_Arduino::enable() {
  * Performs a soft-reset of the VN210 radio.
  */
 void VN210RxTx_Arduino::resetRadio() {
-	digitalWrite(RESET_PIN, LOW);
+	ResetPin::low();
 	delay(2);
-	digitalWrite(RESET_PIN, HIGH);
+	ResetPin::high();
 }
 
 /**
@@ -97,9 +102,36 @@ void VN210RxTx_Arduino::resetRadio() {
  * unconfigures the radio, so it shouldn't really be down to a method call.
  */
 void VN210RxTx_Arduino::provisionRadio() {
-	digitalWrite(PROVISIONING_PIN, LOW);
+	ProvisioningPin::low();
 	delay(VN210_PROVISIONING_DURATION_MS);
-	digitalWrite(PROVISIONING_PIN, HIGH);
+	ProvisioningPin::high();
+}
+
+/**
+ * Idles the CPU until the next interrupt: the SPI interrupt for a byte from the
+ * radio, or the Timer0 overflow which keeps millis() running, once a millisecond.
+ * Idle is the deepest sleep mode in which the SPI slave still clocks bytes in;
+ * in power-save and power-down the first bytes of an exchange would be lost.
+ *
+ * Interrupts are disabled for the check, and sleep_cpu() runs before any
+ * interrupt left pending by sei(), so a frame completing in between still
+ * wakes the CPU.
+ *
+ * Timer0 is left running, so millis() and micros() stay right but the CPU is
+ * woken about 1000 times a second even when nothing is due.  Stopping it would
+ * need millis() corrected on every wake from the time slept.
+ */
+void VN210RxTx_Arduino::sleep() {
+	set_sleep_mode(SLEEP_MODE_IDLE);
+
+	cli();
+	if (this->rxState != RX_READY) {
+		sleep_enable();
+		sei();
+		sleep_cpu();
+		sleep_disable();
+	}
+	sei();
 }
 
 /**
@@ -108,11 +140,11 @@ void VN210RxTx_Arduino::provisionRadio() {
  * See Section 2.3.1 of the VN210 Simple API documentation
  */
 void VN210RxTx_Arduino::wakeupRadio() {
-	digitalWrite(9, HIGH);
+	WakeupPin::high();
 
-	delay(2);
+	delay(WKU_PULSE_WIDTH_MS);
 
-	digitalWrite(9, LOW);
+	WakeupPin::low();
 }
 
 /**
@@ -127,11 +159,15 @@ void VN210RxTx_Arduino::wakeupRadio() {
 void VN210RxTx_Arduino::rxtx() {
 	uint8_t rxb;
 
-	//read and send the bytes on the SPI bus
-	rxb = received_from_spi(txBuff.idx < txBuff.byteCount ? txBuff.bytes[txBuff.idx++] : 0x00);
+	//read and send the bytes on the SPI bus. don't send anything while a message is being packed.
+	if (this->packing) {
+		rxb = received_from_spi(0x00);
+	} else {
+		rxb = received_from_spi(txBuff.idx < txBuff.byteCount ? txBuff.bytes[txBuff.idx++] : 0x00);
 
-	//if the entire message has been sent, reset the transmit buffer so that no more messages are sent
-	if ((txBuff.idx > 0) && (txBuff.idx == txBuff.byteCount)) this->resetTransmitBuffer();
+		//if the entire message has been sent, reset the transmit buffer so that no more messages are sent
+		if ((txBuff.idx > 0) && (txBuff.idx == txBuff.byteCount)) this->resetTransmitBuffer();
+	}
 
 	this->receiveByte(rxb);
 }
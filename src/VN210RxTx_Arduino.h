@@ -21,18 +21,12 @@
  */
 
 #include "spi_helper.h"
+#include "VN210Pins.h"
 #include "VN210RxTx.h"
 
 #ifndef VN210RxTx_Arduino_H_
 #define VN210RxTx_Arduino_H_
 
-//IO pin definitions for WKU and RDY
-#define WKU_PIN 			9
-#define RDY_RADIO_PIN 		8
-#define RESET_PIN			7
-#define PROVISIONING_PIN	6
-#define BOOT_PIN			5
-
 /**
  * Arduino-specific implementation of the VN210 transport layer.
  *
@@ -50,7 +44,13 @@
 class VN210RxTx_Arduino : public VN210RxTx {
 public:
 	void rxtx(void);									//receives and transmits a byte on the SPI bus
+	void sleep(void);									//idles the CPU until the next interrupt
 private:
+	typedef VN210_WKU_PIN WakeupPin;					//!< WKU pin.  Pin assignments are set in VN210Pins.h
+	typedef VN210_RESET_PIN ResetPin;					//!< RESET pin
+	typedef VN210_PROVISIONING_PIN ProvisioningPin;		//!< PROVISIONING pin
+	typedef VN210_BOOT_PIN BootPin;						//!< BOOT pin
+
 	void enable();										//initialises SPI bus as slave
 	void initIO();										//initialises the WKU and RESET pins
 	void wakeupRadio();									//pulses the WKU line to wake the radio and start communication.
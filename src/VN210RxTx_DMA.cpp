@@ -0,0 +1,144 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210RxTx_DMA.h"
+
+#define VN210_DMA_HALF_RING (VN210_DMA_RING_SIZE / 2)
+
+/**
+ * Class constructor.  Nothing touches the hardware until begin().
+ */
+VN210RxTx_DMA::VN210RxTx_DMA(VN210DMAHal * hal) {
+	this->hal = hal;
+	this->events = 0;
+	this->rxTail = 0;
+	this->rxCount = 0;
+	this->txCount = 0;
+}
+
+/**
+ * Sets up the radio control lines: WKU low, BOOT selecting the ISA100.11a
+ * firmware, then RESET and PROVISIONING high.
+ */
+void VN210RxTx_DMA::initIO() {
+	this->hal->writePin(VN210DMAHal::PIN_WAKEUP, false);
+	this->hal->writePin(VN210DMAHal::PIN_BOOT, BOOT_PIN_ISA100_FIRMWARE_BOOT);
+	this->hal->writePin(VN210DMAHal::PIN_RESET, true);
+	this->hal->writePin(VN210DMAHal::PIN_PROVISIONING, true);
+}
+
+/**
+ * Starts SPI slave DMA over empty rings.  The first half of the transmit ring
+ * is zeros, so nothing is sent until the first rxtx().
+ */
+void VN210RxTx_DMA::enable() {
+	for (uint16_t i = 0; i < VN210_DMA_RING_SIZE; i++) {
+		this->rxRing[i] = 0;
+		this->txRing[i] = 0;
+	}
+
+	this->rxTail = 0;
+	this->rxCount = 0;
+	this->txCount = VN210_DMA_HALF_RING;
+
+	this->hal->startSPISlave(this->rxRing, this->txRing, VN210_DMA_RING_SIZE);
+}
+
+/**
+ * Performs a soft-reset of the VN210 radio.
+ */
+void VN210RxTx_DMA::resetRadio() {
+	this->hal->writePin(VN210DMAHal::PIN_RESET, false);
+	this->hal->delayMs(2);
+	this->hal->writePin(VN210DMAHal::PIN_RESET, true);
+}
+
+/**
+ * Puts the radio into provisioning mode.
+ *
+ * NOTE: This method has a 10 second delay which will temporarily halt the application!
+ *
+ * @deprecated Provisioning should be done via a button press only.
+ */
+void VN210RxTx_DMA::provisionRadio() {
+	this->hal->writePin(VN210DMAHal::PIN_PROVISIONING, false);
+	this->hal->delayMs(VN210_PROVISIONING_DURATION_MS);
+	this->hal->writePin(VN210DMAHal::PIN_PROVISIONING, true);
+}
+
+/**
+ * Wakes up the VN210 causing it to send a poll message to the application processor.
+ */
+void VN210RxTx_DMA::wakeupRadio() {
+	this->hal->writePin(VN210DMAHal::PIN_WAKEUP, true);
+	this->hal->delayMs(WKU_PULSE_WIDTH_MS);
+	this->hal->writePin(VN210DMAHal::PIN_WAKEUP, false);
+}
+
+/**
+ * Decodes the bytes received since the last call, then refills the transmit
+ * ring.  Called from the DMA half-transfer and transfer-complete interrupts,
+ * and optionally the NSS rising edge.
+ *
+ * The transmit ring is kept filled half a ring ahead of the DMA, so a message
+ * packed by sendMsg() starts going out within half a ring.  The rest of the
+ * ring is zeroed, so if the next call is late the radio is sent idle bytes
+ * rather than an old message.
+ */
+void VN210RxTx_DMA::rxtx() {
+	uint16_t head = this->hal->rxPosition();
+
+	this->events++;
+
+	//decode everything since the last call, in two runs if the DMA has wrapped
+	if (head < this->rxTail) {
+		this->receiveBytes(this->rxRing + this->rxTail, VN210_DMA_RING_SIZE - this->rxTail);
+		this->rxCount += VN210_DMA_RING_SIZE - this->rxTail;
+		this->rxTail = 0;
+	}
+
+	this->receiveBytes(this->rxRing + this->rxTail, head - this->rxTail);
+	this->rxCount += head - this->rxTail;
+	this->rxTail = head;
+
+	//the DMA has sent up to rxCount. if it's overtaken what was written, those bytes have gone.
+	if ((int16_t) (this->txCount - this->rxCount) < 0) {
+		this->txCount = this->rxCount;
+	}
+
+	uint16_t target = this->rxCount + VN210_DMA_HALF_RING;
+
+	while ((int16_t) (target - this->txCount) > 0) {
+		uint16_t at = this->txCount % VN210_DMA_RING_SIZE;
+		uint16_t count = target - this->txCount;
+
+		if (count > VN210_DMA_RING_SIZE - at) count = VN210_DMA_RING_SIZE - at;
+
+		this->transmitBytes(this->txRing + at, count);
+		this->txCount += count;
+	}
+
+	//zero from the end of what's been written round to the DMA, which has already sent those bytes
+	for (uint16_t i = this->txCount; i != (uint16_t) (this->rxCount + VN210_DMA_RING_SIZE); i++) {
+		this->txRing[i % VN210_DMA_RING_SIZE] = 0x00;
+	}
+}
@@ -0,0 +1,77 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "VN210Config.h"
+#include "VN210DMAHal.h"
+#include "VN210RxTx.h"
+
+#ifndef VN210RxTx_DMA_H_
+#define VN210RxTx_DMA_H_
+
+/**
+ * VN210 transport layer for MCUs with DMA-capable SPI, such as Cortex-M parts.
+ *
+ * The Arduino transport takes an interrupt for every byte, which limits the SPI
+ * speed a busy node can keep up with.  Here the bytes are moved by DMA through
+ * two circular rings of VN210_DMA_RING_SIZE bytes, and rxtx() runs on each half
+ * ring: it decodes everything received since the last call in one go, then
+ * refills the transmit ring half a ring ahead of the DMA.
+ *
+ * rxtx() must run within half a ring's transfer time of each DMA event.  If it
+ * falls further behind, received bytes are overwritten before they are decoded,
+ * so frames are lost or fail their CRC, and the radio is sent zeros in place of
+ * part of a message.
+ *
+ * As on Arduino, a frame is held from the moment it completes until the API
+ * releases it, and frames arriving meanwhile are dropped.  Here that covers the
+ * rest of the half ring the frame ended in as well.
+ *
+ * All hardware access goes through a VN210DMAHal.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup Lowlevel
+ * @ingroup Headers
+ */
+class VN210RxTx_DMA : public VN210RxTx {
+public:
+	VN210RxTx_DMA(VN210DMAHal * hal);
+
+	void rxtx(void);									//decodes received bytes and refills the transmit ring. call from the DMA and NSS interrupts.
+	void resetRadio();									//resets the radio.
+	void provisionRadio() __attribute__ ((deprecated));	//!< Puts the radio into provisioning mode.
+
+	volatile uint32_t events;							//!< Number of calls to rxtx()
+private:
+	VN210DMAHal * hal;									//!< Hardware the transport runs on
+
+	volatile uint8_t rxRing[VN210_DMA_RING_SIZE];		//!< Receive DMA ring
+	volatile uint8_t txRing[VN210_DMA_RING_SIZE];		//!< Transmit DMA ring
+	uint16_t rxTail;									//!< Index of the next received byte to decode
+	uint16_t rxCount;									//!< Bytes received, modulo 2^16
+	uint16_t txCount;									//!< Bytes written to the transmit ring, modulo 2^16
+
+	void enable();										//starts SPI slave DMA
+	void initIO();										//initialises the radio control lines
+	void wakeupRadio();									//pulses the WKU line to wake the radio and start communication.
+};
+
+#endif /* VN210RxTx_DMA_H_ */
@@ -0,0 +1,220 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210Scheduler.h"
+
+/**
+ * Class constructor.  The API instance is serviced on every call to run(),
+ * before any task.  Pass NULL to use the scheduler without a radio.
+ */
+VN210Scheduler::VN210Scheduler(VN210SimpleAPI * api) {
+	this->api = api;
+	this->taskCount = 0;
+	this->microsClock = NULL;
+	this->timing = false;
+	this->slept = false;
+	this->resetCounters();
+}
+
+/**
+ * Registers a task to be run every 'period' milliseconds.  The first run
+ * is due one period after 'now'.
+ *
+ * Returns the index of the task in the tasks array, or VN210_SCHEDULER_NO_TASK
+ * if the task table is full.
+ */
+uint8_t VN210Scheduler::addTask(TaskCallback callback, uint32_t period, uint32_t now) {
+	if (this->taskCount == VN210_SCHEDULER_MAX_TASKS || period == 0) {
+		return VN210_SCHEDULER_NO_TASK;
+	}
+
+	Task * task = &this->tasks[this->taskCount];
+	task->callback = callback;
+	task->period = period;
+	task->due = now + period;
+	task->runs = 0;
+	task->overruns = 0;
+	task->lastJitter = 0;
+	task->maxJitter = 0;
+
+	return this->taskCount++;
+}
+
+/**
+ * Services the radio and runs the most overdue task, if any task is due.
+ *
+ * Pending radio messages are handled first, then the link to the radio is
+ * checked with VN210SimpleAPI::checkLink().  Only one task is run per call
+ * so that the radio is checked again before the next task starts; call this
+ * from loop() as often as possible.
+ *
+ * A handled frame is released before the task runs, so a frame arriving while
+ * the task runs is received rather than dropped.  rxFrame is empty afterwards.
+ *
+ * Returns true if a radio message was handled during this call.
+ */
+bool VN210Scheduler::run(uint32_t now) {
+	bool handledMessage = false;
+
+	this->account(now);
+
+	if (this->api != NULL && this->api->hasNewMessage()) {
+		this->api->handleMessage();
+		this->api->releaseMessage();
+		handledMessage = true;
+	}
+
+#if VN210_LINK_MISSED_POLLS
+	if (this->api != NULL) this->api->checkLink(now);
+#endif
+
+	//find the task which has been due for longest. signed differences survive millis() wraparound.
+	Task * next = NULL;
+	int32_t nextLateness = 0;
+
+	for (uint8_t i = 0; i < this->taskCount; i++) {
+		int32_t lateness = (int32_t) (now - this->tasks[i].due);
+
+		if (lateness >= 0 && (next == NULL || lateness > nextLateness)) {
+			next = &this->tasks[i];
+			nextLateness = lateness;
+		}
+	}
+
+	if (next == NULL) {
+		return handledMessage;
+	}
+
+	uint32_t lateness = (uint32_t) nextLateness;
+	next->lastJitter = (lateness > VN210_SCHEDULER_JITTER_MAX) ? VN210_SCHEDULER_JITTER_MAX : lateness;
+	if (next->lastJitter > next->maxJitter) next->maxJitter = next->lastJitter;
+
+	//advance from the due time rather than from now, so the schedule doesn't drift.
+	//if we're a whole period or more behind, skip the missed periods.
+	next->due += next->period;
+	if (lateness >= next->period) {
+		uint32_t missed = lateness / next->period;
+		next->overruns += missed;
+		next->due += missed * next->period;
+	}
+
+	next->runs++;
+	next->callback();
+
+	return handledMessage;
+}
+
+/**
+ * Returns the number of milliseconds until the next task is due, or zero if
+ * a task is already due.  Returns 0xFFFFFFFF if there are no tasks.
+ */
+uint32_t VN210Scheduler::timeUntilNextTask(uint32_t now) {
+	uint32_t shortest = 0xFFFFFFFF;
+
+	for (uint8_t i = 0; i < this->taskCount; i++) {
+		int32_t remaining = (int32_t) (this->tasks[i].due - now);
+
+		if (remaining <= 0) return 0;
+		if ((uint32_t) remaining < shortest) shortest = remaining;
+	}
+
+	return shortest;
+}
+
+/**
+ * Puts the processor to sleep until the next interrupt, if the radio has nothing
+ * waiting for the main loop (see VN210SimpleAPI::isIdle()) and no task is due.
+ * Call after run(), as often as possible: the processor is woken by every SPI
+ * byte and, on Arduino, by the millisecond timer, so a due task or incoming
+ * frame is picked up by the next run().
+ *
+ * Returns true if the processor slept.  The time until the next call to run()
+ * or idle() is then added to sleepTime, otherwise to activeTime.  Without an API
+ * instance there is no transport to sleep with, so the processor stays awake.
+ */
+bool VN210Scheduler::idle(uint32_t now) {
+	this->account(now);
+
+	if (this->api == NULL || !this->api->isIdle()) return false;
+	if (this->timeUntilNextTask(now) == 0) return false;
+
+	this->api->dl->sleep();
+
+	this->slept = true;
+	return true;
+}
+
+/**
+ * Registers a microsecond clock for timing the stretches asleep and awake, which
+ * are mostly far shorter than a millisecond.  sleepTime and activeTime are still
+ * totalled in milliseconds, carrying the microseconds over.  Pass NULL to time
+ * them with the milliseconds passed to run() and idle() instead.
+ */
+void VN210Scheduler::setMicrosClock(MicrosClock clock) {
+	this->microsClock = clock;
+	this->timing = false;
+}
+
+/**
+ * Resets the run, overrun and jitter counters of all tasks, and the sleep and
+ * active times.  The schedule itself is not changed.
+ */
+void VN210Scheduler::resetCounters(void) {
+	for (uint8_t i = 0; i < this->taskCount; i++) {
+		this->tasks[i].runs = 0;
+		this->tasks[i].overruns = 0;
+		this->tasks[i].lastJitter = 0;
+		this->tasks[i].maxJitter = 0;
+	}
+
+	this->sleepTime = 0;
+	this->activeTime = 0;
+	this->sleepMicros = 0;
+	this->activeMicros = 0;
+}
+
+/**
+ * Adds the time since the last call to run() or idle() to sleepTime if that
+ * call slept, otherwise to activeTime.
+ */
+void VN210Scheduler::account(uint32_t now) {
+	uint32_t micros = (this->microsClock != NULL) ? (uint32_t) this->microsClock() : 0;
+
+	if (this->timing) {
+		uint32_t * total = this->slept ? &this->sleepTime : &this->activeTime;
+
+		if (this->microsClock != NULL) {
+			uint16_t * part = this->slept ? &this->sleepMicros : &this->activeMicros;
+			uint32_t elapsed = (micros - this->lastMicros) + *part;
+
+			*total += elapsed / 1000;
+			*part = elapsed % 1000;
+		} else {
+			*total += now - this->lastCall;
+		}
+	}
+
+	this->lastCall = now;
+	this->lastMicros = micros;
+	this->timing = true;
+	this->slept = false;
+}
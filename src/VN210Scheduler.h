@@ -0,0 +1,110 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "VN210SimpleAPI.h"
+
+#ifndef VN210SCHEDULER_H_
+#define VN210SCHEDULER_H_
+
+#define VN210_SCHEDULER_MAX_TASKS 4			//maximum number of tasks that can be registered with a scheduler
+#define VN210_SCHEDULER_NO_TASK 0xFF		//returned by addTask() when the task table is full
+#define VN210_SCHEDULER_JITTER_MAX 0xFFFF	//jitter counters saturate at this value (ms)
+
+/**
+ * Small cooperative scheduler for sensor applications using the Simple API.
+ *
+ * Tasks are plain functions run at a fixed period.  The due time of each task
+ * advances by exactly one period per run, so sample times do not drift when
+ * a task is run late.  If a task falls more than a whole period behind, the
+ * missed periods are skipped and counted as overruns rather than run back to back.
+ *
+ * Radio messages are always serviced before any task is considered, and at
+ * most one task is run per call to run(), so the time the radio waits for the
+ * application is bounded by the longest single task.
+ *
+ * Between calls to run(), idle() puts the processor to sleep when neither the
+ * radio nor a task needs it, and the time spent asleep and awake is totalled.
+ * The sleep is not tickless: on Arduino, Timer0 keeps running for millis(), so
+ * the processor is woken about every 1.024 ms however long the next task is
+ * away, and each of those wakeups counts as awake time:
+ *
+ *   void loop() {
+ *       scheduler.run(millis());
+ *       scheduler.idle(millis());
+ *   }
+ *
+ * The scheduler does not read a clock itself.  The current time in milliseconds
+ * is passed in by the caller, e.g. using millis() on Arduino.  Most awake
+ * stretches are much shorter than a millisecond, so to total them properly
+ * register a microsecond clock with setMicrosClock(), e.g. micros on Arduino.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup SimpleAPI
+ * @ingroup Headers
+ */
+class VN210Scheduler {
+public:
+	typedef void (*TaskCallback)(void);							//!< Task function type.
+	typedef unsigned long (*MicrosClock)(void);					//!< Microsecond clock type, matching micros() on Arduino.
+
+	/**
+	 * Scheduler task entry, including its timing counters.
+	 */
+	typedef struct {
+		TaskCallback callback;									//!< Function to call when the task is due.
+		uint32_t period;										//!< Task period in milliseconds.
+		uint32_t due;											//!< Time at which the task is next due, in milliseconds.
+		uint16_t runs;											//!< Number of times the task has been run.
+		uint16_t overruns;										//!< Number of periods skipped because the task fell a whole period behind.
+		uint16_t lastJitter;									//!< How late the last run started, in milliseconds.
+		uint16_t maxJitter;										//!< Largest start delay since the counters were reset, in milliseconds.
+	} Task;
+
+	Task tasks[VN210_SCHEDULER_MAX_TASKS];						//!< Registered tasks.  Read the counters from here.
+	uint8_t taskCount;											//!< Number of registered tasks.
+
+	uint32_t sleepTime;											//!< Time spent asleep in idle() since the counters were reset, in milliseconds.
+	uint32_t activeTime;										//!< Time spent awake since the counters were reset, in milliseconds.
+
+	VN210Scheduler(VN210SimpleAPI * api);
+
+	uint8_t addTask(TaskCallback callback, uint32_t period, uint32_t now);	//registers a periodic task, returning its index
+	bool run(uint32_t now);										//services the radio, then runs at most one due task
+	uint32_t timeUntilNextTask(uint32_t now);					//returns the number of ms until the next task is due
+	bool idle(uint32_t now);									//sleeps until the next interrupt if the radio and tasks allow
+	void setMicrosClock(MicrosClock clock);						//times sleepTime and activeTime with 'clock'.  NULL to use the ms passed in
+	void resetCounters(void);									//resets the run, overrun, jitter and sleep counters
+private:
+	VN210SimpleAPI * api;										//!< API instance serviced before each task.  May be NULL.
+
+	MicrosClock microsClock;									//!< Clock read by account(), or NULL.
+	uint32_t lastCall;											//!< Time passed to the last run() or idle(), in milliseconds.
+	uint32_t lastMicros;										//!< microsClock at the last run() or idle().
+	uint16_t sleepMicros;										//!< Time asleep not yet added to sleepTime, in microseconds.
+	uint16_t activeMicros;										//!< Time awake not yet added to activeTime, in microseconds.
+	bool timing;												//!< Set once lastCall holds a time.
+	bool slept;													//!< Set if the last call was an idle() which slept.
+
+	void account(uint32_t now);									//adds the time since the last call to sleepTime or activeTime
+};
+
+#endif /* VN210SCHEDULER_H_ */
@@ -0,0 +1,245 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef VN210SCHEMA_H_
+#define VN210SCHEMA_H_
+
+//size of an encoded attribute in a passthrough payload: ID byte followed by a 4 byte big-endian value
+#define VN210_ATTRIBUTE_VALUE_SIZE 4
+#define VN210_ATTRIBUTE_SIZE (1 + VN210_ATTRIBUTE_VALUE_SIZE)
+
+/**
+ * 32 bit big-endian value encoding shared by the codecs.
+ */
+struct VN210BigEndian {
+	static void put(uint32_t value, uint8_t * out) {
+		out[0] = value >> 24;
+		out[1] = value >> 16;
+		out[2] = value >> 8;
+		out[3] = value;
+	}
+
+	static uint32_t get(const uint8_t * in) {
+		return ((uint32_t) in[0] << 24) | ((uint32_t) in[1] << 16) | ((uint32_t) in[2] << 8) | in[3];
+	}
+};
+
+/**
+ * IEEE 754 single precision float.
+ */
+struct VN210FloatCodec {
+	typedef float Type;
+
+	static void encode(const float & value, uint8_t * out) {
+		union { float f; uint32_t u; } bits;
+		bits.f = value;
+		VN210BigEndian::put(bits.u, out);
+	}
+
+	static void decode(const uint8_t * in, float & value) {
+		union { float f; uint32_t u; } bits;
+		bits.u = VN210BigEndian::get(in);
+		value = bits.f;
+	}
+};
+
+/**
+ * Signed 32 bit integer.
+ */
+struct VN210Int32Codec {
+	typedef int32_t Type;
+
+	static void encode(const int32_t & value, uint8_t * out) { VN210BigEndian::put((uint32_t) value, out); }
+	static void decode(const uint8_t * in, int32_t & value) { value = (int32_t) VN210BigEndian::get(in); }
+};
+
+/**
+ * Digital value, sent as 0 or 1 in the least significant byte.  Any non-zero
+ * value received is true.
+ */
+struct VN210BoolCodec {
+	typedef bool Type;
+
+	static void encode(const bool & value, uint8_t * out) {
+		out[0] = 0;
+		out[1] = 0;
+		out[2] = 0;
+		out[3] = value ? 1 : 0;
+	}
+
+	static void decode(const uint8_t * in, bool & value) { value = in[3] != 0; }
+};
+
+/**
+ * Packed flags held in an unsigned integer of up to 32 bits, bit 0 in the least
+ * significant bit of the value.  Bits which don't fit T are dropped on decode.
+ */
+template <typename T>
+struct VN210FlagsCodec {
+	typedef T Type;
+
+	static void encode(const T & value, uint8_t * out) { VN210BigEndian::put((uint32_t) value, out); }
+	static void decode(const uint8_t * in, T & value) { value = (T) VN210BigEndian::get(in); }
+};
+
+/**
+ * Locates an attribute value in a plain member of a struct.
+ */
+template <class S, typename T, T S::*MEMBER>
+struct VN210Member {
+	typedef S Store;
+
+	static T & get(S & store) { return store.*MEMBER; }
+};
+
+/**
+ * One attribute: its ID, the codec for its value and where the value is stored.
+ * Locator is a type with a Store typedef and a static get(Store &) returning a
+ * reference to the value, such as VN210Member.
+ */
+template <uint8_t ID, class Codec, class Locator>
+struct VN210Attribute {
+	typedef typename Locator::Store Store;
+
+	static const uint8_t id = ID;
+
+	static void encode(Store & store, uint8_t * out) { Codec::encode(Locator::get(store), out); }
+	static void decode(Store & store, const uint8_t * in) { Codec::decode(in, Locator::get(store)); }
+};
+
+/**
+ * End of a schema list.
+ */
+struct VN210SchemaEnd {
+	static const uint8_t count = 0;
+
+	static bool contains(uint8_t) { return false; }
+	template <class S> static bool encode(S &, uint8_t, uint8_t *) { return false; }
+	template <class S> static bool decode(S &, uint8_t, const uint8_t *) { return false; }
+	template <class S> static uint8_t encodeAll(S &, uint8_t *, uint8_t) { return 0; }
+};
+
+/**
+ * Compile-time attribute schemas for data passthrough payloads.
+ *
+ * Write requests and read responses carry attributes as an ID byte followed by a
+ * 4 byte big-endian value.  A node declares its attributes once as a list of
+ * VN210Attribute types, each naming the attribute ID, a codec for its value type
+ * and where the value lives, and the schema generates the encode / decode code.
+ *
+ * Byte order is handled with shifts, so the same code is correct on any CPU, and
+ * each attribute's codec is fixed at compile time: there is no switch on the value
+ * type at run time.  The ID lookup is a chain of constant comparisons which the
+ * compiler is free to turn into a jump table.  IDs not in the schema are rejected.
+ *
+ * A schema is an attribute followed by the rest of the schema.  Lists are nested
+ * to declare any number of attributes, ending with VN210SchemaEnd.
+ *
+ * For example, a node with two floats, a counter and an alarm bit:
+ *
+ *   struct NodeData { float temperature; float humidity; int32_t count; bool alarm; };
+ *
+ *   typedef VN210SchemaList<VN210Attribute<1, VN210FloatCodec, VN210Member<NodeData, float, &NodeData::temperature> >,
+ *           VN210SchemaList<VN210Attribute<2, VN210FloatCodec, VN210Member<NodeData, float, &NodeData::humidity> >,
+ *           VN210SchemaList<VN210Attribute<3, VN210Int32Codec, VN210Member<NodeData, int32_t, &NodeData::count> >,
+ *           VN210SchemaList<VN210Attribute<16, VN210BoolCodec, VN210Member<NodeData, bool, &NodeData::alarm> >
+ *           > > > > NodeSchema;
+ *
+ *   NodeData node;
+ *   VN210SchemaStore<NodeSchema> nodeStore(&node);
+ *   VN210.setAttributeStore(&nodeStore);
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup SimpleAPI
+ * @ingroup Headers
+ */
+
+template <class Attribute, class Next = VN210SchemaEnd>
+struct VN210SchemaList {
+	typedef typename Attribute::Store Store;
+
+	static const uint8_t count = 1 + Next::count;					//!< Number of attributes in the schema
+
+	//returns true if 'id' is in the schema
+	static bool contains(uint8_t id) {
+		return id == Attribute::id || Next::contains(id);
+	}
+
+	//writes the 4 byte value of attribute 'id' to 'out'. returns false if the ID isn't in the schema.
+	static bool encode(Store & store, uint8_t id, uint8_t * out) {
+		if (id == Attribute::id) {
+			Attribute::encode(store, out);
+			return true;
+		}
+		return Next::encode(store, id, out);
+	}
+
+	//sets attribute 'id' from the 4 byte value at 'in'. returns false if the ID isn't in the schema.
+	static bool decode(Store & store, uint8_t id, const uint8_t * in) {
+		if (id == Attribute::id) {
+			Attribute::decode(store, in);
+			return true;
+		}
+		return Next::decode(store, id, in);
+	}
+
+	//writes up to 'capacity' attributes to 'out', each as its ID and 4 byte value. returns the number written.
+	static uint8_t encodeAll(Store & store, uint8_t * out, uint8_t capacity) {
+		if (capacity == 0) return 0;
+
+		out[0] = Attribute::id;
+		Attribute::encode(store, out + 1);
+		return 1 + Next::encodeAll(store, out + VN210_ATTRIBUTE_SIZE, capacity - 1);
+	}
+};
+
+/**
+ * Attribute storage as seen by the Simple API.  Implemented by VN210SchemaStore,
+ * so the API's request handlers work with any schema.
+ */
+class VN210AttributeStore {
+public:
+	virtual bool readAttribute(uint8_t id, uint8_t * out) = 0;			//writes the 4 byte value of attribute 'id'. false if unknown.
+	virtual bool writeAttribute(uint8_t id, const uint8_t * in) = 0;	//sets attribute 'id' from a 4 byte value. false if unknown.
+	virtual uint8_t readAllAttributes(uint8_t * out, uint8_t capacity) = 0;	//writes up to 'capacity' ID + value pairs. returns the number written.
+};
+
+/**
+ * Binds a schema to the struct holding its values.
+ */
+template <class Schema>
+class VN210SchemaStore : public VN210AttributeStore {
+public:
+	VN210SchemaStore(typename Schema::Store * store) : store(store) {}
+
+	bool readAttribute(uint8_t id, uint8_t * out) { return Schema::encode(*this->store, id, out); }
+	bool writeAttribute(uint8_t id, const uint8_t * in) { return Schema::decode(*this->store, id, in); }
+	uint8_t readAllAttributes(uint8_t * out, uint8_t capacity) { return Schema::encodeAll(*this->store, out, capacity); }
+private:
+	typename Schema::Store * store;									//!< Attribute values
+};
+
+#endif /* VN210SCHEMA_H_ */
@@ -0,0 +1,281 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210Segment.h"
+
+/**
+ * Class constructor.  The sender starts idle.
+ */
+VN210SegmentSender::VN210SegmentSender() {
+	this->payload = NULL;
+	this->length = 0;
+	this->transferID = 0;
+	this->fragmentCount = 0;
+	this->pending = 0;
+	this->acknowledged = 0;
+	this->retries = 0;
+	this->abandonedTransfers = 0;
+}
+
+/**
+ * Starts a new transfer of 'length' bytes from 'payload', abandoning any transfer
+ * in progress.  The payload must remain unchanged until the transfer is complete.
+ *
+ * Returns false if the payload is empty or larger than VN210_SEGMENT_MAX_PAYLOAD.
+ */
+bool VN210SegmentSender::begin(const uint8_t * payload, uint16_t length, uint8_t transferID) {
+	if (length == 0 || length > VN210_SEGMENT_MAX_PAYLOAD) {
+		return false;
+	}
+
+	this->payload = payload;
+	this->length = length;
+	this->transferID = transferID;
+	this->fragmentCount = (length + VN210_SEGMENT_DATA_SIZE - 1) / VN210_SEGMENT_DATA_SIZE;
+	this->acknowledged = 0;
+	this->pending = this->allFragments();
+	this->retries = 0;
+
+	return true;
+}
+
+/**
+ * Writes the lowest numbered fragment still waiting to be sent into 'fragment',
+ * which must hold at least VN210_SEGMENT_FRAME_SIZE bytes, and marks it as sent.
+ *
+ * Returns the number of bytes written, or zero if there is nothing to send.
+ */
+uint8_t VN210SegmentSender::nextFragment(uint8_t * fragment) {
+	if (this->pending == 0) {
+		return 0;
+	}
+
+	uint8_t seq = 0;
+	while ((this->pending & ((uint32_t) 1 << seq)) == 0) seq++;
+
+	this->pending &= ~((uint32_t) 1 << seq);
+
+	uint16_t offset = (uint16_t) seq * VN210_SEGMENT_DATA_SIZE;
+	uint8_t dataSize = (this->length - offset > VN210_SEGMENT_DATA_SIZE) ? VN210_SEGMENT_DATA_SIZE : this->length - offset;
+
+	fragment[0] = this->transferID;
+	fragment[1] = seq;
+	fragment[2] = this->fragmentCount;
+	fragment[3] = offset >> 8;
+	fragment[4] = offset & 0xFF;
+	memcpy(fragment + VN210_SEGMENT_HEADER_SIZE, this->payload + offset, dataSize);
+
+	return VN210_SEGMENT_HEADER_SIZE + dataSize;
+}
+
+/**
+ * Handles a SEGMENT_ACK payload from the receiver.  Fragments missing from the
+ * receiver's bitmap are queued to be sent again.  Once every fragment has been
+ * acknowledged the transfer is finished and the sender becomes idle.
+ *
+ * Returns false if the acknowledgement is malformed or for a different transfer.
+ */
+bool VN210SegmentSender::acknowledge(const uint8_t * ack, uint8_t length) {
+	if (length < VN210_SEGMENT_ACK_SIZE || !this->isActive() || ack[0] != this->transferID) {
+		return false;
+	}
+
+	this->acknowledged = (((uint32_t) ack[1] << 24) | ((uint32_t) ack[2] << 16) | ((uint32_t) ack[3] << 8) | ack[4]) & this->allFragments();
+	this->retries = 0;
+
+	if (this->acknowledged == this->allFragments()) {
+		this->fragmentCount = 0;		//done
+		this->pending = 0;
+	} else {
+		this->pending = this->allFragments() & ~this->acknowledged;
+	}
+
+	return true;
+}
+
+/**
+ * Queues every fragment which hasn't been acknowledged to be sent again.  Use this
+ * when no acknowledgement arrives after the last fragment has been sent.
+ *
+ * After VN210_SEGMENT_MAX_RETRIES calls with no acknowledgement in between, the
+ * transfer is abandoned instead: the sender becomes idle, abandonedTransfers is
+ * incremented and false is returned.
+ */
+bool VN210SegmentSender::retransmitUnacknowledged(void) {
+	if (!this->isActive()) {
+		return true;
+	}
+
+	if (this->retries >= VN210_SEGMENT_MAX_RETRIES) {
+		this->fragmentCount = 0;
+		this->pending = 0;
+		this->abandonedTransfers++;
+		return false;
+	}
+
+	this->retries++;
+	this->pending = this->allFragments() & ~this->acknowledged;
+	return true;
+}
+
+/**
+ * Returns true if a transfer is in progress, i.e. not all fragments have been acknowledged.
+ */
+bool VN210SegmentSender::isActive(void) {
+	return this->fragmentCount > 0;
+}
+
+/**
+ * Returns true if there is at least one fragment waiting to be sent.
+ */
+bool VN210SegmentSender::hasFragmentToSend(void) {
+	return this->pending != 0;
+}
+
+/**
+ * Returns the ID of the current (or last) transfer.
+ */
+uint8_t VN210SegmentSender::getTransferID(void) {
+	return this->transferID;
+}
+
+/**
+ * Returns a bitmap with one bit set for each fragment in the current transfer.
+ */
+uint32_t VN210SegmentSender::allFragments(void) {
+	return (this->fragmentCount == VN210_SEGMENT_MAX_FRAGMENTS) ? 0xFFFFFFFF : (((uint32_t) 1 << this->fragmentCount) - 1);
+}
+
+/**
+ * Class constructor.  The receiver has no buffer until begin() is called, and
+ * rejects all fragments until then.
+ */
+VN210SegmentReceiver::VN210SegmentReceiver() {
+	this->begin(NULL, 0);
+}
+
+/**
+ * Sets the buffer which fragments are reassembled into, and clears any
+ * partially received transfer.
+ */
+void VN210SegmentReceiver::begin(uint8_t * buffer, uint16_t capacity) {
+	this->buffer = buffer;
+	this->capacity = capacity;
+	this->length = 0;
+	this->transferID = 0;
+	this->fragmentCount = 0;
+	this->received = 0;
+}
+
+/**
+ * Adds a SEGMENT_DATA payload to the reassembly buffer.  A fragment from a new
+ * transfer ID abandons the current transfer.  Duplicate fragments are accepted,
+ * so the sender gets a fresh acknowledgement, but not copied again.
+ *
+ * Returns false if the fragment is malformed or doesn't fit in the buffer.
+ */
+bool VN210SegmentReceiver::addFragment(const uint8_t * fragment, uint8_t length) {
+	if (this->buffer == NULL || length <= VN210_SEGMENT_HEADER_SIZE) {
+		return false;
+	}
+
+	uint8_t transferID = fragment[0];
+	uint8_t seq = fragment[1];
+	uint8_t count = fragment[2];
+	uint16_t offset = ((uint16_t) fragment[3] << 8) | fragment[4];
+	uint8_t dataSize = length - VN210_SEGMENT_HEADER_SIZE;
+
+	if (count == 0 || count > VN210_SEGMENT_MAX_FRAGMENTS || seq >= count || (uint32_t) offset + dataSize > this->capacity) {
+		return false;
+	}
+
+	//new transfer? start again.
+	if (this->fragmentCount == 0 || transferID != this->transferID) {
+		this->transferID = transferID;
+		this->fragmentCount = count;
+		this->received = 0;
+		this->length = 0;
+	} else if (count != this->fragmentCount) {
+		return false;
+	}
+
+	uint32_t bit = (uint32_t) 1 << seq;
+
+	if ((this->received & bit) == 0) {
+		memcpy(this->buffer + offset, fragment + VN210_SEGMENT_HEADER_SIZE, dataSize);
+		this->received |= bit;
+
+		//the last fragment tells us the total length
+		if (seq == count - 1) {
+			this->length = offset + dataSize;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Writes the SEGMENT_ACK payload for the current transfer into 'ack', which must
+ * hold VN210_SEGMENT_ACK_SIZE bytes.  Returns the number of bytes written.
+ */
+uint8_t VN210SegmentReceiver::ackPayload(uint8_t * ack) {
+	ack[0] = this->transferID;
+	ack[1] = this->received >> 24;
+	ack[2] = this->received >> 16;
+	ack[3] = this->received >> 8;
+	ack[4] = this->received;
+
+	return VN210_SEGMENT_ACK_SIZE;
+}
+
+/**
+ * Returns true once every fragment of the current transfer has been received.
+ */
+bool VN210SegmentReceiver::isComplete(void) {
+	if (this->fragmentCount == 0) {
+		return false;
+	}
+
+	uint32_t all = (this->fragmentCount == VN210_SEGMENT_MAX_FRAGMENTS) ? 0xFFFFFFFF : (((uint32_t) 1 << this->fragmentCount) - 1);
+	return this->received == all;
+}
+
+/**
+ * Returns the length of the reassembled payload.  Only valid once isComplete() returns true.
+ */
+uint16_t VN210SegmentReceiver::getLength(void) {
+	return this->length;
+}
+
+/**
+ * Returns the ID of the current transfer.
+ */
+uint8_t VN210SegmentReceiver::getTransferID(void) {
+	return this->transferID;
+}
+
+/**
+ * Returns the bitmap of fragments received in the current transfer.
+ */
+uint32_t VN210SegmentReceiver::getReceivedBitmap(void) {
+	return this->received;
+}
@@ -0,0 +1,121 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "VN210Config.h"
+#include <stdint.h>
+#include <string.h>
+
+#ifndef VN210SEGMENT_H_
+#define VN210SEGMENT_H_
+
+// Segment header, carried at the start of each SEGMENT_DATA payload:
+// transfer ID (1), fragment sequence number (1), fragment count (1), byte offset (2, MSB first)
+#define VN210_SEGMENT_HEADER_SIZE 5
+
+// SEGMENT_ACK payload: transfer ID (1), bitmap of received fragments (4, MSB first)
+#define VN210_SEGMENT_ACK_SIZE 5
+
+// Bits in the received fragment bitmap, so the largest number of fragments in a transfer.
+#define VN210_SEGMENT_MAX_FRAGMENTS 32
+
+// Payload bytes per fragment.  Every payload byte could need escaping, so the frame
+// (STX + 4 header bytes + segment header + data + 2 CRC bytes) is sized for the worst case.
+#define VN210_SEGMENT_DATA_SIZE (((VN210_BUFFER_SIZE - 1) / 2) - 6 - VN210_SEGMENT_HEADER_SIZE)
+
+// Size of a complete SEGMENT_DATA payload
+#define VN210_SEGMENT_FRAME_SIZE (VN210_SEGMENT_HEADER_SIZE + VN210_SEGMENT_DATA_SIZE)
+
+// Largest payload which can be moved in a single transfer
+#define VN210_SEGMENT_MAX_PAYLOAD ((uint16_t) VN210_SEGMENT_MAX_FRAGMENTS * VN210_SEGMENT_DATA_SIZE)
+
+/**
+ * Sending half of the segmentation layer.  Splits a payload which is too big for a
+ * single frame into numbered fragments, each small enough for one SEGMENT_DATA
+ * pass-through message.
+ *
+ * Each fragment is sent once.  The receiver answers with a SEGMENT_ACK holding a
+ * bitmap of the fragments it has, and only the fragments missing from the bitmap
+ * are sent again.  If the receiver stops answering, the transfer is abandoned after
+ * VN210_SEGMENT_MAX_RETRIES retransmissions, so it can't hold the link forever.
+ * The payload is not copied, so it must not change until the transfer is complete
+ * or abandoned.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup SimpleAPI
+ * @ingroup Headers
+ */
+class VN210SegmentSender {
+public:
+	VN210SegmentSender();
+
+	bool begin(const uint8_t * payload, uint16_t length, uint8_t transferID);	//starts a new transfer
+	uint8_t nextFragment(uint8_t * fragment);					//writes the next fragment to send, returning its size
+	bool acknowledge(const uint8_t * ack, uint8_t length);		//handles a SEGMENT_ACK payload from the receiver
+	bool retransmitUnacknowledged(void);						//queues every unacknowledged fragment.  false if the transfer was abandoned instead
+	bool isActive(void);										//returns true if a transfer is in progress
+	bool hasFragmentToSend(void);								//returns true if there is a fragment waiting to be sent
+	uint8_t getTransferID(void);								//returns the ID of the current transfer
+
+	uint16_t abandonedTransfers;								//!< Number of transfers abandoned after VN210_SEGMENT_MAX_RETRIES
+private:
+	const uint8_t * payload;									//!< Payload being transferred.  Not owned.
+	uint16_t length;											//!< Payload length in bytes
+	uint8_t transferID;											//!< ID of the current transfer
+	uint8_t fragmentCount;										//!< Number of fragments in the transfer.  Zero if idle.
+	uint32_t pending;											//!< Bitmap of fragments still to be sent
+	uint32_t acknowledged;										//!< Bitmap of fragments the receiver has confirmed
+	uint8_t retries;											//!< Retransmissions since the last acknowledgement
+
+	uint32_t allFragments(void);								//returns a bitmap with a bit set for every fragment
+};
+
+/**
+ * Receiving half of the segmentation layer.  Reassembles SEGMENT_DATA fragments,
+ * which may arrive in any order and more than once, into a buffer supplied by the
+ * application, keeping a bitmap of the fragments received so far.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup SimpleAPI
+ * @ingroup Headers
+ */
+class VN210SegmentReceiver {
+public:
+	VN210SegmentReceiver();
+
+	void begin(uint8_t * buffer, uint16_t capacity);			//sets the buffer to reassemble into and waits for a transfer
+	bool addFragment(const uint8_t * fragment, uint8_t length);	//adds a SEGMENT_DATA payload, returning false if it was rejected
+	uint8_t ackPayload(uint8_t * ack);							//writes the SEGMENT_ACK payload for the current transfer
+	bool isComplete(void);										//returns true once every fragment has been received
+	uint16_t getLength(void);									//returns the reassembled payload length once complete
+	uint8_t getTransferID(void);								//returns the ID of the current transfer
+	uint32_t getReceivedBitmap(void);							//returns the bitmap of received fragments
+private:
+	uint8_t * buffer;											//!< Reassembly buffer.  Not owned.
+	uint16_t capacity;											//!< Size of the reassembly buffer
+	uint16_t length;											//!< Payload length, known once the last fragment arrives
+	uint8_t transferID;											//!< ID of the current transfer
+	uint8_t fragmentCount;										//!< Number of fragments in the current transfer.  Zero if none yet.
+	uint32_t received;											//!< Bitmap of received fragments
+};
+
+#endif /* VN210SEGMENT_H_ */
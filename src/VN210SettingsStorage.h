@@ -0,0 +1,74 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210Config.h"
+#include <stdint.h>
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#endif
+
+#ifndef VN210SETTINGSSTORAGE_H_
+#define VN210SETTINGSSTORAGE_H_
+
+// Warm start record: marker (1), hardware platform (1), max buffer size (2), max SPI speed (1), firmware version (2),
+// polling frequency (1), SPI speed (1), radio information held (1) and checksum (1).  Multi-byte fields MSB first.
+#define VN210_SETTINGS_RECORD_SIZE 11
+#define VN210_SETTINGS_RECORD_MARKER 0x5B		//change if the layout changes, so old records are ignored
+
+// Radio information held in the record, one bit per API query
+#define VN210_INFO_HW_PLATFORM 0x01
+#define VN210_INFO_MAX_BUFFER 0x02
+#define VN210_INFO_MAX_SPI_SPEED 0x04
+#define VN210_INFO_FW_VERSION 0x08
+#define VN210_INFO_ALL 0x0F
+
+// Info queries sent automatically after the radio starts polling, before giving up on one it doesn't answer
+#define VN210_INFO_MAX_QUERIES 16
+
+/**
+ * Where the warm start record is kept (see VN210SimpleAPI::setSettingsStorage()).
+ * The record is VN210_SETTINGS_RECORD_SIZE bytes, read and written whole.
+ */
+class VN210SettingsStorage {
+public:
+	virtual void read(uint8_t * out, uint8_t length) = 0;			//copies the stored record to 'out'. anything will do if nothing was stored
+	virtual void write(const uint8_t * in, uint8_t length) = 0;		//stores the record in 'in'
+};
+
+#if defined(__AVR__)
+/**
+ * Warm start record in the AVR's EEPROM, starting at 'address'.  Only bytes
+ * which change are written, and the record only changes when the radio's
+ * information or settings do, so wear isn't a concern.
+ */
+class VN210SettingsEEPROM : public VN210SettingsStorage {
+public:
+	VN210SettingsEEPROM(uint16_t address) : address(address) {}
+
+	void read(uint8_t * out, uint8_t length) { eeprom_read_block(out, (const void *) (size_t) this->address, length); }
+	void write(const uint8_t * in, uint8_t length) { eeprom_update_block(in, (void *) (size_t) this->address, length); }
+private:
+	uint16_t address;												//!< EEPROM address of the record
+};
+#endif
+
+#endif /* VN210SETTINGSSTORAGE_H_ */
@@ -26,27 +26,56 @@
  * Class constructor.  Must be passed in a transport
  * layer instance.   Initialises the zero payload to zero.
  */
-VN210SimpleAPI::VN210SimpleAPI(VN210RxTx * dl) : zeroPayload (MSG_DATA_ZERO_VALUE) {
+VN210SimpleAPI::VN210SimpleAPI(VN210RxTx * dl) : zeroPayload (MSG_DATA_ZERO_VALUE), uapStore (&uapData) {
 	this->dl = dl;		//handle to the transport layer.
+	this->settings.pollingFrequency = 0;
+	this->settings.spiSpeed = 0;
+	this->settings.attributeStore = &this->uapStore;
+#if VN210_UAP_SNAPSHOT
+	this->settings.interruptReads = false;
+#endif
+	this->settingsStaged = false;
+#if VN210_DUPLICATE_CACHE_SIZE && VN210_UAP_SNAPSHOT
+	this->interruptReadsCounted = 0;
+#endif
+	this->radioReady = false;
+	this->resendPollingFrequency = false;
+	this->resendSPISpeed = false;
+#if VN210_WARM_START
+	this->settingsStorage = NULL;
+	this->infoHeld = 0;
+	this->firmwareChecked = false;
+	this->infoQueries = 0;
+#endif
+	this->nextTransferID = 0;
+	this->pollsSinceFragment = 0;
+#if VN210_HISTORY_LENGTH
+	this->historySending = false;
+#endif
+#if VN210_LINK_MISSED_POLLS
+	this->pollReceived = false;
+#endif
 }
 
 /**
  * SimpleAPI instantiation method.  starts
  * the transport layer, signalling the VN210.
  *
- * The VN210 seems to take about 5 before sending polling messages
- * after boot.
+ * The VN210 takes about 5 s to start polling after boot.  There's no need to
+ * wait: messages queued meanwhile are sent once it does, as are any polling
+ * frequency and SPI speed set before (or restored by setSettingsStorage()).
+ * isRadioReady() returns true from the first poll.
  */
 void VN210SimpleAPI::begin(bool wakeupSupportEnabled) {
 	this->dl->wakeupViaHWEnabled(wakeupSupportEnabled);
 
 	//TODO can API_STX be defined statically in the message struct?
 	txMessage.STX = API_STX;
-	rxMessage.STX = API_STX;
-	rxMessage.messageType = 0;
+	this->rxFrame = VN210FrameView();
+	this->lastMessageID = 0;
 
-	//point the transport layer response to this response.
-	this->dl->rxMessage = &this->rxMessage;
+	//point the transport layer's view of received frames at this one.
+	this->dl->rxFrame = &this->rxFrame;
 
 	//register new message flag with the transport layer.  this allows DL to tell the API when a new message is received.
 	//this should give the DL a pointer to the API new message flag.
@@ -54,6 +83,26 @@ void VN210SimpleAPI::begin(bool wakeupSupportEnabled) {
 
 	//initialise the transport layer
 	this->dl->begin();
+	this->txQueue.begin(this->dl, &this->txMessage);
+
+	//the queue has just been emptied, so the radio needs its settings again
+	this->radioReady = false;
+	this->resendPollingFrequency = true;
+	this->resendSPISpeed = true;
+
+#if VN210_DUPLICATE_CACHE_SIZE
+	this->recentWrites.clear();		//the radio starts its message IDs again after a reset
+#endif
+
+#if VN210_LINK_MISSED_POLLS
+	this->linkMonitor.restart();
+	this->pollReceived = false;
+#endif
+
+#if VN210_UAP_SNAPSHOT
+	this->publish();
+	this->setInterruptReads(this->settings.interruptReads);		//begin() removes the interrupt handler
+#endif
 }
 
 /**
@@ -62,6 +111,11 @@ void VN210SimpleAPI::begin(bool wakeupSupportEnabled) {
  * This method doesn't return anything as its effect is completely transparent to the microcontroller.
  */
 void VN210SimpleAPI::updateSPISpeed(VN210_SPISpeed speed) {
+	this->settings.spiSpeed = speed;
+	this->resendSPISpeed = false;
+#if VN210_WARM_START
+	this->saveSettings();
+#endif
 	//cast speed pointer to a byte pointer - its just one byte.
 	this->send(MSG_HEADER_API_REQUEST, API_UPDATE_SPI_SPEED, MSG_DATA_ONE_BYTE_SIZE, (uint8_t*) &speed);
 }
@@ -72,11 +126,22 @@ void VN210SimpleAPI::updateSPISpeed(VN210_SPISpeed speed) {
  * Returns the response header, which will either signify an ACK or NACK
  */
 void VN210SimpleAPI::updatePollingFrequency(VN210_PollingFrequency freq) {
+	this->settings.pollingFrequency = freq;
+	this->resendPollingFrequency = false;
+#if VN210_WARM_START
+	this->saveSettings();
+#endif
+#if VN210_LINK_MISSED_POLLS
+	this->linkMonitor.setExpectedInterval(freq == Poll_500ms ? 500 : (freq == Poll_1s ? 1000 : 60000));
+#endif
 	this->send(MSG_HEADER_API_REQUEST, API_UPDATE_POLLING_FREQ, MSG_DATA_ONE_BYTE_SIZE, (uint8_t*) &freq);
 }
 
 /**
  * API command.  Requests the maximum buffer size of the radio.
+ *
+ * Frames from the radio are never longer than this, so VN210_BUFFER_SIZE in
+ * VN210Config.h can be reduced to the reported value to save RAM.
  */
 void VN210SimpleAPI::getMaxBufferSize(void) {
 	this->send(MSG_HEADER_API_REQUEST, API_MAX_BUFFER, MSG_DATA_ONE_BYTE_SIZE, (uint8_t*) &zeroPayload);
@@ -102,77 +167,377 @@ void VN210SimpleAPI::getHardwarePlatform(void) {
  * This is returned as 2 bytes: MSB is the major version, LSB is the minor version.
  */
 void VN210SimpleAPI::getFirmwareVersion(void) {
-	return this->send(MSG_HEADER_API_REQUEST, API_FW_VERSION, MSG_DATA_ONE_BYTE_SIZE, (uint8_t*) &zeroPayload);
+	this->send(MSG_HEADER_API_REQUEST, API_FW_VERSION, MSG_DATA_ONE_BYTE_SIZE, (uint8_t*) &zeroPayload);
+}
+
+/**
+ * Sets the attribute store that passthrough write and read requests from the radio
+ * go to.  Use a VN210SchemaStore to expose application data with its own schema.
+ * Passing NULL goes back to uapData.
+ */
+void VN210SimpleAPI::setAttributeStore(VN210AttributeStore * store) {
+	this->settings.attributeStore = store != NULL ? store : &this->uapStore;
+}
+
+/**
+ * Returns the settings in use.  Settings changed with the individual calls
+ * (updatePollingFrequency(), setAttributeStore(), ...) show up here straight away.
+ */
+const VN210SimpleAPI::VN210Settings & VN210SimpleAPI::getSettings(void) {
+	return this->settings;
+}
+
+/**
+ * Stages a complete set of settings, usually a copy of getSettings() with some
+ * fields changed.  Nothing changes until the radio sends API_FW_ACTIVATION_REQ:
+ * the staged settings are then applied together between two frames, and the
+ * request is acknowledged with ACK_FW_UPGRADE_OK.  Staging again before then
+ * replaces the staged settings.  The settings are copied, so they can be built
+ * up over several loop() passes without a half-written set being activated.
+ */
+void VN210SimpleAPI::stageSettings(const VN210Settings & settings) {
+	this->stagedSettings = settings;
+	this->settingsStaged = true;
+}
+
+/**
+ * Returns true if settings have been staged and not yet activated.
+ */
+bool VN210SimpleAPI::hasStagedSettings(void) {
+	return this->settingsStaged;
+}
+
+#if VN210_WARM_START
+/**
+ * Keeps the radio's information (info, apart from crcValid) and the polling
+ * frequency and SPI speed in 'storage', e.g. a VN210SettingsEEPROM, so that a
+ * restarted node doesn't have to ask the radio for them all again.  Call before
+ * begin().  NULL stops storing them.
+ *
+ * If the storage holds a valid record it is restored straight away: info is
+ * filled in, and the polling frequency and SPI speed are sent to the radio when
+ * it first polls.  The radio is then only asked for its firmware version.  If
+ * that has changed, or nothing was stored, the other info fields are asked for
+ * one at a time as the radio polls.  hasInfo() returns true once all are valid.
+ * The record is written whenever any of them change.
+ */
+void VN210SimpleAPI::setSettingsStorage(VN210SettingsStorage * storage) {
+	uint8_t record[VN210_SETTINGS_RECORD_SIZE];
+
+	this->settingsStorage = storage;
+	if (storage == NULL) return;
+
+	storage->read(record, sizeof(record));
+
+	if (record[0] != VN210_SETTINGS_RECORD_MARKER || record[VN210_SETTINGS_RECORD_SIZE - 1] != settingsChecksum(record)) {
+		this->saveSettings();
+		return;
+	}
+
+	this->info.hwPlatform = record[1];
+	this->info.maxBufferSize = ((uint16_t) record[2] << 8) | record[3];
+	this->info.maxSPISpeed = record[4];
+	this->info.firmwareVersion = ((uint16_t) record[5] << 8) | record[6];
+	this->settings.pollingFrequency = record[7];
+	this->settings.spiSpeed = record[8];
+
+	//hasInfo() stays false until the radio's firmware version has been checked
+	this->infoHeld = record[9] & VN210_INFO_ALL;
+}
+
+/**
+ * Returns true once every info field is valid: restored from the settings
+ * storage and confirmed by the radio's firmware version, or asked for since.
+ */
+bool VN210SimpleAPI::hasInfo(void) {
+	return this->firmwareChecked && this->infoHeld == VN210_INFO_ALL;
+}
+
+/**
+ * Records that an info field has been received from the radio, stores it, and
+ * asks for the next one missing.
+ */
+void VN210SimpleAPI::infoReceived(uint8_t field) {
+	this->infoHeld |= field;
+	this->saveSettings();
+	this->queryInfo();
+}
+
+/**
+ * Asks the radio for the first info field not held, with settings storage set,
+ * once the radio is ready and as long as nothing else is waiting to be sent.
+ * The firmware version comes first, as it decides whether the rest is still
+ * valid.  Gives up after VN210_INFO_MAX_QUERIES, in case the radio never answers.
+ */
+void VN210SimpleAPI::queryInfo(void) {
+	if (this->settingsStorage == NULL || !this->radioReady || this->hasInfo()) return;
+	if (this->infoQueries >= VN210_INFO_MAX_QUERIES || !this->txQueue.isEmpty() || this->dl->hasMessageToSend()) return;
+
+	this->infoQueries++;
+
+	if (!this->firmwareChecked) this->getFirmwareVersion();
+	else if (!(this->infoHeld & VN210_INFO_HW_PLATFORM)) this->getHardwarePlatform();
+	else if (!(this->infoHeld & VN210_INFO_MAX_BUFFER)) this->getMaxBufferSize();
+	else this->getMaxSPISpeed();
+}
+
+/**
+ * Writes info, the polling frequency and SPI speed to the settings storage, if
+ * set, unless it already holds the same record.
+ */
+void VN210SimpleAPI::saveSettings(void) {
+	uint8_t record[VN210_SETTINGS_RECORD_SIZE];
+	uint8_t stored[VN210_SETTINGS_RECORD_SIZE];
+
+	if (this->settingsStorage == NULL) return;
+
+	record[0] = VN210_SETTINGS_RECORD_MARKER;
+	record[1] = this->info.hwPlatform;
+	record[2] = this->info.maxBufferSize >> 8;
+	record[3] = this->info.maxBufferSize & 0xFF;
+	record[4] = this->info.maxSPISpeed;
+	record[5] = this->info.firmwareVersion >> 8;
+	record[6] = this->info.firmwareVersion & 0xFF;
+	record[7] = this->settings.pollingFrequency;
+	record[8] = this->settings.spiSpeed;
+	record[9] = this->infoHeld;
+	record[10] = settingsChecksum(record);
+
+	this->settingsStorage->read(stored, sizeof(stored));
+	if (memcmp(record, stored, sizeof(record)) != 0) this->settingsStorage->write(record, sizeof(record));
+}
+
+/**
+ * Returns the checksum of a warm start record: the two's complement of the sum
+ * of every byte before it.
+ */
+uint8_t VN210SimpleAPI::settingsChecksum(const uint8_t * record) {
+	uint8_t sum = 0;
+
+	for (uint8_t i = 0; i < VN210_SETTINGS_RECORD_SIZE - 1; i++) sum += record[i];
+
+	return -sum;
+}
+#endif
+
+#if VN210_UAP_SNAPSHOT
+/**
+ * Publishes the current attribute values (uapData, or the store set with
+ * setAttributeStore()) for the radio to read.  Call this once a consistent set
+ * of values has been written.  Reads keep returning the previously published
+ * values until then.
+ */
+void VN210SimpleAPI::publish(void) {
+	this->snapshot.publish(this->settings.attributeStore);
+}
+
+/**
+ * Enables or disables answering read requests in the SPI interrupt.  When
+ * enabled, the read response is packed as soon as the request's last byte
+ * arrives and is clocked out in the same exchange, instead of waiting for
+ * hasNewMessage() and the next poll.  Read requests which arrive while another
+ * message is waiting to be sent still go through handleMessage().
+ */
+void VN210SimpleAPI::setInterruptReads(bool enabled) {
+	this->settings.interruptReads = enabled;
+	this->dl->registerInterruptHandler(enabled ? &this->snapshot : NULL);
+}
+#endif
+
+/**
+ * Starts sending a payload which is too large for a single frame.  The payload is
+ * split into SEGMENT_DATA fragments, which are sent one per exchange with the radio
+ * whenever no other message is waiting.  Fragments the receiver reports missing
+ * are sent again.  Any transfer already in progress is abandoned.
+ *
+ * The payload is not copied, so it must not change until segmentSender.isActive()
+ * returns false.  Returns false if the payload is larger than VN210_SEGMENT_MAX_PAYLOAD.
+ */
+bool VN210SimpleAPI::sendSegmented(const uint8_t * payload, uint16_t length) {
+	this->pollsSinceFragment = 0;
+#if VN210_HISTORY_LENGTH
+	this->historySending = false;
+#endif
+	return this->segmentSender.begin(payload, length, this->nextTransferID++);
+}
+
+/**
+ * Sets the buffer which incoming segmented payloads are reassembled into.  Call
+ * segmentReceiver.isComplete() to find out when a payload has arrived.  Calling this
+ * again clears the receiver ready for the next payload.
+ */
+void VN210SimpleAPI::receiveSegmented(uint8_t * buffer, uint16_t capacity) {
+	this->segmentReceiver.begin(buffer, capacity);
+}
+
+/**
+ * Data pass-through method.  Handles a fragment of a segmented transfer from the radio,
+ * replying with the bitmap of fragments received so far.  Fragments are ignored
+ * if no buffer has been set with receiveSegmented().
+ */
+void VN210SimpleAPI::segmentDataRequest(void) {
+	if (this->segmentReceiver.addFragment(this->rxFrame.data(), this->rxFrame.dataSize())) {
+		uint8_t size = this->segmentReceiver.ackPayload(this->dataBuffer);
+		this->send(MSG_CLASS_DATA_PASSTHROUGH | MSG_TYPE_RESPONSE, SEGMENT_ACK, size, this->dataBuffer);
+	}
+}
+
+/**
+ * Data pass-through method.  Handles the receiver's acknowledgement of an outgoing
+ * segmented transfer.  Missing fragments are queued to be sent again.
+ */
+void VN210SimpleAPI::segmentAck(void) {
+	if (this->segmentSender.acknowledge(this->rxFrame.data(), this->rxFrame.dataSize())) {
+		this->pollsSinceFragment = 0;
+	}
+}
+
+#if VN210_HISTORY_LENGTH
+/**
+ * Data pass-through method.  Handles a request from the radio for history
+ * entries from a sequence number onwards (2 bytes, MSB first), optionally
+ * limited to a number of entries (1 byte).  The entries are sent as a segmented
+ * transfer, replacing any unfinished history transfer, as the radio has given
+ * up on it.  Ignored while one of the application's segmented transfers is
+ * being sent: the radio should ask again.
+ */
+void VN210SimpleAPI::historyReadRequest(void) {
+	if (this->rxFrame.dataSize() < 2) return;
+	if (this->segmentSender.isActive() && !this->historySending) return;
+
+	uint8_t maxEntries = this->rxFrame.dataSize() > 2 ? this->rxFrame.data(2) : 0;
+	uint16_t length = this->history.read(this->rxFrame.data16(0), maxEntries, this->historyBuffer);
+
+	this->historySending = this->sendSegmented(this->historyBuffer, length);
+}
+#endif
+
+/**
+ * Sends the next fragment of an outgoing segmented transfer, as long as no
+ * other message is waiting to be sent.
+ */
+void VN210SimpleAPI::sendNextFragment(void) {
+	if (this->segmentSender.hasFragmentToSend() && this->txQueue.isEmpty()) {
+		uint8_t size = this->segmentSender.nextFragment(this->dataBuffer);
+		this->send(MSG_CLASS_DATA_PASSTHROUGH | MSG_TYPE_REQUEST, SEGMENT_DATA, size, this->dataBuffer);
+		this->pollsSinceFragment = 0;
+	}
+}
+
+/**
+ * API command handler.  Acknowledges the activation request with
+ * ACK_FW_UPGRADE_OK, then applies any staged settings.  Runs from handleMessage(),
+ * so the switch happens between frames, with no passthrough request half handled.
+ *
+ * With VN210_UAP_SNAPSHOT the new attribute store is published before interrupt
+ * reads are switched over, so no read is answered from a mix of the two.  Polling
+ * frequency and SPI speed requests are only sent to the radio if they changed,
+ * and go out after the acknowledgement.  With nothing staged the request is just
+ * acknowledged.
+ */
+void VN210SimpleAPI::activateSettings(void) {
+	//queued ahead of any API commands sent below
+	this->send(MSG_CLASS_ACK | MSG_TYPE_RESPONSE, ACK_FW_UPGRADE_OK, MSG_DATA_ZERO_BYTE_SIZE, NULL);
+
+	if (!this->settingsStaged) return;
+	this->settingsStaged = false;
+
+	VN210Settings & next = this->stagedSettings;
+
+	this->setAttributeStore(next.attributeStore);
+
+#if VN210_UAP_SNAPSHOT
+	this->publish();
+	if (next.interruptReads != this->settings.interruptReads) this->setInterruptReads(next.interruptReads);
+#endif
+
+	if (next.spiSpeed != 0 && next.spiSpeed != this->settings.spiSpeed) {
+		this->updateSPISpeed((VN210_SPISpeed) next.spiSpeed);
+	}
+	if (next.pollingFrequency != 0 && next.pollingFrequency != this->settings.pollingFrequency) {
+		this->updatePollingFrequency((VN210_PollingFrequency) next.pollingFrequency);
+	}
+}
+
+/**
+ * API command handler.  Handles the first poll after begin() or a radio reset:
+ * the radio is ready, so it is sent the polling frequency and SPI speed it had
+ * before, if they were set and haven't been sent since.
+ */
+void VN210SimpleAPI::radioStarted(void) {
+	this->radioReady = true;
+#if VN210_WARM_START
+	this->firmwareChecked = false;		//the radio's firmware may have been upgraded
+	this->infoQueries = 0;
+#endif
+
+	if (this->resendSPISpeed && this->settings.spiSpeed != 0) {
+		this->updateSPISpeed((VN210_SPISpeed) this->settings.spiSpeed);
+	}
+	if (this->resendPollingFrequency && this->settings.pollingFrequency != 0) {
+		this->updatePollingFrequency((VN210_PollingFrequency) this->settings.pollingFrequency);
+	}
+
+	this->resendSPISpeed = false;
+	this->resendPollingFrequency = false;
 }
 
 /**
  * Data pass-through method. Handles a write request from the radio, putting the
- * data into the local uapData store.
+ * data into the attribute store (uapData unless setAttributeStore() was called).
+ * Attributes with IDs not in the store's schema are skipped.  A retransmission
+ * of a recent write is acknowledged but not applied again.
  */
 void VN210SimpleAPI::writeDataRequest(void) {
-	uint8_t volatile * ptr = rxMessage.data;
-	uint8_t attributeID;
-
-	for (int i = 0; i < rxMessage.dataSize / 5; i++) {
-		attributeID = *ptr++;
-
-		switch (attributeID) {			//get the attribute ID and increment the pointer
-			case 1:
-			case 2:
-			case 3:
-			case 4:
-				for (int j = 3; j >=0; j--) {
-					this->uapData.analogs[attributeID - 1].bytes[j] = *ptr++;
-				}
-				break;
-			case 16:
-			case 17:
-			case 18:
-			case 19:
-				this->uapData.digitals[attributeID - 16] = ptr[3];
-				ptr += 4;
-				break;
-		}
+	const uint8_t * ptr = this->rxFrame.data();
+
+#if VN210_DUPLICATE_CACHE_SIZE
+	//the radio resent a write we've already applied, e.g. because our ACK was lost. just ACK it again.
+	if (this->recentWrites.seen(this->rxFrame)) {
+		this->send(MSG_CLASS_ACK | MSG_TYPE_RESPONSE, ACK_DATA_RECEIVED, MSG_DATA_ZERO_BYTE_SIZE, NULL);
+		return;
+	}
+#endif
+
+	for (uint8_t i = 0; i < this->rxFrame.dataSize() / VN210_ATTRIBUTE_SIZE; i++) {
+		this->settings.attributeStore->writeAttribute(ptr[0], ptr + 1);		//ID, then the 4 byte value
+		ptr += VN210_ATTRIBUTE_SIZE;
 	}
 
+#if VN210_UAP_SNAPSHOT
+	this->publish();		//reads should see what the radio just wrote
+#endif
+
 	this->send(MSG_CLASS_ACK | MSG_TYPE_RESPONSE, ACK_DATA_RECEIVED, MSG_DATA_ZERO_BYTE_SIZE, NULL);
 }
 
 /**
  * Data pass-through method. Handles a read request from the radio for data,
  * preparing data to be sent via readDataResponse().
+ *
+ * IDs not in the attribute store's schema are left out of the response, as are
+ * any requested attributes beyond API_READ_MAX_ATTRIBUTES.  With a small
+ * VN210_BUFFER_SIZE a longer response might not fit the transmit buffer once
+ * escaped, and would be dropped.
  */
 void VN210SimpleAPI::readDataRequest(void) {
-	uint8_t attributeID;
-	uint8_t attributeCount = rxMessage.dataSize;
+	const uint8_t * ids = this->rxFrame.data();
 	uint8_t * buff = this->dataBuffer;		//get a pointer to the buffer to use for writing
+	uint8_t attributeCount = 0;
 
+#if VN210_UAP_SNAPSHOT
+	//consistent values from the last publish
+	attributeCount = this->snapshot.read(ids, this->rxFrame.dataSize(), buff, API_READ_MAX_ATTRIBUTES);
+#else
 	//get the value for each of the requested attributes
-	for (int i = 0; i < attributeCount; i++) {
-		attributeID = rxMessage.data[i];
-		*buff = attributeID; 		//get the next attribute ID and put it into the data buffer
-		buff++;
-
-		switch (attributeID) {
-			case 1:
-			case 2:
-			case 3:
-			case 4:
-				for (int j = 3; j >= 0; j--) {
-					*buff = this->uapData.analogs[attributeID - 1].bytes[j];
-					buff++;
-				}
-				break;
-			case 16:
-			case 17:
-			case 18:
-			case 19:
-				for (int j = 0; j < 3; j++) *buff++ = 0;				//pad three zeros
-				*buff = this->uapData.digitals[attributeID - 16];	//set the LSB
-				buff++;
-				break;
+	for (uint8_t i = 0; i < this->rxFrame.dataSize() && attributeCount < API_READ_MAX_ATTRIBUTES; i++) {
+		if (this->settings.attributeStore->readAttribute(ids[i], buff + 1)) {
+			buff[0] = ids[i];
+			buff += VN210_ATTRIBUTE_SIZE;
+			attributeCount++;
 		}
 	}
+#endif
 
 	//respond to read request
 	this->readDataResponse(attributeCount, this->dataBuffer);
@@ -185,73 +550,219 @@ void VN210SimpleAPI::readDataRequest(void) {
  * - attributes is an array of 4-byte attribute values, length (attributeCount * 4).
  */
 void VN210SimpleAPI::readDataResponse(uint8_t attributeCount, uint8_t* attributes) {
-	this->send(MSG_CLASS_DATA_PASSTHROUGH | MSG_TYPE_RESPONSE, READ_DATA_RESPONSE, attributeCount * 5, attributes);
+	this->send(MSG_CLASS_DATA_PASSTHROUGH | MSG_TYPE_RESPONSE, READ_DATA_RESPONSE, attributeCount * VN210_ATTRIBUTE_SIZE, attributes);
 }
 
 /**
- * Sends a message to the VN210 radio.  Also handles message reception so after this returns
- * there should be a new response message.
+ * Sends a message to the VN210 radio.  Responses to the radio's requests are
+ * queued ahead of API commands and segment fragments.  The payload is copied,
+ * so 'data' can be reused straight away.
  *
+ * Returns false if the message was dropped because the transmit queue is full.
  */
-void VN210SimpleAPI::send(uint8_t messageHeader, uint8_t type, uint8_t dataSize, uint8_t *data) {
-	txMessage.header = messageHeader;
-	txMessage.messageType = type;
-	txMessage.messageID = rxMessage.messageID;		//reuse the message ID received from the radio
-	txMessage.dataSize = dataSize;
-	txMessage.data = data;
+bool VN210SimpleAPI::send(uint8_t messageHeader, uint8_t type, uint8_t dataSize, uint8_t *data) {
+	VN210TxPriority priority = (messageHeader & MSG_TYPE_RESPONSE) ? VN210_PRIORITY_RESPONSE : VN210_PRIORITY_ROUTINE;
 
-	this->dl->sendMsg(&txMessage);
+	return this->send(priority, messageHeader, type, dataSize, data);
+}
+
+/**
+ * Queues a message with the given priority, and loads it into the transmit buffer
+ * straight away if it is the most urgent.  With VN210_SHARED_BUFFER, a message
+ * sent while a frame is held (e.g. from handleMessage()) is loaded by the next
+ * hasNewMessage() after the frame is released instead.
+ */
+bool VN210SimpleAPI::send(VN210TxPriority priority, uint8_t messageHeader, uint8_t type, uint8_t dataSize, const uint8_t *data) {
+	//reuse the message ID received from the radio
+	bool queued = this->txQueue.push(priority, messageHeader, type, this->lastMessageID, dataSize, data);
+
+#if VN210_SHARED_BUFFER
+	//the held frame is in the buffer the message would be packed into
+	if (this->rxFrame.size() > 0) return queued;
+#endif
+
+	this->txQueue.service();
+
+	return queued;
+}
+
+/**
+ * Sends an application-defined pass-through request, such as an alarm or threshold
+ * report, ahead of all other outgoing traffic.  A routine message already in the
+ * transmit buffer is swapped out if the radio hasn't started reading it.  The
+ * message type must not clash with the types in MessageType.
+ *
+ * Returns false if the alarm couldn't be queued.
+ */
+bool VN210SimpleAPI::sendAlarm(uint8_t messageType, uint8_t dataSize, const uint8_t * data) {
+	return this->send(VN210_PRIORITY_ALARM, MSG_CLASS_DATA_PASSTHROUGH | MSG_TYPE_REQUEST, messageType, dataSize, data);
 }
 
 /**
  * Checks to see whether there is a new message available from the radio
  * which is not a response to an API command.
  *
- * If there is a new message, it is parsed.  This decouples message parsing from
- * the low-level communications channel (which may be interrupt driven).
+ * If there is a new message, it is parsed and rxFrame is pointed at it.  This
+ * decouples message parsing from the low-level communications channel (which may
+ * be interrupt driven).
+ *
+ * If there is no new message, the previous message is released so the receive
+ * buffer can take the next one, the next fragment of any outgoing segmented
+ * transfer is queued, and the next queued message is loaded for sending.
+ *
+ * In wakeup mode, the radio is also woken here if a request has been queued.
  */
 bool VN210SimpleAPI::hasNewMessage() {
 	bool hasNewMessage = this->hasNewMessageFlag;		//read the flag, its going to be reset when parsed
 
 	if (hasNewMessage) {
 		this->info.crcValid = this->dl->parseMessage();
+		if (this->info.crcValid) this->lastMessageID = this->rxFrame.messageID();
+	} else {
+		this->dl->releaseMessage();
+		this->sendNextFragment();
+
+		//load the next queued message once the radio has read the last one. with a shared
+		//buffer send() leaves this to us while a frame is held, as packing would overwrite it.
+		this->txQueue.service();
 	}
 
+	//wake the radio for anything queued since the last call. several sends between calls share one pulse.
+	this->dl->serviceWakeup();
+
 	return hasNewMessage;
 }
 
+/**
+ * Releases the frame handled by the last handleMessage(), so the receive buffer
+ * can take the next frame.  rxFrame is emptied.  Call once the application has
+ * finished with rxFrame: until then every byte the radio sends is dropped (see
+ * VN210RxTx::droppedBytes).  hasNewMessage() also releases the frame, but only
+ * when it next runs.
+ */
+void VN210SimpleAPI::releaseMessage(void) {
+	this->dl->releaseMessage();
+}
+
+/**
+ * Returns true if there is nothing for the main loop to do until the next
+ * interrupt: no frame arriving or waiting to be handled, no queued message or
+ * segment fragment waiting for the transmit buffer to empty, and no wakeup
+ * waiting to be sent.  A message already in the transmit buffer doesn't count,
+ * as the SPI interrupt sends it.  Call after hasNewMessage() has been called
+ * with nothing new, e.g. from VN210Scheduler::idle().
+ */
+bool VN210SimpleAPI::isIdle(void) {
+	if (this->hasNewMessageFlag) return false;
+
+	//the transmit buffer has emptied and something is waiting to be loaded into it
+	if (!this->dl->hasMessageToSend() && (!this->txQueue.isEmpty() || this->segmentSender.hasFragmentToSend())) return false;
+
+	return this->dl->isIdle();
+}
+
+/**
+ * Asks the radio to poll straight away, without a message to send, e.g. to pick
+ * up a response sooner.  The WKU pulse is sent by the next hasNewMessage().
+ * Ignored unless wakeup support was enabled in begin().
+ */
+void VN210SimpleAPI::requestWakeup() {
+	this->dl->requestWakeup();
+}
+
 /**
  * Handles all requests from the VN210 radio.
  */
 void VN210SimpleAPI::handleMessage() {
+#if VN210_DUPLICATE_CACHE_SIZE
+	//every frame from the radio moves its message IDs on, including reads answered in the interrupt
+#if VN210_UAP_SNAPSHOT
+	uint16_t interruptReads = this->snapshot.interruptReads;
+	this->recentWrites.passed(interruptReads - this->interruptReadsCounted);
+	this->interruptReadsCounted = interruptReads;
+#endif
+	if (this->rxFrame.messageClass() != DATA_PASS_THROUGH || this->rxFrame.messageType() != WRITE_DATA_REQUEST) {
+		this->recentWrites.passed(1);
+	}
+#endif
+
 	//handle messages
-	switch (this->getMessageClass(&rxMessage)) {
+	switch (this->rxFrame.messageClass()) {
 		case DATA_PASS_THROUGH:
-			switch (this->rxMessage.messageType) {
+			switch (this->rxFrame.messageType()) {
 				case WRITE_DATA_REQUEST:
 					this->writeDataRequest();
 					break;
 				case READ_DATA_REQUEST:
 					this->readDataRequest();
+					break;
+				case SEGMENT_DATA:
+					this->segmentDataRequest();
+					break;
+				case SEGMENT_ACK:
+					this->segmentAck();
+					break;
+#if VN210_HISTORY_LENGTH
+				case HISTORY_READ_REQUEST:
+					this->historyReadRequest();
+					break;
+#endif
 			}
 			break;
 		case API_COMMAND:
-			switch (this->rxMessage.messageType) {
+			switch (this->rxFrame.messageType()) {
 				case API_HW_PLATFORM:					//got HW platform code - copy it to flags
-					this->info.hwPlatform = this->rxMessage.data[1];
+					this->info.hwPlatform = this->rxFrame.data(1);
+#if VN210_WARM_START
+					this->infoReceived(VN210_INFO_HW_PLATFORM);
+#endif
 					break;
 				case API_FW_VERSION:				//got API FW version. copy to flags.
-					this->info.firmwareVersion = (this->rxMessage.data[0] << 8) | this->rxMessage.data[1];
+#if VN210_WARM_START
+					//info kept from other firmware may no longer be right
+					if (this->rxFrame.data16(0) != this->info.firmwareVersion) this->infoHeld = 0;
+					this->firmwareChecked = true;
+#endif
+					this->info.firmwareVersion = this->rxFrame.data16(0);
+#if VN210_WARM_START
+					this->infoReceived(VN210_INFO_FW_VERSION);
+#endif
 					break;
 				case API_MAX_BUFFER:
-					this->info.maxBufferSize = (this->rxMessage.data[0] << 8) | this->rxMessage.data[1];
+					this->info.maxBufferSize = this->rxFrame.data16(0);
+#if VN210_WARM_START
+					this->infoReceived(VN210_INFO_MAX_BUFFER);
+#endif
 					break;
 				case API_MAX_SPI_SPEED:
-					this->info.maxSPISpeed = this->rxMessage.data[0];
+					this->info.maxSPISpeed = this->rxFrame.data(0);
+#if VN210_WARM_START
+					this->infoReceived(VN210_INFO_MAX_SPI_SPEED);
+#endif
 					break;
 				case API_POLLING:
+#if VN210_LINK_MISSED_POLLS
+					this->pollReceived = true;
+#endif
+					if (!this->radioReady) this->radioStarted();
+#if VN210_WARM_START
+					this->queryInfo();
+#endif
+					//all fragments sent but no acknowledgement? send the missing ones again, or give up after VN210_SEGMENT_MAX_RETRIES.
+					if (this->segmentSender.isActive() && !this->segmentSender.hasFragmentToSend()
+							&& ++this->pollsSinceFragment >= VN210_SEGMENT_RETRY_POLLS) {
+						this->segmentSender.retransmitUnacknowledged();
+						this->pollsSinceFragment = 0;
+					}
+					break;
+				case API_FW_ACTIVATION_REQ:
+#if VN210_WARM_START
+					//new radio firmware: check the version again at the next poll
+					this->firmwareChecked = false;
+					this->infoQueries = 0;
+#endif
+					this->activateSettings();
 					break;
-				case API_FW_ACTIVATION_REQ: /* TODO: do something */ break;
 			}
 			break;
 		case ACK:
@@ -272,8 +783,52 @@ uint8_t VN210SimpleAPI::getMessageClass(VN210_APIMessage * message) {
  * Returns true if the most recent message was a polling message, false otherwise.
  */
 bool VN210SimpleAPI::receivedPollingMessage(void) {
-	 return (getMessageClass(&rxMessage) == API_COMMAND) && (rxMessage.messageType == API_POLLING);
+	 return (this->rxFrame.messageClass() == API_COMMAND) && (this->rxFrame.messageType() == API_POLLING);
+}
+
+/**
+ * Returns true once the radio has polled since begin(), or since checkLink()
+ * last reset it: it has booted and is exchanging messages.
+ */
+bool VN210SimpleAPI::isRadioReady(void) {
+	return this->radioReady;
+}
+
+#if VN210_LINK_MISSED_POLLS
+/**
+ * Keeps an eye on the link to the radio.  Call from loop() as often as possible
+ * with the current time in milliseconds, e.g. millis(), after handling any new
+ * message: a poll handled since the last call is timed now, so the timing is
+ * only as fine as the loop.  Intervals go into linkMonitor's histogram.
+ *
+ * If the radio has stopped polling, it is reset (a 2 ms pulse, not the full
+ * begin()), write retransmission tracking is cleared as its message IDs start
+ * again, and any polling frequency and SPI speed set are sent again once it
+ * polls.  Further resets back off while it stays silent (see VN210LinkMonitor.h).
+ *
+ * NOTE: the reset pulse is timed with delay() in resetRadio(), so a call which
+ * resets the radio blocks the main loop for about 2 ms.
+ */
+void VN210SimpleAPI::checkLink(uint32_t now) {
+	if (this->pollReceived) {
+		this->pollReceived = false;
+		this->linkMonitor.poll(now);
+		return;
+	}
+
+	if (!this->linkMonitor.resetDue(now)) return;
+
+	this->dl->resetRadio();
+
+#if VN210_DUPLICATE_CACHE_SIZE
+	this->recentWrites.clear();
+#endif
+
+	this->radioReady = false;
+	this->resendPollingFrequency = true;
+	this->resendSPISpeed = true;
 }
+#endif
 
 /**
  * Puts the radio into provisioning mode.
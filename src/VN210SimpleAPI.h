@@ -21,6 +21,14 @@
  */
 #include "VN210.h"
 #include "VN210RxTx.h"
+#include "VN210Segment.h"
+#include "VN210SettingsStorage.h"
+#include "VN210DuplicateFilter.h"
+#include "VN210LinkMonitor.h"
+#include "VN210History.h"
+#include "VN210Schema.h"
+#include "VN210Snapshot.h"
+#include "VN210TxQueue.h"
 #include <string.h>
 
 #ifndef VN210SIMPLEAPI_H_
@@ -37,6 +45,14 @@
 #define UAP_ATTRIBUTES_COUNT (UAP_ANALOGS_COUNT + UAP_DIGITALS_COUNT)
 #define UAP_ATTRIBUTE_SIZE_BYTES 4
 #define UAP_ATTRIBUTES_BUFFER_SIZE (UAP_ATTRIBUTES_COUNT + (UAP_ATTRIBUTES_COUNT * UAP_ATTRIBUTE_SIZE_BYTES))
+#define UAP_ANALOG_FIRST_ID 1
+#define UAP_DIGITAL_FIRST_ID 16
+
+// the API data buffer holds read responses and segment fragments, so it must fit the larger of the two
+#define API_DATA_BUFFER_SIZE (UAP_ATTRIBUTES_BUFFER_SIZE > VN210_SEGMENT_FRAME_SIZE ? UAP_ATTRIBUTES_BUFFER_SIZE : VN210_SEGMENT_FRAME_SIZE)
+
+// attributes in a read response: as many as fit the data buffer and, escaped, the transmit buffer
+#define API_READ_MAX_ATTRIBUTES (API_DATA_BUFFER_SIZE < VN210_MAX_ESCAPED_DATA_SIZE ? API_DATA_BUFFER_SIZE / VN210_ATTRIBUTE_SIZE : VN210_MAX_ESCAPED_DATA_SIZE / VN210_ATTRIBUTE_SIZE)
 
 // common message header and payload macros
 #define MSG_HEADER_API_REQUEST (MSG_TYPE_REQUEST | MSG_CLASS_API_COMMAND)
@@ -88,6 +104,9 @@ public:
 		WRITE_DATA_REQUEST = 1,
 		READ_DATA_REQUEST = 2,
 		READ_DATA_RESPONSE = 3,
+		SEGMENT_DATA = 4,				//!< Fragment of a segmented transfer.  Application defined - see VN210Segment.h
+		SEGMENT_ACK = 5,				//!< Bitmap of received fragments.  Application defined - see VN210Segment.h
+		HISTORY_READ_REQUEST = 6,		//!< Request for history entries.  Application defined - see VN210History.h
 
 		ACK_DATA_RECEIVED = 1,
 		ACK_SENT_VIA_RF = 2,
@@ -156,6 +175,37 @@ public:
 	 */
 	LocalUAPData uapData;
 
+	/**
+	 * Locates analog register INDEX in LocalUAPData, for the UAP schema.
+	 */
+	template <uint8_t INDEX>
+	struct UAPAnalog {
+		typedef LocalUAPData Store;
+		static float & get(LocalUAPData & data) { return data.analogs[INDEX].value; }
+	};
+
+	/**
+	 * Locates digital register INDEX in LocalUAPData, for the UAP schema.
+	 */
+	template <uint8_t INDEX>
+	struct UAPDigital {
+		typedef LocalUAPData Store;
+		static bool & get(LocalUAPData & data) { return data.digitals[INDEX]; }
+	};
+
+	/**
+	 * Attribute schema of uapData: analogs are attributes 1-4, digitals 16-19.
+	 */
+	typedef VN210SchemaList<VN210Attribute<UAP_ANALOG_FIRST_ID + 0, VN210FloatCodec, UAPAnalog<0> >,
+			VN210SchemaList<VN210Attribute<UAP_ANALOG_FIRST_ID + 1, VN210FloatCodec, UAPAnalog<1> >,
+			VN210SchemaList<VN210Attribute<UAP_ANALOG_FIRST_ID + 2, VN210FloatCodec, UAPAnalog<2> >,
+			VN210SchemaList<VN210Attribute<UAP_ANALOG_FIRST_ID + 3, VN210FloatCodec, UAPAnalog<3> >,
+			VN210SchemaList<VN210Attribute<UAP_DIGITAL_FIRST_ID + 0, VN210BoolCodec, UAPDigital<0> >,
+			VN210SchemaList<VN210Attribute<UAP_DIGITAL_FIRST_ID + 1, VN210BoolCodec, UAPDigital<1> >,
+			VN210SchemaList<VN210Attribute<UAP_DIGITAL_FIRST_ID + 2, VN210BoolCodec, UAPDigital<2> >,
+			VN210SchemaList<VN210Attribute<UAP_DIGITAL_FIRST_ID + 3, VN210BoolCodec, UAPDigital<3> >
+			> > > > > > > > UAPSchema;
+
 	/**
 	 * Local VN210 stack information which is written
 	 * to by API call responses.
@@ -170,10 +220,40 @@ public:
 
 	VN210Properties info;										//!< VN210 stack information.  These are not set until the corresponding API call has been made.
 
+	/**
+	 * Node configuration.  getSettings() returns the settings in use.  A new set
+	 * can be staged with stageSettings() and is applied all at once, between
+	 * frames, when the radio sends API_FW_ACTIVATION_REQ.
+	 */
+	typedef struct {
+		uint8_t pollingFrequency;								//!< VN210_PollingFrequency code requested of the radio, or 0 to leave the radio's own setting
+		uint8_t spiSpeed;										//!< VN210_SPISpeed code requested of the radio, or 0 to leave the radio's own setting
+		VN210AttributeStore * attributeStore;					//!< Where passthrough reads and writes go.  NULL when staged means uapData.
+#if VN210_UAP_SNAPSHOT
+		bool interruptReads;									//!< True if read requests are answered from the SPI interrupt
+#endif
+	} VN210Settings;
+
 	VN210RxTx * dl;												//!< VN210 transport layer pointer.
 
 	VN210_APIMessage txMessage;									//!< The message to be transmitted to the radio
-	VN210_APIMessage rxMessage;									//!< The last received message from the radio
+	VN210FrameView rxFrame;										//!< View of the last received message from the radio.  Valid until the next call to hasNewMessage() or releaseMessage().
+
+	VN210SegmentSender segmentSender;							//!< Outgoing segmented transfer.  Started by sendSegmented().
+	VN210SegmentReceiver segmentReceiver;						//!< Incoming segmented transfer.  Call segmentReceiver.isComplete() to check for a payload.
+	VN210TxQueue txQueue;										//!< Messages waiting to be sent, most urgent first
+
+#if VN210_HISTORY_LENGTH
+	VN210History history;										//!< SCADA snapshots for the radio to fetch after an outage.  Add to it with history.add().
+#endif
+
+#if VN210_LINK_MISSED_POLLS
+	VN210LinkMonitor linkMonitor;								//!< Radio poll timing.  Updated by checkLink().
+#endif
+
+#if VN210_DUPLICATE_CACHE_SIZE
+	VN210DuplicateFilter recentWrites;							//!< Write requests recently applied.  Retransmissions are acknowledged without being applied again.
+#endif
 
 	VN210SimpleAPI(VN210RxTx * dl);
 
@@ -187,11 +267,46 @@ public:
 	void getMaxBufferSize(void);								//fetches the max buffer size from the radio
 	void getMaxSPISpeed(void);									//fetches the max spi speed of the radio.
 
+	//attribute storage
+	void setAttributeStore(VN210AttributeStore * store);		//sets where passthrough reads / writes go. NULL restores uapData.
+
+	//staged configuration
+	const VN210Settings & getSettings(void);					//returns the settings in use
+	void stageSettings(const VN210Settings & settings);			//copies settings to apply at the next API_FW_ACTIVATION_REQ
+	bool hasStagedSettings(void);								//returns true if staged settings are waiting for activation
+
+#if VN210_WARM_START
+	//warm start
+	void setSettingsStorage(VN210SettingsStorage * storage);	//keeps info and settings in 'storage', restoring any kept there. NULL stops
+	bool hasInfo(void);											//returns true once info is complete and checked against the radio's firmware
+#endif
+
+#if VN210_UAP_SNAPSHOT
+	VN210Snapshot snapshot;										//!< Attribute values as last published.  Passthrough reads are answered from here.
+
+	void publish(void);											//makes the current attribute values visible to the radio
+	void setInterruptReads(bool enabled);						//answers read requests straight from the SPI interrupt
+#endif
+
+	//alarms
+	bool sendAlarm(uint8_t messageType, uint8_t dataSize, const uint8_t * data);	//sends a pass-through message ahead of all other traffic
+
+	//segmented transfers
+	bool sendSegmented(const uint8_t * payload, uint16_t length);	//sends a payload larger than a single frame
+	void receiveSegmented(uint8_t * buffer, uint16_t capacity);		//sets the buffer for reassembling incoming segmented payloads
+
 	//utility commands
 	uint8_t getMessageClass(VN210_APIMessage * message);		//returns the message class from the header of the specified message.
 	bool hasNewMessage(void);									//checks whether the radio has sent a message
+	void releaseMessage(void);									//hands the receive buffer back once the application has finished with rxFrame
+	void requestWakeup(void);									//wakes the radio at the next hasNewMessage(), in wakeup mode only
 	void handleMessage();										//handles messages - the highest level of the protocol
 	bool receivedPollingMessage(void);							//Returns true if the most recent message was a polling message, false otherwise.
+	bool isRadioReady(void);									//returns true once the radio has polled since begin() or a reset
+	bool isIdle(void);											//returns true if nothing is waiting for the main loop, so the processor can sleep
+#if VN210_LINK_MISSED_POLLS
+	void checkLink(uint32_t now);								//times polls and resets the radio if it stops polling. call from loop() with millis()
+#endif
 	void provisionRadio(void) __attribute__ ((deprecated));		//Puts the radio into provisioning mode. Deprecated.
 private:
 
@@ -217,17 +332,69 @@ private:
 
 	uint8_t const zeroPayload;										//!< Often a zero-value 1 byte payload is required. This is it.
 
-	uint8_t dataBuffer[UAP_ATTRIBUTES_BUFFER_SIZE];					//!< Buffer used to store data to be sent to the radio
+	uint8_t dataBuffer[API_DATA_BUFFER_SIZE];						//!< Buffer used to store data to be sent to the radio
+
+	VN210SchemaStore<UAPSchema> uapStore;							//!< uapData, accessed through UAPSchema
+
+	VN210Settings settings;											//!< Settings in use
+	VN210Settings stagedSettings;									//!< Settings waiting for activation
+	bool settingsStaged;											//!< Set when stagedSettings is waiting for activation
 
 	bool hasNewMessageFlag;											//!< Flag indicating whether we have a new message.
 
+	uint8_t lastMessageID;											//!< ID of the last message received from the radio, reused in replies
+
+	bool radioReady;												//!< Set by the first poll after begin() or a radio reset
+	bool resendPollingFrequency;									//!< Set when the radio needs the polling frequency again once it is ready
+	bool resendSPISpeed;											//!< Set when the radio needs the SPI speed again once it is ready
+
+#if VN210_WARM_START
+	VN210SettingsStorage * settingsStorage;							//!< Where info and settings are kept, or NULL
+	uint8_t infoHeld;												//!< VN210_INFO_* bits for the info fields which are valid for info.firmwareVersion
+	bool firmwareChecked;											//!< Set once the firmware version has been read from the radio since it started
+	uint8_t infoQueries;											//!< Info queries sent since the radio became ready
+#endif
+
+	uint8_t nextTransferID;											//!< ID used for the next segmented transfer
+	uint8_t pollsSinceFragment;										//!< Polls seen since the last fragment was sent or acknowledged
+
+#if VN210_DUPLICATE_CACHE_SIZE && VN210_UAP_SNAPSHOT
+	uint16_t interruptReadsCounted;									//!< snapshot.interruptReads already counted by recentWrites
+#endif
+
+#if VN210_LINK_MISSED_POLLS
+	bool pollReceived;												//!< Set when a poll is handled, until checkLink() records it
+#endif
+
+#if VN210_HISTORY_LENGTH
+	uint8_t historyBuffer[VN210_HISTORY_TRANSFER_SIZE];				//!< History read reply, held until the segmented transfer is complete
+	bool historySending;											//!< Set while the segmented transfer in progress, if any, is a history read reply
+#endif
+
 	//pass-through data commands
 	void writeDataRequest(void);									//handles writing to the AP by the radio
 	void readDataRequest(void);										//handles reading from the AP by the radio
 	void readDataResponse(uint8_t attributeCount, uint8_t *dataBytes);	//sends attribute values to the radio
+	void segmentDataRequest(void);									//handles a fragment of an incoming segmented transfer
+	void segmentAck(void);											//handles an acknowledgement of outgoing fragments
+#if VN210_HISTORY_LENGTH
+	void historyReadRequest(void);									//sends the history entries the radio asked for
+#endif
+	void sendNextFragment(void);									//sends the next fragment of an outgoing transfer, if nothing else is waiting to be sent
+
+	//API command handlers
+	void activateSettings(void);									//applies staged settings and acknowledges the activation request
+	void radioStarted(void);										//handles the first poll after begin() or a radio reset
+#if VN210_WARM_START
+	void infoReceived(uint8_t field);								//records that an info field (VN210_INFO_*) is valid, saves it and asks for the next
+	void queryInfo(void);											//asks the radio for the next info field not held, if nothing else is waiting
+	void saveSettings(void);										//writes info and settings to the storage, if set and changed
+	static uint8_t settingsChecksum(const uint8_t * record);		//returns the checksum byte of a warm start record
+#endif
 
 	//utility methods
-	void send(uint8_t messageHeader, uint8_t type, uint8_t dataSize, uint8_t *data);
+	bool send(uint8_t messageHeader, uint8_t type, uint8_t dataSize, uint8_t *data);
+	bool send(VN210TxPriority priority, uint8_t messageHeader, uint8_t type, uint8_t dataSize, const uint8_t *data);
 };
 
 #endif /* VN210SIMPLEAPI_H_ */
@@ -0,0 +1,130 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210Snapshot.h"
+
+#if VN210_UAP_SNAPSHOT
+
+/**
+ * Class constructor.  Both slots start empty.
+ */
+VN210Snapshot::VN210Snapshot() {
+	this->counts[0] = 0;
+	this->counts[1] = 0;
+	this->sequence = 0;
+	this->interruptReads = 0;
+}
+
+/**
+ * Encodes every attribute in 'store' into the slot readers aren't using, then
+ * makes it the current slot.  Call this from one place only: the main loop, or
+ * a single interrupt.
+ */
+void VN210Snapshot::publish(VN210AttributeStore * store) {
+	uint8_t spare = (this->sequence + 1) & 1;
+
+	this->counts[spare] = store->readAllAttributes(this->entries[spare], VN210_SNAPSHOT_MAX_ATTRIBUTES);
+
+	this->sequence++;		//single byte write - the new slot is visible to the interrupt all at once
+}
+
+/**
+ * Writes the requested attributes from the current slot to 'out', at most
+ * 'capacity' of them.  Retries if a publish happens while copying.
+ */
+uint8_t VN210Snapshot::read(const uint8_t * ids, uint8_t idCount, uint8_t * out, uint8_t capacity) {
+	uint8_t seq;
+	uint8_t count;
+
+	do {
+		seq = this->sequence;
+		count = this->readSlot(seq & 1, ids, idCount, out, capacity);
+	} while (seq != this->sequence);
+
+	return count;
+}
+
+/**
+ * Returns the number of publishes so far, modulo 256.
+ */
+uint8_t VN210Snapshot::getSequence(void) {
+	return this->sequence;
+}
+
+/**
+ * Answers a passthrough read request from the current slot, in interrupt context.
+ * Any other frame, or a read whose CRC fails, is left for the API.
+ */
+bool VN210Snapshot::handleFrameInInterrupt(VN210RxTx * dl, const VN210FrameView & frame) {
+	if (frame.header() != API_PASSTHROUGH_REQUEST_HEADER || frame.messageType() != API_READ_DATA_REQUEST) {
+		return false;
+	}
+
+	if (!VN210RxTx::isCrcValid(frame)) {
+		return false;
+	}
+
+	//built before packing - with a shared buffer, the reply overwrites the request
+	uint8_t response[VN210_SNAPSHOT_SIZE];
+	uint8_t count = this->readSlot(this->sequence & 1, frame.data(), frame.dataSize(), response, VN210_SNAPSHOT_ISR_ATTRIBUTES);
+
+	VN210_APIMessage msg;
+	msg.STX = API_STX;
+	msg.header = API_PASSTHROUGH_RESPONSE_HEADER;
+	msg.messageType = API_READ_DATA_RESPONSE;
+	msg.messageID = frame.messageID();
+	msg.dataSize = count * VN210_ATTRIBUTE_SIZE;
+	msg.data = response;
+
+	if (!dl->sendMsgFromInterrupt(&msg)) {
+		return false;
+	}
+
+	this->interruptReads++;
+	return true;
+}
+
+/**
+ * Copies the requested attributes out of one slot.
+ */
+uint8_t VN210Snapshot::readSlot(uint8_t slot, const uint8_t * ids, uint8_t idCount, uint8_t * out, uint8_t capacity) {
+	const uint8_t * entries = this->entries[slot];
+	uint8_t available = this->counts[slot];
+	uint8_t count = 0;
+
+	for (uint8_t i = 0; i < idCount && count < capacity; i++) {
+		for (uint8_t j = 0; j < available; j++) {
+			const uint8_t * entry = entries + j * VN210_ATTRIBUTE_SIZE;
+
+			if (entry[0] == ids[i]) {
+				memcpy(out, entry, VN210_ATTRIBUTE_SIZE);
+				out += VN210_ATTRIBUTE_SIZE;
+				count++;
+				break;
+			}
+		}
+	}
+
+	return count;
+}
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210Config.h"
+#include "VN210RxTx.h"
+#include "VN210Schema.h"
+
+#ifndef VN210SNAPSHOT_H_
+#define VN210SNAPSHOT_H_
+
+#define VN210_SNAPSHOT_SIZE (VN210_SNAPSHOT_MAX_ATTRIBUTES * VN210_ATTRIBUTE_SIZE)
+
+//attributes in a read answered from the interrupt, limited so that the escaped response fits the transmit buffer
+#define VN210_SNAPSHOT_ISR_ATTRIBUTES (VN210_SNAPSHOT_MAX_ATTRIBUTES < VN210_MAX_ESCAPED_DATA_SIZE / VN210_ATTRIBUTE_SIZE ? VN210_SNAPSHOT_MAX_ATTRIBUTES : VN210_MAX_ESCAPED_DATA_SIZE / VN210_ATTRIBUTE_SIZE)
+
+/**
+ * Double-buffered snapshot of the encoded attribute values, for answering
+ * passthrough reads.
+ *
+ * publish() encodes every attribute into the slot which isn't in use, then
+ * bumps the sequence number to make it current.  Readers only ever look at the
+ * current slot, so they never see a half-written value or a mix of old and new
+ * values, however the application updates its data between publishes.  If
+ * publish() is called from an interrupt, read() retries until it has copied a
+ * slot without a publish happening part-way through.
+ *
+ * Registered with VN210RxTx::registerInterruptHandler(), the snapshot also
+ * answers READ_DATA_REQUEST frames in the SPI interrupt as soon as they arrive,
+ * so the response goes out in the same exchange rather than a poll later.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup SimpleAPI
+ */
+class VN210Snapshot : public VN210InterruptHandler {
+public:
+	VN210Snapshot();
+
+	void publish(VN210AttributeStore * store);						//encodes every attribute into the spare slot and makes it current
+
+	//writes the requested attributes, as ID + value pairs, to 'out'. unknown IDs are skipped. returns the number written.
+	uint8_t read(const uint8_t * ids, uint8_t idCount, uint8_t * out, uint8_t capacity);
+
+	uint8_t getSequence(void);										//returns the number of publishes, modulo 256
+
+	bool handleFrameInInterrupt(VN210RxTx * dl, const VN210FrameView & frame);	//answers read requests from the current slot
+
+	volatile uint16_t interruptReads;								//!< Number of read requests answered from the interrupt
+private:
+	uint8_t entries[2][VN210_SNAPSHOT_SIZE];						//!< Encoded attributes.  The current slot is sequence & 1
+	uint8_t counts[2];												//!< Number of attributes in each slot
+	volatile uint8_t sequence;										//!< Incremented by each publish
+
+	uint8_t readSlot(uint8_t slot, const uint8_t * ids, uint8_t idCount, uint8_t * out, uint8_t capacity);
+};
+
+#endif /* VN210SNAPSHOT_H_ */
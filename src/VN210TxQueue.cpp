@@ -0,0 +1,242 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "VN210TxQueue.h"
+#include <string.h>
+
+/**
+ * Class constructor.  The queue starts empty, and sends nothing until begin()
+ * has been called.
+ */
+VN210TxQueue::VN210TxQueue() {
+	this->dl = NULL;
+	this->message = NULL;
+	this->count = 0;
+	this->dataUsed = 0;
+	this->loaded = -1;
+	this->loadedSequence = 0;
+	this->dropped = 0;
+}
+
+/**
+ * Empties the queue and sets the transport to send through.  Entries are packed
+ * through 'message', which must already have its STX set.
+ */
+void VN210TxQueue::begin(VN210RxTx * dl, VN210_APIMessage * message) {
+	this->dl = dl;
+	this->message = message;
+	this->count = 0;
+	this->dataUsed = 0;
+	this->loaded = -1;
+	this->dropped = 0;
+}
+
+/**
+ * Queues a message, copying its payload.  Nothing is sent until service() is
+ * called.
+ *
+ * If the queue is full, the newest waiting messages of lower priority are
+ * displaced to make room.  Returns false, dropping the message, if there still
+ * isn't room.
+ */
+bool VN210TxQueue::push(VN210TxPriority priority, uint8_t header, uint8_t type, uint8_t id, uint8_t dataSize, const uint8_t * payload) {
+	if (dataSize > VN210_TX_QUEUE_DATA_SIZE) {
+		this->dropped++;
+		return false;
+	}
+
+	while (this->count == VN210_TX_QUEUE_LENGTH || (uint16_t) this->dataUsed + dataSize > VN210_TX_QUEUE_DATA_SIZE) {
+		int8_t victim = this->findDisplaceable(priority);
+
+		this->dropped++;
+		if (victim < 0) {
+			return false;
+		}
+
+		this->remove(victim);
+	}
+
+	Entry & entry = this->entries[this->count++];
+	entry.header = header;
+	entry.type = type;
+	entry.id = id;
+	entry.dataSize = dataSize;
+	entry.dataOffset = this->dataUsed;
+	entry.priority = priority;
+	entry.bypassed = 0;
+
+	if (dataSize > 0) {
+		memcpy(this->data + this->dataUsed, payload, dataSize);
+		this->dataUsed += dataSize;
+	}
+
+	return true;
+}
+
+/**
+ * Keeps the most urgent message in the transmit buffer.  Call after pushing
+ * messages, and regularly from the main loop so the next message is loaded
+ * once the radio has read the last one.
+ *
+ * The loaded message is only swapped for a more urgent one while the radio
+ * hasn't started reading it.  Otherwise the urgent message goes next.
+ */
+void VN210TxQueue::service(void) {
+	if (this->dl == NULL) {
+		return;
+	}
+
+	//the transport empties the buffer once the frame has been clocked out. the interrupt
+	//may have packed a reply of its own since, which also means ours has gone.
+	if (this->loaded >= 0 && (!this->dl->hasMessageToSend() || this->dl->getTxSequence() != this->loadedSequence)) {
+		this->remove(this->loaded);
+	}
+
+	int8_t next = this->selectNext();
+	if (next < 0) {
+		return;
+	}
+
+	if (this->loaded >= 0) {
+		//a message which has waited its turn isn't pre-empted again
+		if (this->entries[next].priority <= this->entries[this->loaded].priority || this->entries[this->loaded].bypassed >= VN210_TX_MAX_BYPASS) {
+			return;
+		}
+
+		if (!this->dl->cancelMsg(this->loadedSequence)) {
+			return;		//the radio is already reading it
+		}
+
+		this->loaded = -1;
+	}
+
+	this->load(next);
+}
+
+/**
+ * Returns true if no messages are waiting or being sent.
+ */
+bool VN210TxQueue::isEmpty(void) {
+	return this->count == 0;
+}
+
+/**
+ * Returns the number of queued messages, including the one in the transmit buffer.
+ */
+uint8_t VN210TxQueue::getLength(void) {
+	return this->count;
+}
+
+/**
+ * Returns the index of the waiting entry to send next: the oldest entry which
+ * has been overtaken too often, otherwise the oldest of the most urgent.
+ * Returns -1 if nothing is waiting.
+ */
+int8_t VN210TxQueue::selectNext(void) {
+	int8_t best = -1;
+
+	for (int8_t i = 0; i < (int8_t) this->count; i++) {
+		if (i == this->loaded) continue;
+
+		if (this->entries[i].bypassed >= VN210_TX_MAX_BYPASS) {
+			return i;
+		}
+
+		if (best < 0 || this->entries[i].priority > this->entries[best].priority) {
+			best = i;
+		}
+	}
+
+	return best;
+}
+
+/**
+ * Packs an entry into the empty transmit buffer.  Every older entry still
+ * waiting has been overtaken, which counts towards its bypass limit.
+ *
+ * Returns false, dropping the entry, if it doesn't fit in the transmit buffer.
+ * Also returns false, keeping the entry, if the interrupt has packed a reply
+ * since service() looked at the buffer.  It is loaded once the reply has gone.
+ */
+bool VN210TxQueue::load(int8_t index) {
+	Entry & entry = this->entries[index];
+
+	this->message->header = entry.header;
+	this->message->messageType = entry.type;
+	this->message->messageID = entry.id;
+	this->message->dataSize = entry.dataSize;
+	this->message->data = this->data + entry.dataOffset;
+
+	if (!this->dl->sendMsg(this->message)) {
+		if (this->dl->wasDeferred()) return false;
+
+		this->remove(index);
+		this->dropped++;
+		return false;
+	}
+
+	this->loaded = index;
+	this->loadedSequence = this->dl->getTxSequence();
+
+	for (int8_t i = 0; i < index; i++) {
+		this->entries[i].bypassed++;
+	}
+
+	return true;
+}
+
+/**
+ * Removes an entry, closing the gaps it leaves in 'entries' and 'data'.
+ */
+void VN210TxQueue::remove(int8_t index) {
+	uint8_t offset = this->entries[index].dataOffset;
+	uint8_t size = this->entries[index].dataSize;
+
+	memmove(this->data + offset, this->data + offset + size, this->dataUsed - offset - size);
+	this->dataUsed -= size;
+
+	for (uint8_t i = index; i + 1 < this->count; i++) {
+		this->entries[i] = this->entries[i + 1];
+		this->entries[i].dataOffset -= size;
+	}
+	this->count--;
+
+	if (this->loaded == index) {
+		this->loaded = -1;
+	} else if (this->loaded > index) {
+		this->loaded--;
+	}
+}
+
+/**
+ * Returns the index of the newest waiting entry which is less urgent than
+ * 'priority', or -1 if there isn't one.  The loaded entry is never displaced.
+ */
+int8_t VN210TxQueue::findDisplaceable(uint8_t priority) {
+	for (int8_t i = (int8_t) this->count - 1; i >= 0; i--) {
+		if (i != this->loaded && this->entries[i].priority < priority) {
+			return i;
+		}
+	}
+
+	return -1;
+}
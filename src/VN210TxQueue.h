@@ -0,0 +1,105 @@
+/**
+ * Copyright (C) 2012 University of Strathclyde
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "VN210Config.h"
+#include "VN210RxTx.h"
+#include <stdint.h>
+
+#ifndef VN210TXQUEUE_H_
+#define VN210TXQUEUE_H_
+
+/**
+ * Priority classes for outgoing messages, least urgent first.
+ */
+enum VN210TxPriority {
+	VN210_PRIORITY_ROUTINE = 0,			//!< API commands and segment fragments
+	VN210_PRIORITY_RESPONSE = 1,		//!< ACKs and read responses to the radio's requests
+	VN210_PRIORITY_ALARM = 2			//!< Alarm and threshold reports from the application
+};
+
+/**
+ * Priority queue of messages waiting to go to the radio.
+ *
+ * The transport has a single transmit buffer, and the radio decides when it is
+ * read.  Messages are queued here instead, and service() keeps the most urgent
+ * one in the transmit buffer: when the buffer empties, the next message is
+ * loaded, and a more urgent arrival swaps out the loaded message as long as the
+ * radio hasn't started reading it.  Within a priority class, messages go in the
+ * order they were queued.
+ *
+ * To stop a steady stream of alarms and responses starving routine traffic, a
+ * message which has been overtaken VN210_TX_MAX_BYPASS times is sent next,
+ * whatever its priority.
+ *
+ * Payloads are copied into the queue, so the caller's buffer can be reused as
+ * soon as push() returns.
+ *
+ * @since 18 Oct 2026
+ * @copyright University of Strathclyde
+ * @ingroup SimpleAPI
+ * @ingroup Headers
+ */
+class VN210TxQueue {
+public:
+	VN210TxQueue();
+
+	void begin(VN210RxTx * dl, VN210_APIMessage * message);	//empties the queue. messages are packed through 'message'.
+
+	//queues a message, displacing a less urgent one if the queue is full. returns false if it was dropped.
+	bool push(VN210TxPriority priority, uint8_t header, uint8_t type, uint8_t id, uint8_t dataSize, const uint8_t * data);
+
+	void service(void);											//keeps the most urgent message in the transmit buffer
+	bool isEmpty(void);											//returns true if nothing is waiting or being sent
+	uint8_t getLength(void);									//returns the number of messages waiting, including the one being sent
+
+	uint16_t dropped;											//!< Number of messages dropped or displaced because the queue was full
+private:
+	/**
+	 * A queued message.  Entries are kept in the order they were queued, and so
+	 * are their payloads in 'data'.
+	 */
+	typedef struct {
+		uint8_t header;											//!< Message header
+		uint8_t type;											//!< Message type
+		uint8_t id;												//!< Message ID
+		uint8_t dataSize;										//!< Payload size
+		uint8_t dataOffset;										//!< Start of the payload in 'data'
+		uint8_t priority;										//!< VN210TxPriority of the message
+		uint8_t bypassed;										//!< Number of times a later message has been sent first
+	} Entry;
+
+	VN210RxTx * dl;												//!< Transport the messages are sent through
+	VN210_APIMessage * message;									//!< Message struct used to pack entries
+
+	Entry entries[VN210_TX_QUEUE_LENGTH];						//!< Queued messages, oldest first
+	uint8_t data[VN210_TX_QUEUE_DATA_SIZE];						//!< Payloads of the queued messages, oldest first
+	uint8_t count;												//!< Number of queued messages
+	uint8_t dataUsed;											//!< Bytes of 'data' in use
+	int8_t loaded;												//!< Index of the entry in the transmit buffer, or -1
+	uint8_t loadedSequence;										//!< Transport tx sequence just after the loaded entry was packed
+
+	int8_t selectNext(void);									//returns the index of the entry which should be sent next, or -1
+	bool load(int8_t index);									//packs an entry into the transmit buffer
+	void remove(int8_t index);									//removes an entry and its payload
+	int8_t findDisplaceable(uint8_t priority);					//returns the newest waiting entry less urgent than 'priority', or -1
+};
+
+#endif /* VN210TXQUEUE_H_ */
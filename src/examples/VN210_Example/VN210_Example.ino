@@ -33,6 +33,7 @@
  * [d] Toggle debug mode
  * [r] Reset VN210 hardware
  * [u] Update UAP values
+ * [l] Print link health: poll interval histogram and radio resets
  * [p] Provision VN210. WARNING - deconfigures radio!
  * [1] Get hardware platform info from VN210
  * [2] Get firmware version from VN210
@@ -74,6 +75,7 @@ char * instructions = "\n== VN210 Simple API ==\n\n"
 "  [i] Print these instructions\n"
 "  [r] Reset VN210\n"
 "  [u] Update UAP data\n"
+"  [l] Print link health\n"
 "  [p] Provision VN210. WARNING - deconfigures radio!\n\n"
 "  [1] Get hardware platform from VN210\n"
 "  [2] Get firmware version\n"
@@ -124,8 +126,15 @@ void loop() {
             Serial.println("CRC FAILED");
             printRxData();
         }
+        
+        //finished with rxFrame. hand the buffer back so the next frame isn't dropped
+        VN210.releaseMessage();         // ---- VN210 API CALL ----
     }
     
+#if VN210_LINK_MISSED_POLLS
+    VN210.checkLink(millis());          // ---- VN210 API CALL ----
+#endif
+    
     checkUserCommand();
 }
 
@@ -163,6 +172,12 @@ void checkUserCommand() {
                 Serial.println("Updating UAP data values");    
                 updateUAPValues();
                 break;
+#if VN210_LINK_MISSED_POLLS
+            case 'l':                //print the link monitor's counters
+                Serial.println("Link health");
+                printLinkHealth();
+                break;
+#endif
             case 'p':
                 Serial.println("Provisioning radio (takes 10s)");
                 VN210.provisionRadio();
@@ -209,10 +224,10 @@ void printMessageInfo() {
     Serial.print(" ms] ");
     
     Serial.print("RX (");
-    Serial.print(VN210.rxMessage.messageID, HEX);
+    Serial.print(VN210.rxFrame.messageID(), HEX);
     Serial.print(") -> ");
     
-    switch(VN210.getMessageClass(&VN210.rxMessage)) {            // ---- VN210 API CALL ----
+    switch(VN210.rxFrame.messageClass()) {            // ---- VN210 API CALL ----
        case 1: 
            printPassThroughInfo();
            if (debug) printTxData();
@@ -237,15 +252,15 @@ void printMessageInfo() {
 void printPassThroughInfo() {
     Serial.print("DATA_PASS-THROUGH: ");   
     
-    switch(VN210.rxMessage.messageType) {            // ---- VN210 API CALL ----
+    switch(VN210.rxFrame.messageType()) {            // ---- VN210 API CALL ----
         case 1: 
             Serial.println("Write req");
             break;
         case 2:
             Serial.print("Read req: ");
             
-            for (int i = 0; i < VN210.rxMessage.dataSize; i++) {        // ---- VN210 API CALL ----
-                Serial.print(VN210.rxMessage.data[i]);                // ---- VN210 API CALL ----
+            for (int i = 0; i < VN210.rxFrame.dataSize(); i++) {        // ---- VN210 API CALL ----
+                Serial.print(VN210.rxFrame.data(i));                // ---- VN210 API CALL ----
                 Serial.print(" ");
             }
             
@@ -270,14 +285,16 @@ void printTxData() {
     Serial.println(" ");
 }  
 
-//note - this doesnt work as the rx buffer is reset before this is called.
+/**
+ * Prints the raw bytes of the last received message to the console.
+ */
 void printRxData() {
     Serial.print("RX (");
-    Serial.print(VN210.rxMessage.messageID, HEX);            // ---- VN210 API CALL ----
+    Serial.print(VN210.rxFrame.messageID(), HEX);            // ---- VN210 API CALL ----
     Serial.print(") -> ");
     
-    for (int i = 0; i < VN210.dl->rxBuff.byteCount; i++) {    // ---- VN210 low-level API CALL ----
-        Serial.print(VN210.dl->rxBuff.bytes[i], HEX);
+    for (int i = 0; i < VN210.rxFrame.size(); i++) {          // ---- VN210 API CALL ----
+        Serial.print(VN210.rxFrame.bytes()[i], HEX);
         Serial.print(" ");
     }
     
@@ -290,7 +307,7 @@ void printRxData() {
 void printAPIInfo() {
     Serial.print("API: ");
      
-    switch(VN210.rxMessage.messageType) {
+    switch(VN210.rxFrame.messageType()) {
         case 1:
             Serial.print("Hardware version: ");
             Serial.println(hwPlatforms[VN210.info.hwPlatform]);        // ---- VN210 API CALL ----
@@ -330,7 +347,7 @@ void printAPIInfo() {
 void printACKInfo() {
     Serial.print("ACK: "); 
 
-    switch(VN210.rxMessage.messageType) {                    // ---- VN210 API CALL ----
+    switch(VN210.rxFrame.messageType()) {                    // ---- VN210 API CALL ----
         case 1: Serial.println("OK"); break;
         case 2: Serial.println("SENT"); break;
         case 3: Serial.println("UPDATED"); break;
@@ -344,7 +361,7 @@ void printACKInfo() {
 void printNACKInfo() {    
     Serial.print("NACK: "); 
     
-    switch(VN210.rxMessage.messageType) {                    // ---- VN210 API CALL ----
+    switch(VN210.rxFrame.messageType()) {                    // ---- VN210 API CALL ----
         case 1: Serial.println("CRC Fail"); break;
         case 2: Serial.println("Data Overrun"); break;
         case 3: Serial.println("Packet incomplete"); break;
@@ -392,4 +409,38 @@ void updateUAPValues() {
         Serial.print(VN210.uapData.digitals[i], BIN);
         Serial.print((i < 3) ? ", " : "]\n");
     }
+    
+#if VN210_UAP_SNAPSHOT
+    //reads are answered from the last published values, so publish the new set
+    VN210.publish();                    // ---- VN210 API CALL ----
+#endif
+}
+
+#if VN210_LINK_MISSED_POLLS
+/**
+ * Prints the link monitor's counters: polls seen and missed, radio resets, the
+ * longest gap between polls, bytes dropped while a frame was held and the poll
+ * interval histogram.  Each histogram bin is a quarter of the expected interval
+ * wide, so a steady radio fills bins 3 and 4.
+ */
+void printLinkHealth() {
+    Serial.print("Polls: ");
+    Serial.print(VN210.linkMonitor.polls);                      // ---- VN210 API CALL ----
+    Serial.print(", missed: ");
+    Serial.print(VN210.linkMonitor.missedPolls);                // ---- VN210 API CALL ----
+    Serial.print(", resets: ");
+    Serial.print(VN210.linkMonitor.resets);                     // ---- VN210 API CALL ----
+    Serial.print(", max gap: ");
+    Serial.print(VN210.linkMonitor.maxInterval);                // ---- VN210 API CALL ----
+    Serial.print(" ms, expected: ");
+    Serial.print(VN210.linkMonitor.getExpectedInterval());      // ---- VN210 API CALL ----
+    Serial.print(" ms, dropped bytes: ");
+    Serial.println(VN210RxTx.droppedBytes);                     // ---- VN210 API CALL ----
+    
+    Serial.print("Intervals (x0.25): [");
+    for (int i = 0; i < VN210_LINK_HISTOGRAM_BINS; i++) {
+        Serial.print(VN210.linkMonitor.histogram[i]);           // ---- VN210 API CALL ----
+        Serial.print((i < VN210_LINK_HISTOGRAM_BINS - 1) ? ", " : "]\n");
+    }
 }
+#endif
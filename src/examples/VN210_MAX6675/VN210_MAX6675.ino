@@ -25,10 +25,18 @@
  * thermocouple amplifier.
  * 
  * Uses:
- *       TimedAction library: http://arduino.cc/playground/Code/TimedAction
  *       MAX6675 library: https://github.com/adafruit/MAX6675-library
  *       Nivis VN210 SimpleAPI implementation. 
  *
+ * Sampling and UAP register updates are run by the VN210Scheduler, which
+ * always handles radio messages before running a task.  Every update period
+ * the scheduler's overrun and jitter counters are printed alongside the
+ * SCADA register values.
+ *
+ * The thermocouple is oversampled and each block of readings is reduced to its
+ * median before being added to the SCADA register, so that single noisy reads
+ * don't show up as the period minimum or maximum.
+ *
  * For more information on the VN210 SimpleAPI implementation, see "VN210_Example" script.
  *
  * @since 22 May 2012
@@ -42,9 +50,10 @@
  * $Id: VN210_MAX6675.ino 5382 2012-06-22 08:39:05Z pbaker $
  */
 #include "VN210SimpleAPI_Arduino.h"
-#include "TimedAction.h"
+#include "VN210Scheduler.h"
 #include "max6675.h"
 #include "SCADARegister.h"
+#include "SCADAFilter.h"
 
 //MAX6675 pin assignments
 const int thermoGND = A5;
@@ -55,19 +64,28 @@ const int thermoCLK = A1;
 
 float tempValue;
 
-const int SAMPLE_PERIOD_MILLIS = 1000;
+const int SAMPLE_PERIOD_MILLIS = 250;      //MAX6675 conversion takes up to 220ms
+const int SAMPLES_PER_VALUE = 4;           //one median value per second goes into the SCADA register
 const long UPDATE_PERIOD_MILLIS = 60000;
 
 //max6675 breakout board driver
 MAX6675 thermocouple(thermoCLK, thermoCS, thermoDO);
 
-//timed action workers
-TimedAction sampleAction = TimedAction(SAMPLE_PERIOD_MILLIS, sample);
-TimedAction scadaAction = TimedAction(UPDATE_PERIOD_MILLIS, update_scada_registers);
+#if VN210_WARM_START
+//radio info and settings kept from the last boot, at the start of the EEPROM
+VN210SettingsEEPROM settingsEEPROM(0);
+#endif
+
+//cooperative scheduler. services the VN210 before running any task.
+VN210Scheduler scheduler = VN210Scheduler(&VN210);
+uint8_t sampleTask;
 
 //SCADA teperature register
 SCADARegister temperatureRegister;
 
+//median filter in front of the SCADA register
+SCADAFilteredRegister<MedianFilter<float, SAMPLES_PER_VALUE> > filteredTemperature(&temperatureRegister);
+
 /**
  * Script setup function.   Initialises the Serial console, prints
  * sketch instructions and initialises the VN210.
@@ -81,11 +99,18 @@ void setup() {
     
     initialiseSensors();
     
-    //start radio
+    //start radio.  no need to wait for it to boot: settings are sent once it first polls.
+#if VN210_WARM_START
+    VN210.setSettingsStorage(&settingsEEPROM);
+#endif
     VN210.begin(false);      
+    
+    //time the sleep and awake stretches, mostly under a millisecond, in microseconds
+    scheduler.setMicrosClock(micros);
 
-    //wait for VN210 to boot
-    delay(5000); 
+    //schedule the sampling and SCADA update tasks
+    sampleTask = scheduler.addTask(sample, SAMPLE_PERIOD_MILLIS, millis());
+    scheduler.addTask(update_scada_registers, UPDATE_PERIOD_MILLIS, millis());
     
     Serial.println("Done");
 } 
@@ -102,38 +127,67 @@ void initialiseSensors() {
 }    
 
 /**
- * Main program loop.
+ * Main program loop.  The scheduler handles any new VN210 message, then
+ * runs the sampling or SCADA task if one is due.  In between, the processor
+ * idles until the next SPI byte or timer tick.
  */
 void loop() {
-    if (VN210.hasNewMessage()) {           //check if there is a new message
-        VN210.handleMessage();             //if so, deal with it
-    }
-    
-    sampleAction.check();                   //check whether its time to sense
-    scadaAction.check();		   //check whether its time to update SCADA
+    scheduler.run(millis());
+    scheduler.idle(millis());
 }
 
 /**
- * Samples the temperature and adds it to the local SCADA register
+ * Samples the temperature and adds it to the filter in front of the local SCADA register
  */
 void sample() {
    tempValue = thermocouple.readCelsius();
     
-   temperatureRegister.addValue(tempValue);		//add a new value.
+   filteredTemperature.addSample(tempValue);		//add a new value. every 4th call updates the register
 }
 
 
 /**
- * Set VN210 registers with temperature data.  Called by the TimedAction worker.
+ * Set VN210 registers with temperature data.  Called by the scheduler.
  */
 void update_scada_registers() {
     /* Node is provisioned to use Analogs 0-2 (attributes 1, 2, 3) */
     VN210.uapData.analogs[0].value = temperatureRegister.values.maximum;
     VN210.uapData.analogs[1].value = temperatureRegister.values.minimum;
     VN210.uapData.analogs[2].value = temperatureRegister.values.average;
+#if VN210_UAP_SNAPSHOT
+    /* Reads are answered from the last published values, so publish the new set */
+    VN210.publish();                    // ---- VN210 API CALL ----
+#endif
 
     Serial.println("Updated UAP (SCADA) registers to:");
     temperatureRegister.print();
+#if VN210_HISTORY_LENGTH
+    /* Keep the period's values, in case the network is down and the radio needs to backfill */
+    VN210.history.add(millis() / 1000, 1, temperatureRegister.values.average,
+            temperatureRegister.values.minimum, temperatureRegister.values.maximum, temperatureRegister.values.total);
+#endif
     /* Reset for the next time period */
     temperatureRegister.reset();
+    
+    printSchedulerStats();
+}
+
+/**
+ * Prints the sampling task timing counters and the time spent asleep, then resets them for the
+ * next update period.
+ */
+void printSchedulerStats() {
+    Serial.print("Samples: ");
+    Serial.print(scheduler.tasks[sampleTask].runs);
+    Serial.print(", overruns: ");
+    Serial.print(scheduler.tasks[sampleTask].overruns);
+    Serial.print(", max jitter: ");
+    Serial.print(scheduler.tasks[sampleTask].maxJitter);
+    Serial.print(" ms, asleep: ");
+    Serial.print(scheduler.sleepTime);
+    Serial.print(" ms, awake: ");
+    Serial.print(scheduler.activeTime);
+    Serial.println(" ms");
+    
+    scheduler.resetCounters();
 }
@@ -0,0 +1,67 @@
+#!/bin/sh
+#
+# Copyright (C) 2012 University of Strathclyde
+#
+# Regression report for the VN210 Simple API stack: builds and runs the host
+# benchmarks and simulators, then prints the AVR size of each build configuration with
+# footprint.sh.  Keep the output of each release to compare against the next.
+#
+# Usage: tools/bench.sh
+#
+# Environment:
+#
+#  HOST_CXX         host C++ compiler (default g++)
+#  HOST_FLAGS       extra host compiler flags, e.g. -DVN210_SHARED_BUFFER=1
+#
+# The size report is skipped if avr-g++ isn't installed.  See footprint.sh for
+# the Arduino settings it uses.  Host timings are not AVR cycle counts: compare
+# them with earlier runs on the same machine only.
+
+set -e
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+SRC="$ROOT/src"
+HOST="$ROOT/host"
+
+HOST_CXX=${HOST_CXX:-g++}
+HOST_FLAGS=${HOST_FLAGS:-}
+
+#each benchmark, with the sources it is built from.  name/variant builds the
+#benchmark again with the compiler flags given after its sources.
+BENCHMARKS="bench_api:VN210RxTx_Host.cpp VN210FrameBuilder.cpp ../src/VN210RxTx.cpp ../src/VN210SimpleAPI.cpp ../src/VN210DuplicateFilter.cpp ../src/VN210History.cpp ../src/VN210LinkMonitor.cpp ../src/VN210Segment.cpp ../src/VN210Snapshot.cpp ../src/VN210TxQueue.cpp ../src/VN210Scheduler.cpp
+bench_api/buffer-64:VN210RxTx_Host.cpp VN210FrameBuilder.cpp ../src/VN210RxTx.cpp ../src/VN210SimpleAPI.cpp ../src/VN210DuplicateFilter.cpp ../src/VN210History.cpp ../src/VN210LinkMonitor.cpp ../src/VN210Segment.cpp ../src/VN210Snapshot.cpp ../src/VN210TxQueue.cpp ../src/VN210Scheduler.cpp -DVN210_BUFFER_SIZE=64
+bench_framing:VN210RxTx_Host.cpp VN210FrameBuilder.cpp ../src/VN210RxTx.cpp
+bench_codec:VN210BulkCodec.cpp VN210RxTx_Host.cpp VN210FrameBuilder.cpp ../src/VN210RxTx.cpp
+bench_dma:VN210DMAHal_Sim.cpp VN210RxTx_Host.cpp VN210FrameBuilder.cpp ../src/VN210RxTx_DMA.cpp ../src/VN210RxTx.cpp
+bench_series:VN210SeriesStore.cpp
+bench_bank:
+bench_filter:
+bench_pipeline:VN210Pipeline.cpp VN210RxTx_Host.cpp VN210FrameBuilder.cpp ../src/VN210RxTx.cpp -pthread
+bench_shared:VN210SharedRegisters.cpp VN210RxTx_Host.cpp ../src/VN210RxTx.cpp ../src/VN210SimpleAPI.cpp ../src/VN210DuplicateFilter.cpp ../src/VN210History.cpp ../src/VN210LinkMonitor.cpp ../src/VN210Segment.cpp ../src/VN210Snapshot.cpp ../src/VN210TxQueue.cpp -pthread -lrt
+fleet_sim:VN210RxTx_Host.cpp VN210FrameBuilder.cpp ../src/VN210RxTx.cpp ../src/VN210SimpleAPI.cpp ../src/VN210DuplicateFilter.cpp ../src/VN210History.cpp ../src/VN210LinkMonitor.cpp ../src/VN210Segment.cpp ../src/VN210Snapshot.cpp ../src/VN210TxQueue.cpp
+duty_sim:VN210RxTx_Host.cpp VN210FrameBuilder.cpp ../src/VN210RxTx.cpp ../src/VN210SimpleAPI.cpp ../src/VN210DuplicateFilter.cpp ../src/VN210History.cpp ../src/VN210LinkMonitor.cpp ../src/VN210Segment.cpp ../src/VN210Snapshot.cpp ../src/VN210TxQueue.cpp ../src/VN210Scheduler.cpp"
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+echo "== host: $(uname -m), $($HOST_CXX --version | head -n 1), flags: -O2 $HOST_FLAGS"
+
+status=0
+
+echo "$BENCHMARKS" | while IFS=: read -r name sources; do
+	echo
+	program=${name%%/*}
+	echo "== $name"
+	(cd "$HOST" && $HOST_CXX -O2 -I"$SRC" $HOST_FLAGS -o "$WORK/$program" $program.cpp $sources)
+	"$WORK/$program" || { echo "$name FAILED"; exit 1; }
+done || status=1
+
+echo
+if command -v "${CXX:-avr-g++}" > /dev/null 2>&1; then
+	echo "== AVR footprint"
+	"$ROOT/tools/footprint.sh"
+else
+	echo "== AVR footprint skipped: ${CXX:-avr-g++} not found"
+fi
+
+exit $status
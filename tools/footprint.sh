@@ -0,0 +1,78 @@
+#!/bin/sh
+#
+# Copyright (C) 2012 University of Strathclyde
+#
+# Prints the static RAM and flash cost of the VN210 Simple API stack for each
+# build configuration in VN210Config.h.  Requires avr-gcc, avr-size and the
+# Arduino AVR core headers.
+#
+# Usage: tools/footprint.sh ["name:compiler flags" ...]
+#
+# With no arguments, the standard configurations are reported.  Environment:
+#
+#  ARDUINO_CORE     path to the Arduino core (directory containing Arduino.h)
+#  ARDUINO_VARIANT  path to the board variant (directory containing pins_arduino.h)
+#  MCU              target MCU (default atmega328p)
+#  F_CPU            CPU frequency (default 16000000L)
+#
+# RAM is .data + .bss, flash is .text + .data, both summed over the library
+# objects and the global VN210 / VN210RxTx instances.  Application code and the
+# Arduino core are not included.
+
+set -e
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+SRC="$ROOT/src"
+
+ARDUINO_CORE=${ARDUINO_CORE:-/usr/share/arduino/hardware/arduino/avr/cores/arduino}
+ARDUINO_VARIANT=${ARDUINO_VARIANT:-/usr/share/arduino/hardware/arduino/avr/variants/standard}
+MCU=${MCU:-atmega328p}
+F_CPU=${F_CPU:-16000000L}
+
+CXX=${CXX:-avr-g++}
+CC=${CC:-avr-gcc}
+SIZE=${SIZE:-avr-size}
+
+#library objects making up the Simple API stack on Arduino
+SOURCES="VN210RxTx.cpp VN210RxTx_Arduino.cpp VN210SimpleAPI.cpp VN210DuplicateFilter.cpp VN210History.cpp VN210LinkMonitor.cpp VN210Segment.cpp VN210Snapshot.cpp VN210TxQueue.cpp spi_helper.c"
+
+if [ $# -eq 0 ]; then
+	set -- "default:" \
+		"shared:-DVN210_SHARED_BUFFER=1" \
+		"buffer-64:-DVN210_BUFFER_SIZE=64" \
+		"buffer-64-shared:-DVN210_BUFFER_SIZE=64 -DVN210_SHARED_BUFFER=1" \
+		"snapshot:-DVN210_UAP_SNAPSHOT=1" \
+		"history-8:-DVN210_HISTORY_LENGTH=8" \
+		"no-warm-start:-DVN210_WARM_START=0"
+fi
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+#the Simple API instance is defined in a header, so give it a translation unit of its own
+echo '#include "VN210SimpleAPI_Arduino.h"' > "$WORK/instance.cpp"
+
+FLAGS="-mmcu=$MCU -DF_CPU=$F_CPU -DARDUINO=100 -Os -ffunction-sections -fdata-sections -I$SRC -I$ARDUINO_CORE -I$ARDUINO_VARIANT"
+
+printf "%-20s %8s %8s %8s %8s %8s\n" "configuration" "text" "data" "bss" "RAM" "flash"
+
+for config in "$@"; do
+	name=${config%%:*}
+	defines=${config#*:}
+	objs=""
+
+	for src in $SOURCES; do
+		obj="$WORK/$name-${src%.*}.o"
+		case $src in
+			*.c) $CC $FLAGS $defines -c "$SRC/$src" -o "$obj" ;;
+			*) $CXX $FLAGS -fno-exceptions $defines -c "$SRC/$src" -o "$obj" ;;
+		esac
+		objs="$objs $obj"
+	done
+
+	$CXX $FLAGS -fno-exceptions $defines -c "$WORK/instance.cpp" -o "$WORK/$name-instance.o"
+	objs="$objs $WORK/$name-instance.o"
+
+	$SIZE -t $objs | awk -v name="$name" '
+		/\(TOTALS\)/ { printf "%-20s %8d %8d %8d %8d %8d\n", name, $1, $2, $3, $2 + $3, $1 + $2 }'
+done